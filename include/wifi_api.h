@@ -15,12 +15,538 @@
 #define WIFI_API_H
 
 #include <esp_err.h>
+#include <esp_netif_types.h>
+#include <esp_wifi_types.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Connection state bits published by `wifi_api_get_state`.
+ */
+#define WIFI_API_STATE_STARTED (1UL << 0)    /**< Station started. */
+#define WIFI_API_STATE_ASSOCIATED (1UL << 1) /**< Associated with an AP. */
+#define WIFI_API_STATE_GOT_IP4 (1UL << 2)    /**< Got an IPv4 address. */
+#define WIFI_API_STATE_GOT_IP6 (1UL << 3)    /**< Got an IPv6 address. */
+#define WIFI_API_STATE_FAILED (1UL << 4)     /**< All retries were used. */
+#define WIFI_API_STATE_SCANNING (1UL << 5)   /**< A scan is running. */
+#define WIFI_API_STATE_ROAMING (1UL << 6)    /**< Moving to another AP. */
+
+/**
+ * @brief IP configuration modes of the station interface.
+ */
+typedef enum
+{
+  WIFI_API_IP_MODE_DHCP = 0,     /**< Acquire the address through DHCP. */
+  WIFI_API_IP_MODE_CACHED_LEASE, /**< Reuse the last DHCP lease on connect. */
+  WIFI_API_IP_MODE_STATIC,       /**< Use a fixed IP configuration. */
+} wifi_api_ip_mode_t;
+
+/**
+ * @brief IPv4 configuration of the station interface.
+ */
+typedef struct
+{
+  esp_netif_ip_info_t ip_info; /**< Address, netmask and gateway. */
+  esp_ip4_addr_t dns_main;     /**< Main DNS server, 0 to leave unset. */
+  esp_ip4_addr_t dns_backup;   /**< Backup DNS server, 0 to leave unset. */
+} wifi_api_ip_config_t;
+
+/**
+ * @brief Results of a connection attempt.
+ */
+typedef enum
+{
+  WIFI_API_RESULT_CONNECTED = 0, /**< Associated and got an IP address. */
+  WIFI_API_RESULT_FAILED,        /**< All retries were used. */
+  WIFI_API_RESULT_TIMEOUT,       /**< The attempt did not finish in time. */
+} wifi_api_result_t;
+
+/**
+ * @brief Reconnection backoff configuration.
+ *
+ * Each reconnection waits a random delay between `base_delay_ms` and three
+ * times the previous delay (decorrelated jitter), capped at `max_delay_ms`.
+ */
+typedef struct
+{
+  uint32_t base_delay_ms; /**< Minimum delay before a reconnection. */
+  uint32_t max_delay_ms;  /**< Maximum delay before a reconnection. */
+  uint8_t max_retry;      /**< Attempts before the first connection fails. */
+} wifi_api_retry_config_t;
+
+/**
+ * @brief Actions taken when the station is disconnected.
+ */
+typedef enum
+{
+  WIFI_API_RETRY_NOW = 0,  /**< Reconnect immediately. */
+  WIFI_API_RETRY_BACKOFF,  /**< Reconnect after the backoff delay. */
+  WIFI_API_RETRY_RESCAN,   /**< Drop the BSSID lock and rescan after backoff. */
+  WIFI_API_RETRY_GIVE_UP,  /**< Stop reconnecting and report the failure. */
+  WIFI_API_RETRY_SWITCH_PROFILE, /**< Skip the current profile, rescan, or
+                                      give up without another profile. */
+  WIFI_API_RETRY_ACTION_MAX, /**< Number of actions. */
+} wifi_api_retry_action_t;
+
+/**
+ * @brief Roaming configuration of `wifi_api_set_roaming`.
+ */
+typedef struct
+{
+  int8_t rssi_threshold;    /**< RSSI in dBm below which roaming starts. */
+  uint8_t min_gain_db;      /**< RSSI gain required to move to another AP. */
+  const uint8_t *channels;  /**< Channels to scan, NULL for all channels. */
+  size_t channel_count;     /**< Number of entries in `channels`. */
+  uint32_t min_interval_ms; /**< Minimum time between two roaming scans. */
+} wifi_api_roam_config_t;
+
+/**
+ * @brief Default roaming configuration, all channels.
+ */
+#define WIFI_API_ROAM_CONFIG_DEFAULT()                                         \
+  {                                                                            \
+    .rssi_threshold = -75, .min_gain_db = 8, .channels = NULL,                 \
+    .channel_count = 0, .min_interval_ms = 30000,                              \
+  }
+
+/**
+ * @brief Driver buffer profiles of `wifi_api_set_driver_profile`.
+ */
+typedef enum
+{
+  WIFI_API_DRIVER_THROUGHPUT = 0, /**< More buffers, 32 frame AMPDU window. */
+  WIFI_API_DRIVER_BALANCED,       /**< SDK defaults. */
+  WIFI_API_DRIVER_LOW_MEMORY,     /**< Few buffers, no AMPDU. */
+  WIFI_API_DRIVER_PROFILE_MAX,    /**< Number of profiles. */
+} wifi_api_driver_profile_t;
+
+/**
+ * @brief Memory cost of the driver of `wifi_api_get_driver_memory`.
+ */
+typedef struct
+{
+  wifi_api_driver_profile_t profile; /**< Profile the driver was built with. */
+  size_t init_bytes;    /**< Internal RAM taken by `esp_wifi_init`. */
+  size_t static_bytes;  /**< Estimate of the static buffers. */
+  size_t dynamic_bytes; /**< Estimate of the dynamic buffers at their peak. */
+} wifi_api_driver_memory_t;
+
+/**
+ * @brief Modem power-save profiles of `wifi_api_set_power_profile`.
+ */
+typedef enum
+{
+  WIFI_API_POWER_NONE = 0,   /**< Radio always on, lowest latency. */
+  WIFI_API_POWER_MIN_MODEM,  /**< Wakes for every DTIM beacon. */
+  WIFI_API_POWER_MAX_MODEM,  /**< Wakes every listen interval, least current. */
+  WIFI_API_POWER_PROFILE_MAX, /**< Number of profiles. */
+} wifi_api_power_profile_t;
+
+/**
+ * @brief Power governor configuration of `wifi_api_set_power_governor`.
+ */
+typedef struct
+{
+  wifi_api_power_profile_t active_profile; /**< Profile while traffic flows. */
+  wifi_api_power_profile_t idle_profile;   /**< Profile once idle. */
+  uint32_t active_packets; /**< Packets per sample that mark activity. */
+  uint32_t idle_ms;        /**< Time without activity before idling. */
+  uint32_t sample_ms;      /**< Traffic sampling period. */
+} wifi_api_power_governor_t;
+
+/**
+ * @brief Default power governor configuration.
+ */
+#define WIFI_API_POWER_GOVERNOR_DEFAULT()                                      \
+  {                                                                            \
+    .active_profile = WIFI_API_POWER_NONE,                                     \
+    .idle_profile = WIFI_API_POWER_MAX_MODEM, .active_packets = 4,             \
+    .idle_ms = 5000, .sample_ms = 500,                                         \
+  }
+
+/**
+ * @brief Power-save statistics of `wifi_api_get_power_stats`.
+ */
+typedef struct
+{
+  uint64_t time_ms[WIFI_API_POWER_PROFILE_MAX]; /**< Time started in each. */
+  uint32_t switches;                            /**< Profile changes. */
+} wifi_api_power_stats_t;
+
+/**
+ * @brief Link quality sampler configuration of `wifi_api_set_link_sampling`.
+ */
+typedef struct
+{
+  uint32_t sample_ms; /**< RSSI sampling period. */
+  uint8_t weight;     /**< Weight of a new sample in the averages, percent. */
+} wifi_api_link_config_t;
+
+/**
+ * @brief Default link quality sampler configuration.
+ */
+#define WIFI_API_LINK_CONFIG_DEFAULT()                                         \
+  {                                                                            \
+    .sample_ms = 1000, .weight = 20,                                           \
+  }
+
+/**
+ * @brief Link quality of the current connection, from
+ * `wifi_api_get_link_quality`.
+ */
+typedef struct
+{
+  bool connected;            /**< Whether the station is associated. */
+  uint8_t bssid[6];          /**< BSSID of the AP. */
+  uint8_t channel;           /**< Primary channel of the AP. */
+  int8_t rssi;               /**< Last RSSI sample in dBm. */
+  float rssi_avg;            /**< Exponentially weighted RSSI in dBm. */
+  float rssi_var;            /**< Exponentially weighted RSSI variance. */
+  float trend;               /**< Smoothed RSSI change in dB per second. */
+  uint32_t samples;          /**< RSSI samples since the association. */
+  uint32_t sample_errors;    /**< RSSI reads that failed. */
+  uint32_t connect_attempts; /**< Attempts it took to associate. */
+  uint32_t beacon_timeouts;  /**< Beacon timeouts since the association. */
+  uint32_t connected_ms;     /**< Time associated at the last sample. */
+  uint32_t age_ms;           /**< Time since the last sample. */
+} wifi_api_link_quality_t;
+
+/**
+ * @brief Probes of the connectivity watchdog.
+ */
+typedef enum
+{
+  WIFI_API_WATCHDOG_ICMP = 0, /**< ICMP echo, to the gateway by default. */
+  WIFI_API_WATCHDOG_TCP,      /**< TCP connection to an endpoint. */
+} wifi_api_watchdog_probe_t;
+
+/**
+ * @brief Connectivity watchdog configuration of `wifi_api_set_watchdog`.
+ */
+typedef struct
+{
+  wifi_api_watchdog_probe_t probe; /**< Probe type. */
+  const char *host;     /**< IPv4 address to probe, NULL for the gateway
+                             (ICMP only). */
+  uint16_t port;        /**< Port of the TCP endpoint. */
+  uint32_t interval_ms; /**< Time between two probes. */
+  uint32_t timeout_ms;  /**< Time a probe waits for its answer. */
+  uint8_t failures;     /**< Consecutive failures before each action. */
+} wifi_api_watchdog_config_t;
+
+/**
+ * @brief Default connectivity watchdog configuration, pinging the gateway.
+ */
+#define WIFI_API_WATCHDOG_CONFIG_DEFAULT()                                     \
+  {                                                                            \
+    .probe = WIFI_API_WATCHDOG_ICMP, .host = NULL, .port = 0,                  \
+    .interval_ms = 30000, .timeout_ms = 1000, .failures = 3,                   \
+  }
+
+/**
+ * @brief Recovery actions of the connectivity watchdog, in escalation order.
+ */
+typedef enum
+{
+  WIFI_API_WATCHDOG_RENEW_DHCP = 0, /**< Restart the DHCP client. */
+  WIFI_API_WATCHDOG_REASSOCIATE,    /**< Disconnect and reconnect to the AP. */
+  WIFI_API_WATCHDOG_RESTART,        /**< Stop and start the driver. */
+  WIFI_API_WATCHDOG_ACTION_MAX,     /**< Number of actions. */
+} wifi_api_watchdog_action_t;
+
+/**
+ * @brief Connectivity watchdog statistics of `wifi_api_get_watchdog_stats`.
+ */
+typedef struct
+{
+  uint32_t probes;   /**< Probes sent. */
+  uint32_t failures; /**< Probes that failed. */
+  uint32_t actions[WIFI_API_WATCHDOG_ACTION_MAX]; /**< Recoveries started. */
+} wifi_api_watchdog_stats_t;
+
+/**
+ * @brief Credential profile of `wifi_api_add_profile`.
+ */
+typedef struct
+{
+  char ssid[33];     /**< SSID of the network. */
+  char password[65]; /**< Password, empty for an open network. */
+  uint8_t priority;  /**< Higher priorities are preferred. */
+} wifi_api_profile_t;
+
+/**
+ * @brief Default reconnection backoff configuration.
+ */
+#define WIFI_API_RETRY_CONFIG_DEFAULT()                                        \
+  {                                                                            \
+    .base_delay_ms = 250, .max_delay_ms = 30000, .max_retry = 10,              \
+  }
+
+/**
+ * @brief Completion callback of `wifi_api_configure_async`.
+ *
+ * @note It runs on the Wi-Fi manager task, so it must not block.
+ *
+ * @param[in] result The result of the connection attempt.
+ * @param[in] arg The user argument given to `wifi_api_configure_async`.
+ */
+typedef void (*wifi_api_connect_cb_t)(wifi_api_result_t result, void *arg);
+
+/**
+ * @brief Completion callback of the asynchronous operations.
+ *
+ * @note It runs on the Wi-Fi manager task, so it must not block.
+ *
+ * @param[in] result The result of the operation.
+ * @param[in] arg The user argument given with the operation.
+ */
+typedef void (*wifi_api_done_cb_t)(esp_err_t result, void *arg);
+
+/**
+ * @brief Scan configuration of `wifi_api_scan_start`.
+ */
+typedef struct
+{
+  const uint8_t *channels; /**< Channels to scan, NULL scans all channels. */
+  size_t channel_count;    /**< Number of channels, at most 14. */
+  bool passive;            /**< Passive scan instead of sending probes. */
+  bool show_hidden;        /**< Report access points with hidden SSID. */
+  uint32_t dwell_min_ms;   /**< Minimum active dwell per channel, 0 default. */
+  uint32_t dwell_max_ms;   /**< Maximum dwell per channel, 0 default. */
+  wifi_ap_record_t *records; /**< Result buffer, NULL uses the pool. */
+  uint16_t max_records;      /**< Capacity of `records`. */
+} wifi_api_scan_config_t;
+
+/**
+ * @brief Default scan configuration: active scan of all channels, including
+ * hidden networks, with the driver dwell times.
+ */
+#define WIFI_API_SCAN_CONFIG_DEFAULT()                                         \
+  {                                                                            \
+    .channels = NULL, .channel_count = 0, .passive = false,                    \
+    .show_hidden = true, .dwell_min_ms = 0, .dwell_max_ms = 0,                 \
+    .records = NULL, .max_records = 0,                                         \
+  }
+
+/**
+ * @brief Callback for each access point found by `wifi_api_scan_start`.
+ *
+ * @param[in] record The access point record.
+ * @param[in] arg The user argument given to `wifi_api_scan_start`.
+ */
+typedef void (*wifi_api_scan_record_cb_t)(const wifi_ap_record_t *record,
+                                          void *arg);
+
+/**
+ * @brief Completion callback of `wifi_api_scan_start`.
+ *
+ * @param[in] ap_count Number of access points reported to the record callback.
+ * @param[in] status ESP_OK if every channel was scanned, an error code
+ * otherwise.
+ * @param[in] arg The user argument given to `wifi_api_scan_start`.
+ */
+typedef void (*wifi_api_scan_done_cb_t)(uint16_t ap_count, esp_err_t status,
+                                        void *arg);
+
+/**
+ * @brief Connection phases measured by the component.
+ *
+ * The driver reports no event between `esp_wifi_connect()` and
+ * `WIFI_EVENT_STA_CONNECTED`, so scan, authentication and association are
+ * measured together as `WIFI_API_PHASE_CONNECT`.
+ */
+typedef enum
+{
+  WIFI_API_PHASE_DRIVER_INIT = 0, /**< NVS, netif and driver initialization. */
+  WIFI_API_PHASE_START,           /**< `esp_wifi_start()` to `STA_START`. */
+  WIFI_API_PHASE_CONNECT,         /**< `esp_wifi_connect` to `STA_CONNECTED`. */
+  WIFI_API_PHASE_DHCP,            /**< `STA_CONNECTED` to `GOT_IP`. */
+  WIFI_API_PHASE_TOTAL,           /**< Configuration to the first `GOT_IP`. */
+  WIFI_API_PHASE_ROAM,            /**< Roam start to `STA_CONNECTED`. */
+  WIFI_API_PHASE_PROBE,           /**< Round trip of a watchdog probe. */
+  WIFI_API_PHASE_MAX,             /**< Number of phases. */
+} wifi_api_phase_t;
+
+/**
+ * @brief Latency statistics of a connection phase.
+ */
+typedef struct
+{
+  uint32_t count;  /**< Number of samples. */
+  uint32_t min_us; /**< Shortest duration. */
+  uint32_t avg_us; /**< Average duration. */
+  uint32_t max_us; /**< Longest duration. */
+  uint32_t p95_us; /**< Upper bound of the 95th percentile bucket. */
+} wifi_api_phase_stats_t;
+
+/**
+ * @brief Serialization formats of `wifi_api_scan_serialize`.
+ */
+typedef enum
+{
+  WIFI_API_FORMAT_JSON = 0, /**< Compact JSON array of objects. */
+  WIFI_API_FORMAT_CBOR,     /**< CBOR array of maps (RFC 8949). */
+} wifi_api_format_t;
+
+/**
+ * @brief Component events published to the subscribers.
+ */
+typedef enum
+{
+  WIFI_API_EVENT_CONNECTED = 0, /**< Got an IPv4 address. */
+  WIFI_API_EVENT_LOST_IP,       /**< Lost the IPv4 address. */
+  WIFI_API_EVENT_RSSI_LOW,      /**< RSSI dropped below the threshold. */
+  WIFI_API_EVENT_SCAN_DONE,     /**< A scan finished. */
+  WIFI_API_EVENT_ROAM,          /**< Reassociated with another AP. */
+  WIFI_API_EVENT_WATCHDOG,      /**< The watchdog started a recovery. */
+  WIFI_API_EVENT_MAX,
+} wifi_api_event_t;
+
+/**
+ * @brief Data of a component event.
+ */
+typedef struct
+{
+  wifi_api_event_t event; /**< The event. */
+  union
+  {
+    struct
+    {
+      esp_netif_ip_info_t ip_info; /**< Address, netmask and gateway. */
+    } connected; /**< `WIFI_API_EVENT_CONNECTED`. */
+    struct
+    {
+      int8_t rssi; /**< RSSI that crossed the threshold. */
+    } rssi_low; /**< `WIFI_API_EVENT_RSSI_LOW`. */
+    struct
+    {
+      uint16_t ap_count; /**< Number of scanned access points. */
+      esp_err_t status;  /**< Scan status. */
+    } scan_done; /**< `WIFI_API_EVENT_SCAN_DONE`. */
+    struct
+    {
+      uint8_t bssid[6]; /**< MAC address of the new AP. */
+      uint8_t channel;  /**< Channel of the new AP. */
+      int8_t rssi;      /**< RSSI of the new AP, 0 if unknown. */
+    } roam; /**< `WIFI_API_EVENT_ROAM`. */
+    struct
+    {
+      wifi_api_watchdog_action_t action; /**< Recovery action started. */
+      uint32_t failures; /**< Consecutive failed probes. */
+    } watchdog; /**< `WIFI_API_EVENT_WATCHDOG`. */
+  };
+} wifi_api_event_data_t;
+
+/**
+ * @brief Subscriber callback of a component event.
+ *
+ * @param[in] data The event data, valid only during the call.
+ * @param[in] arg The user argument given to `wifi_api_subscribe`.
+ */
+typedef void (*wifi_api_event_cb_t)(const wifi_api_event_data_t *data,
+                                    void *arg);
+
+/**
+ * @brief Sources of the event trace entries.
+ */
+typedef enum
+{
+  WIFI_API_TRACE_BASE_WIFI = 0, /**< `WIFI_EVENT`. */
+  WIFI_API_TRACE_BASE_IP,       /**< `IP_EVENT`. */
+  WIFI_API_TRACE_BASE_BOOT,     /**< Reset marker of a trace kept in RTC. */
+} wifi_api_trace_base_t;
+
+/**
+ * @brief Entry of the event trace, 12 bytes in little-endian order.
+ */
+typedef struct
+{
+  uint32_t time_ms; /**< `esp_timer_get_time()` in milliseconds. */
+  uint8_t base;     /**< `wifi_api_trace_base_t`. */
+  uint8_t id;       /**< Event ID within the base. */
+  uint8_t reason;   /**< Disconnect reason, 0 for other events. */
+  int8_t rssi;      /**< RSSI of disconnect and RSSI low events, else 0. */
+  uint8_t channel;  /**< Channel of connected events, else 0. */
+  uint8_t reserved[3];
+} wifi_api_trace_entry_t;
+
+/**
+ * @brief Access point entry of the scan cache.
+ */
+typedef struct
+{
+  uint8_t bssid[6];          /**< MAC address of the access point. */
+  uint8_t ssid[33];          /**< SSID of the access point. */
+  int8_t rssi;               /**< Signal strength of the last sighting. */
+  uint8_t channel;           /**< Primary channel. */
+  wifi_auth_mode_t authmode; /**< Authentication mode. */
+  int64_t last_seen_us;      /**< Time of the last sighting, microseconds. */
+} wifi_api_scan_entry_t;
+
+/**
+ * @brief Callback for each access point reported by `wifi_api_scan_cached`.
+ *
+ * @param[in] entry The cached access point.
+ * @param[in] arg The user argument given to `wifi_api_scan_cached`.
+ */
+typedef void (*wifi_api_scan_entry_cb_t)(const wifi_api_scan_entry_t *entry,
+                                         void *arg);
+
+/**
+ * @brief Initialize the Wi-Fi driver and the station interface.
+ *
+ * Reference counted: the first call initializes NVS, the TCP/IP stack, the
+ * default event loop (reused if the application created it) and the driver,
+ * later calls only take a reference. While a reference is held, the driver
+ * survives `wifi_api_disconnect` and `wifi_api_stop`, so cycling the station
+ * for power saving does not initialize it again.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+esp_err_t wifi_api_init();
+
+/**
+ * @brief Release a reference taken by `wifi_api_init`.
+ *
+ * The driver is deinitialized and the station interface destroyed with the
+ * last reference, including the ones held by `wifi_api_start` and the
+ * connection.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no reference taken by
+ * `wifi_api_init` is held.
+ */
+esp_err_t wifi_api_deinit();
+
+/**
+ * @brief Start the station radio without connecting, e.g. to scan.
+ *
+ * Reference counted like `wifi_api_init`, and holds a reference on the
+ * initialized driver until `wifi_api_stop`.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+esp_err_t wifi_api_start();
+
+/**
+ * @brief Release a reference taken by `wifi_api_start`.
+ *
+ * The radio is stopped with the last reference, including the one held by
+ * the connection.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no reference taken by
+ * `wifi_api_start` is held.
+ */
+esp_err_t wifi_api_stop();
 
 /**
  * @brief Configure Wi-Fi with the given SSID and password.
  *
- * Initializes the Wi-Fi station, sets up the event handler, and connects to the
- * specified network.
+ * Initializes and starts the Wi-Fi station, reusing a driver already
+ * initialized or started, and connects to the specified network. The
+ * connection holds a reference on the started driver until
+ * `wifi_api_disconnect`, calling it again only reconfigures the station.
+ * Blocks until an IP address is obtained or all retries are used.
  *
  * @param[in] ssid The SSID of the Wi-Fi network.
  * @param[in] password The password for the Wi-Fi network.
@@ -28,15 +554,159 @@
  */
 esp_err_t wifi_api_configure(const char *ssid, const char *password);
 
+/**
+ * @brief Configure Wi-Fi and wait for the connection with a bounded timeout.
+ *
+ * @param[in] ssid The SSID of the Wi-Fi network.
+ * @param[in] password The password for the Wi-Fi network.
+ * @param[in] timeout_ms Maximum time to wait in milliseconds, 0 waits until
+ * an IP address is obtained or all retries are used.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT on timeout, ESP_FAIL on failure,
+ * ESP_ERR_INVALID_STATE if called from a callback of the component.
+ */
+esp_err_t wifi_api_configure_timeout(const char *ssid, const char *password,
+                                     uint32_t timeout_ms);
+
+/**
+ * @brief Configure Wi-Fi and start connecting without blocking.
+ *
+ * Returns as soon as the request is queued to the Wi-Fi manager task. The
+ * result is reported once through `callback`. An attempt still pending when
+ * Wi-Fi is configured again reports `WIFI_API_RESULT_TIMEOUT`.
+ *
+ * @note After a timeout the station keeps retrying in the background.
+ *
+ * @param[in] ssid The SSID of the Wi-Fi network.
+ * @param[in] password The password for the Wi-Fi network.
+ * @param[in] timeout_ms Time in milliseconds after which
+ * `WIFI_API_RESULT_TIMEOUT` is reported, 0 disables the timeout.
+ * @param[in] callback Completion callback, may be NULL.
+ * @param[in] arg User argument passed to `callback`.
+ * @return ESP_OK if the connection was queued, ESP_ERR_NO_MEM if the command
+ * queue is full, an error code otherwise.
+ */
+esp_err_t wifi_api_configure_async(const char *ssid, const char *password,
+                                   uint32_t timeout_ms,
+                                   wifi_api_connect_cb_t callback, void *arg);
+
+/**
+ * @brief Add or replace a credential profile.
+ *
+ * A profile with the SSID of an existing one replaces it.
+ *
+ * @param[in] profile The profile, copied.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if
+ * `CONFIG_WIFI_API_MAX_PROFILES` profiles exist, ESP_ERR_INVALID_ARG if the
+ * SSID is empty or a field is not NUL-terminated.
+ */
+esp_err_t wifi_api_add_profile(const wifi_api_profile_t *profile);
+
+/**
+ * @brief Remove a credential profile.
+ *
+ * @param[in] ssid The SSID of the profile.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such profile.
+ */
+esp_err_t wifi_api_remove_profile(const char *ssid);
+
+/**
+ * @brief Get the number of credential profiles.
+ *
+ * @return The number of profiles.
+ */
+size_t wifi_api_get_profile_count();
+
+/**
+ * @brief Add or replace a credential profile and persist it in NVS.
+ *
+ * Profiles are stored in the `CONFIG_WIFI_API_STORE_PARTITION` partition,
+ * encrypted with `CONFIG_NVS_ENCRYPTION`, under a key derived from a hash of
+ * the SSID, so storing or erasing a profile reads a single entry. The flash
+ * is only written when the profile is new or changed.
+ *
+ * @param[in] profile The profile, copied.
+ * @return ESP_OK on success, the errors of `wifi_api_add_profile`,
+ * ESP_ERR_NO_MEM if `CONFIG_WIFI_API_MAX_PROFILES` profiles are stored, an
+ * NVS error code otherwise. The profile is used until reboot even if it
+ * could not be stored.
+ */
+esp_err_t wifi_api_store_profile(const wifi_api_profile_t *profile);
+
+/**
+ * @brief Remove a credential profile and erase it from NVS.
+ *
+ * @param[in] ssid The SSID of the profile.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the profile is not stored,
+ * an NVS error code otherwise.
+ */
+esp_err_t wifi_api_erase_profile(const char *ssid);
+
+/**
+ * @brief Add the profiles stored in NVS to the credential profiles.
+ *
+ * Called by `wifi_api_configure_profiles` when there is no profile, so a
+ * device reconnects after a reboot without providing the credentials again.
+ *
+ * @param[out] count Number of profiles loaded, may be NULL.
+ * @return ESP_OK on success, an NVS error code otherwise.
+ */
+esp_err_t wifi_api_load_profiles(size_t *count);
+
+/**
+ * @brief Configure Wi-Fi with the best credential profile in range and wait
+ * for the connection.
+ *
+ * A single scan ranks the visible access points of every profile by
+ * priority, then by RSSI with a small credit for stronger security, and the
+ * station connects directly to the BSSID and channel of the best one. Every
+ * reconnection repeats the selection, and `WIFI_API_RETRY_SWITCH_PROFILE`
+ * skips the current profile until a connection succeeds. The cached access
+ * point is joined without a scan only if its profile has the highest
+ * priority. Without profiles, the ones stored in NVS are loaded first.
+ *
+ * @param[in] timeout_ms Maximum time to wait in milliseconds, 0 waits until
+ * an IP address is obtained or all retries are used.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT on timeout, ESP_FAIL on failure,
+ * ESP_ERR_INVALID_STATE if there is no profile, even in NVS.
+ */
+esp_err_t wifi_api_configure_profiles(uint32_t timeout_ms);
+
+/**
+ * @brief Configure Wi-Fi with the best credential profile in range without
+ * blocking.
+ *
+ * @param[in] timeout_ms Time in milliseconds after which
+ * `WIFI_API_RESULT_TIMEOUT` is reported, 0 disables the timeout.
+ * @param[in] callback Completion callback, may be NULL.
+ * @param[in] arg User argument passed to `callback`.
+ * @return ESP_OK if the connection was queued, ESP_ERR_NO_MEM if the command
+ * queue is full, ESP_ERR_INVALID_STATE if there is no profile, even in NVS.
+ */
+esp_err_t wifi_api_configure_profiles_async(uint32_t timeout_ms,
+                                            wifi_api_connect_cb_t callback,
+                                            void *arg);
+
 /**
  * @brief Disconnect from the Wi-Fi network.
  *
- * Unregisters the event handlers and cleans up resources.
+ * Releases the references held by the connection: the driver is stopped and
+ * deinitialized unless `wifi_api_start` or `wifi_api_init` hold their own.
+ * Does nothing if not connected.
  *
  * @return ESP_OK on success, ESP_FAIL on failure.
  */
 esp_err_t wifi_api_disconnect();
 
+/**
+ * @brief Disconnect from the Wi-Fi network without blocking.
+ *
+ * @param[in] callback Completion callback, may be NULL.
+ * @param[in] arg User argument passed to `callback`.
+ * @return ESP_OK if the request was queued, ESP_ERR_NO_MEM if the command
+ * queue is full.
+ */
+esp_err_t wifi_api_disconnect_async(wifi_api_done_cb_t callback, void *arg);
+
 /**
  * @brief Alter the Wi-Fi STA configuration dynamically.
  *
@@ -49,14 +719,504 @@ esp_err_t wifi_api_disconnect();
 esp_err_t wifi_api_alter_sta(const char *new_ssid, const char *new_password);
 
 /**
- * @brief Start a Wi-Fi scan.
+ * @brief Alter the Wi-Fi STA configuration without blocking.
+ *
+ * @param[in] new_ssid The new SSID for the Wi-Fi network.
+ * @param[in] new_password The new password for the Wi-Fi network.
+ * @param[in] callback Completion callback, may be NULL.
+ * @param[in] arg User argument passed to `callback`.
+ * @return ESP_OK if the request was queued, ESP_ERR_NO_MEM if the command
+ * queue is full, ESP_ERR_INVALID_ARG if a credential is too long.
+ */
+esp_err_t wifi_api_alter_sta_async(const char *new_ssid,
+                                   const char *new_password,
+                                   wifi_api_done_cb_t callback, void *arg);
+
+/**
+ * @brief Start a Wi-Fi scan that logs every access point found.
  *
- * This function prints the authentication mode of the Wi-Fi network based on
- * the `authmode` parameter.
+ * The scan runs in the background on all channels, including hidden
+ * networks, and the results are printed as they are received.
  *
  * @note It must be called after a successful Wi-Fi connection, i.e., after
  * `esp_wifi_start()` and `esp_wifi_connect()`.
  */
 void wifi_api_scan();
 
+/**
+ * @brief Start a non-blocking Wi-Fi scan.
+ *
+ * Returns as soon as the scan is started. On every `WIFI_EVENT_SCAN_DONE` the
+ * records are streamed one by one to `record_cb`, and `done_cb` is called
+ * once every channel of the channel set was scanned. When a channel set is
+ * given the channels are scanned one at a time.
+ *
+ * @note The callbacks run on the Wi-Fi manager task, so they must not block.
+ * If the scan cannot be started, e.g. because another scan is running,
+ * `done_cb` is called with the error.
+ *
+ * @param[in] config The scan configuration.
+ * @param[in] record_cb Callback for each access point found, may be NULL.
+ * @param[in] done_cb Completion callback, may be NULL.
+ * @param[in] arg User argument passed to the callbacks.
+ * @return ESP_OK if the scan was queued, ESP_ERR_NO_MEM if the command queue
+ * is full, an error code otherwise.
+ */
+esp_err_t wifi_api_scan_start(const wifi_api_scan_config_t *config,
+                              wifi_api_scan_record_cb_t record_cb,
+                              wifi_api_scan_done_cb_t done_cb, void *arg);
+
+/**
+ * @brief Allocate the scan result pool.
+ *
+ * The pool is allocated once and stores the records of every scan started
+ * without a caller buffer, so scans do not allocate memory.
+ *
+ * @note It should be called once at initialization.
+ *
+ * @param[in] capacity Number of records the pool holds.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the allocation failed,
+ * ESP_ERR_INVALID_STATE if the pool exists with a different capacity.
+ */
+esp_err_t wifi_api_scan_pool_init(uint16_t capacity);
+
+/**
+ * @brief Get the records of the last scan.
+ *
+ * The records are stored in the caller buffer given in the scan
+ * configuration, or in the pool allocated by `wifi_api_scan_pool_init`. They
+ * are looked up on the Wi-Fi manager task, which fills them as a scan
+ * completes.
+ *
+ * @param[out] records The stored records, valid until the next scan.
+ * @param[out] count Number of stored records.
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the buffer could not hold
+ * every record found, ESP_ERR_INVALID_STATE if a scan is running.
+ */
+esp_err_t wifi_api_scan_get_results(const wifi_ap_record_t **records,
+                                    uint16_t *count);
+
+/**
+ * @brief Allocate the scan cache.
+ *
+ * Once allocated, every scan merges its records into the cache, keyed by
+ * BSSID. A partial (channel set) scan only refreshes the scanned channels.
+ * When the cache is full the access point seen least recently is replaced.
+ *
+ * @param[in] capacity Number of access points the cache holds.
+ * @param[in] ttl_ms Age in milliseconds after which cached data is stale.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the allocation failed,
+ * ESP_ERR_INVALID_STATE if the cache already exists.
+ */
+esp_err_t wifi_api_scan_cache_init(uint16_t capacity, uint32_t ttl_ms);
+
+/**
+ * @brief Query the access points of a channel set, scanning only if needed.
+ *
+ * The query runs on the Wi-Fi manager task. If every channel of the set was
+ * scanned within the TTL, the fresh entries are reported before this
+ * function returns, without using the radio. Otherwise only the stale
+ * channels are scanned in the background (with the mode and dwell times of
+ * `config`) and the entries are reported once the scan finishes. Only one
+ * query can wait for a scan at a time.
+ *
+ * @note The callbacks run on the Wi-Fi manager task and must not call the
+ * scan cache functions.
+ *
+ * @param[in] config The scan configuration, `records` is ignored.
+ * @param[in] entry_cb Callback for each fresh access point, may be NULL.
+ * @param[in] done_cb Completion callback, may be NULL.
+ * @param[in] arg User argument passed to the callbacks.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the cache is not
+ * allocated, a previous query is still pending or a scan is needed while
+ * another one is running.
+ */
+esp_err_t wifi_api_scan_cached(const wifi_api_scan_config_t *config,
+                               wifi_api_scan_entry_cb_t entry_cb,
+                               wifi_api_scan_done_cb_t done_cb, void *arg);
+
+/**
+ * @brief Serialize scan records into a caller buffer.
+ *
+ * Each access point is encoded with the keys `ssid`, `bssid`, `rssi`,
+ * `channel` and `auth`. In CBOR the BSSID is a 6-byte byte string. No memory
+ * is allocated.
+ *
+ * SSIDs are raw bytes that may not be valid UTF-8. In JSON each byte outside
+ * a valid UTF-8 sequence is escaped as `\u00XX`. In CBOR such an SSID is
+ * encoded as a byte string instead of a text string.
+ *
+ * @param[in] records The access point records.
+ * @param[in] count Number of records.
+ * @param[in] format The output format.
+ * @param[out] buffer The output buffer, not NUL-terminated.
+ * @param[in] size Capacity of `buffer`.
+ * @param[out] length Bytes written, or bytes required if the buffer is too
+ * small.
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the buffer is too small,
+ * in which case its content is invalid.
+ */
+esp_err_t wifi_api_scan_serialize(const wifi_ap_record_t *records,
+                                  uint16_t count, wifi_api_format_t format,
+                                  uint8_t *buffer, size_t size,
+                                  size_t *length);
+
+/**
+ * @brief Get the name of an authentication mode.
+ *
+ * @param[in] authmode The authentication mode.
+ * @return The name without the `WIFI_AUTH_` prefix, "UNKNOWN" if invalid.
+ */
+const char *wifi_api_authmode_name(wifi_auth_mode_t authmode);
+
+/**
+ * @brief Stop the scan started by `wifi_api_scan_start`.
+ *
+ * The completion callback is not called.
+ *
+ * @return ESP_OK if the request was queued, ESP_ERR_NO_MEM if the command
+ * queue is full.
+ */
+esp_err_t wifi_api_scan_stop();
+
+/**
+ * @brief Select how the station interface obtains its IP address.
+ *
+ * In `WIFI_API_IP_MODE_CACHED_LEASE` the last DHCP lease is stored in NVS and
+ * applied right away on the next connection, skipping the DHCP exchange. The
+ * lease is revalidated in the background by probing the gateway and falls back
+ * to DHCP if the gateway is unreachable or the lease expires.
+ *
+ * @note It must be called before `wifi_api_configure()`.
+ *
+ * @param[in] mode The IP configuration mode.
+ * @param[in] static_ip The IP configuration, required for
+ * `WIFI_API_IP_MODE_STATIC` and ignored otherwise.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if `static_ip` is missing.
+ */
+esp_err_t wifi_api_set_ip_mode(wifi_api_ip_mode_t mode,
+                               const wifi_api_ip_config_t *static_ip);
+
+/**
+ * @brief Set the reconnection backoff configuration.
+ *
+ * `max_retry` only bounds the initial connection. Once the station got an IP
+ * address it keeps reconnecting with backoff until `wifi_api_disconnect()`.
+ *
+ * @param[in] config The backoff configuration.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the delays are invalid.
+ */
+esp_err_t wifi_api_set_retry_config(const wifi_api_retry_config_t *config);
+
+/**
+ * @brief Set the action taken when the station is disconnected with the given
+ * reason.
+ *
+ * By default beacon timeouts reconnect immediately, missing APs rescan,
+ * authentication failures switch to the next profile (giving up after
+ * `CONFIG_WIFI_API_MAX_PROFILES` failures, or without another profile), MIC
+ * failures give up, handshake timeouts give up after two occurrences and any
+ * other reason backs off.
+ *
+ * @param[in] reason The `wifi_err_reason_t` disconnect reason.
+ * @param[in] action The action taken on this reason.
+ * @param[in] limit Occurrences without a successful connection after which
+ * the station gives up, 0 for no limit.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the action is invalid,
+ * ESP_ERR_NO_MEM if the policy table is full.
+ */
+esp_err_t wifi_api_set_retry_policy(uint8_t reason,
+                                    wifi_api_retry_action_t action,
+                                    uint8_t limit);
+
+/**
+ * @brief Enable roaming between access points of the same network.
+ *
+ * When the RSSI of the current AP drops below the threshold, the configured
+ * channels are scanned in the background while the station stays connected.
+ * If an AP with the same SSID is stronger by at least `min_gain_db`, the
+ * station reassociates with its BSSID directly. The reassociation leaves the
+ * current AP first, so the DHCP address is kept as a static one meanwhile,
+ * then handed back to DHCP, which renews it on the new AP; no
+ * `WIFI_API_EVENT_LOST_IP` is published. The `WIFI_API_STATE_ROAMING` bit
+ * is set during the attempt, and the time from the decision to the new
+ * association is recorded as `WIFI_API_PHASE_ROAM`.
+ *
+ * With `CONFIG_WIFI_API_11K`, an AP supporting radio measurement is first
+ * asked for a neighbor report and only the channels it lists are scanned.
+ *
+ * Roams initiated by the supplicant, after a BSS transition request or a fast
+ * transition, are detected from the `WIFI_REASON_ROAMING` disconnection
+ * whether roaming is enabled or not: the retry policy is not run, the
+ * `WIFI_API_STATE_ROAMING` bit is set until the station is associated again,
+ * the address is kept, and a move to another BSSID is recorded as
+ * `WIFI_API_PHASE_ROAM`.
+ *
+ * @param[in] config The roaming configuration, copied, NULL disables
+ * roaming.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the configuration is
+ * invalid, ESP_ERR_INVALID_STATE while roaming.
+ */
+esp_err_t wifi_api_set_roaming(const wifi_api_roam_config_t *config);
+
+/**
+ * @brief Select the driver buffer profile.
+ *
+ * The profile sets the RX and TX buffer counts and the AMPDU settings of
+ * `wifi_init_config_t`, the nonzero `CONFIG_WIFI_API_*_BUF_NUM` and
+ * `CONFIG_WIFI_API_RX_BA_WIN` options override it. The default profile is
+ * selected in Kconfig.
+ *
+ * @param[in] profile The profile.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the profile is invalid,
+ * ESP_ERR_INVALID_STATE if the driver is initialized.
+ */
+esp_err_t wifi_api_set_driver_profile(wifi_api_driver_profile_t profile);
+
+/**
+ * @brief Get the memory cost of the last driver initialization.
+ *
+ * The cost is also logged at initialization.
+ *
+ * @param[out] memory The memory cost.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if `memory` is NULL,
+ * ESP_ERR_INVALID_STATE if the driver was never initialized.
+ */
+esp_err_t wifi_api_get_driver_memory(wifi_api_driver_memory_t *memory);
+
+/**
+ * @brief Select the modem power-save profile.
+ *
+ * Applied at once if the driver is started, otherwise when it starts. The
+ * listen interval is sent to the AP on association, so a new one applies
+ * from the next connection.
+ *
+ * @param[in] profile The profile.
+ * @param[in] listen_interval Beacon intervals between wake-ups in the
+ * max-modem profile, 0 keeps the current one (3 by default).
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the profile is invalid,
+ * ESP_ERR_INVALID_STATE while the governor is enabled.
+ */
+esp_err_t wifi_api_set_power_profile(wifi_api_power_profile_t profile,
+                                     uint8_t listen_interval);
+
+/**
+ * @brief Get the modem power-save profile in use.
+ *
+ * @return The profile.
+ */
+wifi_api_power_profile_t wifi_api_get_power_profile();
+
+/**
+ * @brief Let a governor select the power-save profile from the traffic.
+ *
+ * The packets received and sent by the station are sampled periodically.
+ * A sample with at least `active_packets` switches to the active profile at
+ * once, and the idle profile is selected after `idle_ms` without such a
+ * sample.
+ *
+ * @param[in] config The governor configuration, copied, NULL disables the
+ * governor and keeps the current profile.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the configuration is
+ * invalid.
+ */
+esp_err_t wifi_api_set_power_governor(const wifi_api_power_governor_t *config);
+
+/**
+ * @brief Get the time spent in each power-save profile while the driver was
+ * started, and the number of profile changes.
+ *
+ * @param[out] stats The statistics.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if `stats` is NULL.
+ */
+esp_err_t wifi_api_get_power_stats(wifi_api_power_stats_t *stats);
+
+/**
+ * @brief Reset the power-save statistics.
+ */
+void wifi_api_reset_power_stats();
+
+/**
+ * @brief Change the link quality sampler.
+ *
+ * While associated, the RSSI is sampled periodically on the Wi-Fi manager
+ * task and smoothed into an average, a variance and a trend, so a degrading
+ * link can be noticed before it drops. The statistics restart on every
+ * association. Enabled with the default configuration.
+ *
+ * @param[in] config The sampler configuration, copied, NULL disables the
+ * sampler.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the configuration is
+ * invalid.
+ */
+esp_err_t wifi_api_set_link_sampling(const wifi_api_link_config_t *config);
+
+/**
+ * @brief Get the link quality of the current connection.
+ *
+ * Takes no lock and never blocks, so it can be called from any task as
+ * often as needed.
+ *
+ * @param[out] quality The link quality.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if `quality` is NULL,
+ * ESP_ERR_INVALID_STATE if no sample was taken since the association.
+ */
+esp_err_t wifi_api_get_link_quality(wifi_api_link_quality_t *quality);
+
+/**
+ * @brief Change the connectivity watchdog.
+ *
+ * While the station has an IPv4 address, the watchdog probes the gateway or
+ * an endpoint every `interval_ms` from its own task. Every `failures`
+ * consecutive failed probes start the next recovery action, renewing the
+ * DHCP lease, then reassociating, then restarting the driver, which is
+ * repeated until a probe succeeds. Round trips are recorded as
+ * `WIFI_API_PHASE_PROBE` and each action publishes `WIFI_API_EVENT_WATCHDOG`.
+ * Disabled by default.
+ *
+ * @param[in] config The watchdog configuration, copied, NULL disables the
+ * watchdog.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the configuration is
+ * invalid, ESP_ERR_NO_MEM if the watchdog task could not be created.
+ */
+esp_err_t wifi_api_set_watchdog(const wifi_api_watchdog_config_t *config);
+
+/**
+ * @brief Get the connectivity watchdog statistics.
+ *
+ * @param[out] stats The statistics.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if `stats` is NULL.
+ */
+esp_err_t wifi_api_get_watchdog_stats(wifi_api_watchdog_stats_t *stats);
+
+/**
+ * @brief Reset the connectivity watchdog statistics.
+ */
+void wifi_api_reset_watchdog_stats();
+
+/**
+ * @brief Get the connection state.
+ *
+ * @return The `WIFI_API_STATE_*` bits currently set.
+ */
+uint32_t wifi_api_get_state();
+
+/**
+ * @brief Wait until the connection state matches the given bits.
+ *
+ * Any number of tasks may wait at the same time, the bits are not cleared on
+ * return.
+ *
+ * @param[in] bits The `WIFI_API_STATE_*` bits to wait for.
+ * @param[in] wait_all Whether all the bits must be set, or any of them.
+ * @param[in] timeout_ms Maximum time to wait in milliseconds, 0 waits
+ * forever.
+ * @return The state bits when the wait ended, check them to tell a match from
+ * a timeout.
+ */
+uint32_t wifi_api_wait_state(uint32_t bits, bool wait_all,
+                             uint32_t timeout_ms);
+
+/**
+ * @brief Subscribe a callback to a component event.
+ *
+ * Immediate subscribers run on the Wi-Fi manager task as soon as the event
+ * is published, so they must not block. Deferred subscribers run on a
+ * separate delivery task, created on the first deferred subscription, so a
+ * slow subscriber never delays the connection handling; if the delivery
+ * queue is full the event is dropped for them.
+ *
+ * @param[in] event The event.
+ * @param[in] callback The callback.
+ * @param[in] arg User argument passed to `callback`.
+ * @param[in] deferred Whether to deliver the event from the delivery task.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the event has
+ * `CONFIG_WIFI_API_MAX_SUBSCRIBERS` subscribers or the delivery task could
+ * not be created.
+ */
+esp_err_t wifi_api_subscribe(wifi_api_event_t event,
+                             wifi_api_event_cb_t callback, void *arg,
+                             bool deferred);
+
+/**
+ * @brief Unsubscribe a callback from a component event.
+ *
+ * @param[in] event The event.
+ * @param[in] callback The callback given to `wifi_api_subscribe`.
+ * @param[in] arg The user argument given to `wifi_api_subscribe`.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if not subscribed.
+ */
+esp_err_t wifi_api_unsubscribe(wifi_api_event_t event,
+                               wifi_api_event_cb_t callback, void *arg);
+
+/**
+ * @brief Set the RSSI below which `WIFI_API_EVENT_RSSI_LOW` is published.
+ *
+ * The threshold is armed on every association. After an event only a
+ * further drop of 5 dB is reported, until a link quality sample shows the
+ * RSSI 5 dB above the threshold again.
+ *
+ * @param[in] rssi The threshold in dBm, 0 disables the event.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if `rssi` is positive.
+ */
+esp_err_t wifi_api_set_rssi_threshold(int8_t rssi);
+
+/**
+ * @brief Copy the event trace, oldest entry first.
+ *
+ * Entries overwritten while copying are left out. The entries can be sent
+ * as-is to a host and decoded with `tools/wifi_api_trace.py`.
+ *
+ * @param[out] entries The output entries.
+ * @param[in] max Capacity of `entries`, the newest entries are kept.
+ * @return Number of entries copied, 0 if `CONFIG_WIFI_API_TRACE` is disabled.
+ */
+size_t wifi_api_trace_read(wifi_api_trace_entry_t *entries, size_t max);
+
+/**
+ * @brief Log the event trace.
+ */
+void wifi_api_trace_dump();
+
+/**
+ * @brief Clear the event trace.
+ */
+void wifi_api_trace_clear();
+
+/**
+ * @brief Get the number of disconnections with the given reason.
+ *
+ * @param[in] reason The `wifi_err_reason_t` disconnect reason.
+ * @return The number of disconnections, saturating at `UINT16_MAX`.
+ */
+uint16_t wifi_api_get_disconnect_count(uint8_t reason);
+
+/**
+ * @brief Reset the per-reason disconnection counters.
+ */
+void wifi_api_reset_disconnect_counts();
+
+/**
+ * @brief Get the latency statistics of a connection phase.
+ *
+ * Durations are kept in a fixed-size histogram of power-of-two millisecond
+ * buckets, so the 95th percentile is the upper bound of its bucket.
+ *
+ * @param[in] phase The connection phase.
+ * @param[out] stats The statistics.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the phase is invalid.
+ */
+esp_err_t wifi_api_get_phase_stats(wifi_api_phase_t phase,
+                                   wifi_api_phase_stats_t *stats);
+
+/**
+ * @brief Log the latency statistics of every connection phase.
+ */
+void wifi_api_dump_phase_stats();
+
+/**
+ * @brief Reset the latency statistics of every connection phase.
+ */
+void wifi_api_reset_phase_stats();
+
 #endif // WIFI_API_H
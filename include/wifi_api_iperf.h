@@ -0,0 +1,109 @@
+/**
+ * @file wifi_api_iperf.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief iperf2 compatible TCP/UDP throughput benchmark
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef WIFI_API_IPERF_H
+#define WIFI_API_IPERF_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of cores reported in `wifi_api_iperf_result_t`.
+ */
+#define WIFI_API_IPERF_MAX_CORES 2
+
+/**
+ * @brief Role of the benchmark.
+ */
+typedef enum
+{
+  WIFI_API_IPERF_CLIENT = 0, /**< Send to an iperf2 server (`iperf -s`). */
+  WIFI_API_IPERF_SERVER,     /**< Receive from an iperf2 client (`iperf -c`). */
+} wifi_api_iperf_role_t;
+
+/**
+ * @brief Transport of the benchmark.
+ */
+typedef enum
+{
+  WIFI_API_IPERF_TCP = 0, /**< TCP stream. */
+  WIFI_API_IPERF_UDP,     /**< UDP datagrams, `iperf -u`. */
+} wifi_api_iperf_proto_t;
+
+/**
+ * @brief Benchmark configuration of `wifi_api_iperf_run`.
+ */
+typedef struct
+{
+  wifi_api_iperf_role_t role;   /**< Client or server. */
+  wifi_api_iperf_proto_t proto; /**< TCP or UDP. */
+  const char *host;             /**< IPv4 address of the server (client). */
+  uint16_t port;                /**< Port of the server. */
+  uint32_t duration_s;  /**< Test length (client), 0 waits forever (server). */
+  uint32_t bandwidth_kbps; /**< UDP client rate, 0 for no pacing. */
+  uint16_t length;      /**< Bytes per send or datagram. */
+  uint32_t interval_s;  /**< Period of the progress log, 0 for none. */
+} wifi_api_iperf_config_t;
+
+/**
+ * @brief Default benchmark configuration, a 10 second TCP client test.
+ */
+#define WIFI_API_IPERF_CONFIG_DEFAULT()                                        \
+  {                                                                            \
+    .role = WIFI_API_IPERF_CLIENT, .proto = WIFI_API_IPERF_TCP, .host = NULL,  \
+    .port = 5001, .duration_s = 10, .bandwidth_kbps = 1000, .length = 1460,    \
+    .interval_s = 1,                                                           \
+  }
+
+/**
+ * @brief Benchmark result of `wifi_api_iperf_run`.
+ *
+ * For a UDP client, jitter and loss come from the report of the server.
+ */
+typedef struct
+{
+  uint64_t bytes;           /**< Payload bytes sent or received. */
+  uint32_t duration_ms;     /**< Test duration. */
+  uint32_t throughput_kbps; /**< Payload throughput. */
+  uint32_t jitter_us;       /**< UDP interarrival jitter (RFC 3550). */
+  uint32_t datagrams;       /**< UDP datagrams sent or received. */
+  uint32_t lost;            /**< UDP datagrams lost. */
+  uint32_t out_of_order;    /**< UDP datagrams received out of order. */
+  int8_t cpu_load[WIFI_API_IPERF_MAX_CORES]; /**< Load per core in percent,
+                                                  -1 if unknown. */
+} wifi_api_iperf_result_t;
+
+/**
+ * @brief Run a benchmark in the calling task.
+ *
+ * Uses the BSD socket API only, so it also runs in the Linux host build.
+ * On the device, the station must have an IPv4 address. The CPU load needs
+ * `CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS`.
+ *
+ * @param[in] config The benchmark configuration.
+ * @param[out] result The result.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the configuration is
+ * invalid, ESP_ERR_INVALID_STATE if the station is not connected,
+ * ESP_ERR_NO_MEM if the buffer cannot be allocated, ESP_FAIL on a socket
+ * error.
+ */
+esp_err_t wifi_api_iperf_run(const wifi_api_iperf_config_t *config,
+                             wifi_api_iperf_result_t *result);
+
+/**
+ * @brief Stop the running benchmark, which returns its partial result.
+ */
+void wifi_api_iperf_stop();
+
+#endif // WIFI_API_IPERF_H
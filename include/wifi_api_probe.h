@@ -0,0 +1,36 @@
+/**
+ * @file wifi_api_probe.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief TCP reachability probe of the connectivity watchdog
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef WIFI_API_PROBE_H
+#define WIFI_API_PROBE_H
+
+#include <esp_err.h>
+#include <stdint.h>
+
+/**
+ * @brief Open and close a TCP connection to an endpoint.
+ *
+ * Uses the BSD socket API only, so it also runs in the Linux host build.
+ *
+ * @param[in] host IPv4 address of the endpoint.
+ * @param[in] port Port of the endpoint.
+ * @param[in] timeout_ms Time to wait for the connection.
+ * @param[out] latency_us Time the connection took, may be NULL.
+ * @return ESP_OK if the endpoint accepted the connection,
+ * ESP_ERR_INVALID_ARG if `host` is not an IPv4 address, ESP_ERR_TIMEOUT if
+ * it did not answer in time, ESP_FAIL if it refused or is unreachable.
+ */
+esp_err_t wifi_api_probe_tcp(const char *host, uint16_t port,
+                             uint32_t timeout_ms, uint32_t *latency_us);
+
+#endif // WIFI_API_PROBE_H
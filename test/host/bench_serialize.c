@@ -0,0 +1,118 @@
+/**
+ * @file bench_serialize.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Encode throughput of the scan result serializer for 64 APs
+ *
+ * Measured on the host clock, the serializer does not depend on the
+ * simulation. Run it with `ctest -L bench -V` to see the results.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Access points of a result set.
+ */
+#define RECORDS 64
+
+/**
+ * @brief Encodes of a result set per format.
+ */
+#define ITERATIONS 20000
+
+/**
+ * @brief Fill a result set: short, full length, non UTF-8 and multibyte
+ * SSIDs, with every authentication mode.
+ *
+ * @param records The records.
+ */
+static void records_fill(wifi_ap_record_t *records)
+{
+  memset(records, 0, sizeof(wifi_ap_record_t) * RECORDS);
+  for (int i = 0; i < RECORDS; i++)
+  {
+    wifi_ap_record_t *record = &records[i];
+    switch (i % 4)
+    {
+      case 0:
+        snprintf((char *)record->ssid, sizeof(record->ssid), "net%02d", i);
+        break;
+      case 1:
+        memset(record->ssid, 'a' + i % 26, sizeof(record->ssid));
+        break;
+      case 2:
+        snprintf((char *)record->ssid, sizeof(record->ssid), "\"q\\%c\xff", i);
+        break;
+      default:
+        snprintf((char *)record->ssid, sizeof(record->ssid),
+                 "caf\xc3\xa9 %02d", i);
+        break;
+    }
+    uint8_t bssid[6] = {0x24, 0x0a, 0xc4, 0x00, (uint8_t)(i >> 8),
+                        (uint8_t)i};
+    memcpy(record->bssid, bssid, sizeof(bssid));
+    record->primary = 1 + i % SIM_CHANNELS;
+    record->rssi = -30 - i;
+    record->authmode = i % WIFI_AUTH_MAX;
+  }
+}
+
+/**
+ * @brief Time the encodes of a result set in a format and check the output.
+ *
+ * @param name The format name.
+ * @param format The format.
+ * @param records The records.
+ */
+static void bench_format(const char *name, wifi_api_format_t format,
+                         const wifi_ap_record_t *records)
+{
+  size_t length = 0;
+  CHECK(wifi_api_scan_serialize(records, RECORDS, format, NULL, 0, &length) ==
+        ESP_ERR_INVALID_SIZE);
+  uint8_t *buffer = malloc(length);
+  size_t written = 0;
+  CHECK_OK(wifi_api_scan_serialize(records, RECORDS, format, buffer, length,
+                                   &written));
+  CHECK(written == length);
+  CHECK(wifi_api_scan_serialize(records, RECORDS, format, buffer, length - 1,
+                                &written) == ESP_ERR_INVALID_SIZE);
+  if (format == WIFI_API_FORMAT_JSON)
+    CHECK(buffer[0] == '[' && buffer[length - 1] == ']');
+  else
+    // Array of 64 items, the count in the following byte
+    CHECK(buffer[0] == 0x98 && buffer[1] == RECORDS);
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (int i = 0; i < ITERATIONS; i++)
+    wifi_api_scan_serialize(records, RECORDS, format, buffer, length,
+                            &written);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  free(buffer);
+
+  double seconds =
+    (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("  %-6s %6zu bytes %10.2f us/set %10.0f sets/s %8.1f MB/s\n", name,
+         length, seconds * 1e6 / ITERATIONS, ITERATIONS / seconds,
+         length * (double)ITERATIONS / seconds / 1e6);
+}
+
+int main()
+{
+  static wifi_ap_record_t records[RECORDS];
+  records_fill(records);
+  bench_format("json", WIFI_API_FORMAT_JSON, records);
+  bench_format("cbor", WIFI_API_FORMAT_CBOR, records);
+  printf("%-40s %s\n", "serialize", s_test_failures ? "FAILED" : "ok");
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,272 @@
+/**
+ * @file bench_wifi_api.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Latency benchmarks of the component on the virtual clock
+ *
+ * Every scenario runs against the default simulated timing, so the results
+ * only change with the behavior of the component and compare two revisions
+ * directly. Run it with `ctest -L bench -V` to see the table.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+
+#include <freertos/semphr.h>
+
+/**
+ * @brief Runs of the repeated scenarios.
+ */
+#define BENCH_RUNS 5
+
+/**
+ * @brief Latencies of a scenario.
+ */
+typedef struct
+{
+  const char *name; /**< Scenario. */
+  uint32_t runs;    /**< Samples. */
+  double min_ms;    /**< Shortest. */
+  double sum_ms;    /**< Sum of the samples. */
+  double max_ms;    /**< Longest. */
+} bench_result_t;
+
+/**
+ * @brief Add a sample to a scenario.
+ *
+ * @param result The scenario.
+ * @param ms The latency.
+ */
+static void bench_sample(bench_result_t *result, double ms)
+{
+  if (result->runs == 0 || ms < result->min_ms)
+    result->min_ms = ms;
+  if (ms > result->max_ms)
+    result->max_ms = ms;
+  result->sum_ms += ms;
+  result->runs++;
+}
+
+/**
+ * @brief Print a scenario.
+ *
+ * @param result The scenario.
+ */
+static void bench_print(const bench_result_t *result)
+{
+  printf("  %-32s %4u %10.1f %10.1f %10.1f\n", result->name,
+         (unsigned)result->runs, result->min_ms,
+         result->runs ? result->sum_ms / result->runs : 0.0, result->max_ms);
+}
+
+/**
+ * @brief Cold connection while another network is cached, then a
+ * reconnection reusing the cached AP.
+ */
+static void bench_connect(void *arg)
+{
+  test_ap("home", 1, 11, -50);
+  test_ap("lab", 2, 1, -50);
+
+  bench_result_t cold = {.name = "connect, cold"};
+  bench_result_t cached = {.name = "connect, cached AP"};
+  for (int i = 0; i < BENCH_RUNS; i++)
+  {
+    CHECK_OK(wifi_api_configure("lab", "password"));
+    test_disconnect();
+
+    int64_t start = sim_now_us();
+    CHECK_OK(wifi_api_configure("home", "password"));
+    bench_sample(&cold, test_elapsed_ms(start));
+    test_disconnect();
+
+    start = sim_now_us();
+    CHECK_OK(wifi_api_configure("home", "password"));
+    bench_sample(&cached, test_elapsed_ms(start));
+    test_disconnect();
+  }
+  CHECK(cached.max_ms < cold.min_ms);
+  bench_print(&cold);
+  bench_print(&cached);
+}
+
+/**
+ * @brief Reconnection after the AP went down, from the AP coming back to
+ * the new address.
+ */
+static void bench_ap_flap(void *arg)
+{
+  int ap = test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+
+  bench_result_t flap = {.name = "reconnect after AP flap"};
+  uint32_t beacon_timeout_ms = sim_get_timing().beacon_timeout_ms;
+  for (int i = 0; i < BENCH_RUNS; i++)
+  {
+    sim_ap_set_up(ap, false);
+    // Down for a while after the station noticed
+    sim_sleep_ms(beacon_timeout_ms + 2000 * (i + 1));
+    CHECK(sim_connected_ap() < 0);
+
+    sim_ap_set_up(ap, true);
+    int64_t start = sim_now_us();
+    CHECK(test_wait_got_ip(120000));
+    bench_sample(&flap, test_elapsed_ms(start));
+  }
+  test_disconnect();
+  bench_print(&flap);
+}
+
+/**
+ * @brief State of a benchmark scan.
+ */
+typedef struct
+{
+  SemaphoreHandle_t done; /**< Given on completion. */
+  uint16_t records;       /**< Records reported. */
+  esp_err_t status;       /**< Completion status. */
+} bench_scan_t;
+
+/**
+ * @brief Count a scan record.
+ *
+ * @param record The record.
+ * @param arg The scan state.
+ */
+static void bench_scan_record(const wifi_ap_record_t *record, void *arg)
+{
+  bench_scan_t *scan = arg;
+  scan->records++;
+}
+
+/**
+ * @brief Complete a scan.
+ *
+ * @param ap_count Records reported.
+ * @param status The status.
+ * @param arg The scan state.
+ */
+static void bench_scan_done(uint16_t ap_count, esp_err_t status, void *arg)
+{
+  bench_scan_t *scan = arg;
+  scan->status = status;
+  xSemaphoreGive(scan->done);
+}
+
+/**
+ * @brief Full and single channel scans of 50 APs, then a connection among
+ * them.
+ */
+static void bench_dense(void *arg)
+{
+  char ssids[50][12];
+  for (int i = 0; i < 50; i++)
+  {
+    snprintf(ssids[i], sizeof(ssids[i]), "net%02d", i);
+    test_ap(ssids[i], i + 1, 1 + i % SIM_CHANNELS, -40 - i);
+  }
+  int home = test_ap("home", 0x80, 11, -60);
+
+  CHECK_OK(wifi_api_start());
+  bench_scan_t scan = {.done = xSemaphoreCreateBinary()};
+  bench_result_t full = {.name = "scan, 51 APs, all channels"};
+  bench_result_t single = {.name = "scan, 51 APs, one channel"};
+  uint8_t channel = 11;
+  for (int i = 0; i < BENCH_RUNS; i++)
+  {
+    wifi_api_scan_config_t config = WIFI_API_SCAN_CONFIG_DEFAULT();
+    scan.records = 0;
+    int64_t start = sim_now_us();
+    CHECK_OK(wifi_api_scan_start(&config, &bench_scan_record, &bench_scan_done,
+                                 &scan));
+    xSemaphoreTake(scan.done, portMAX_DELAY);
+    bench_sample(&full, test_elapsed_ms(start));
+    CHECK(scan.status == ESP_OK && scan.records == 51);
+
+    config.channels = &channel;
+    config.channel_count = 1;
+    scan.records = 0;
+    start = sim_now_us();
+    CHECK_OK(wifi_api_scan_start(&config, &bench_scan_record, &bench_scan_done,
+                                 &scan));
+    xSemaphoreTake(scan.done, portMAX_DELAY);
+    bench_sample(&single, test_elapsed_ms(start));
+    CHECK(scan.status == ESP_OK && scan.records == 5);
+  }
+  vSemaphoreDelete(scan.done);
+
+  bench_result_t connect = {.name = "connect, 51 APs, cold"};
+  int64_t start = sim_now_us();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  bench_sample(&connect, test_elapsed_ms(start));
+  CHECK(sim_connected_ap() == home);
+  test_disconnect();
+  CHECK_OK(wifi_api_stop());
+
+  bench_print(&full);
+  bench_print(&single);
+  bench_print(&connect);
+}
+
+/**
+ * @brief Failures: a wrong password, and a profile whose AP rejects the
+ * authentication while another profile is in range.
+ */
+static void bench_auth_failure(void *arg)
+{
+  int office = test_ap("office", 1, 1, -40);
+  test_ap("home", 2, 6, -60);
+  wifi_api_retry_config_t retry = {
+    .base_delay_ms = 250, .max_delay_ms = 2000, .max_retry = 5};
+  CHECK_OK(wifi_api_set_retry_config(&retry));
+
+  bench_result_t wrong = {.name = "fail, wrong password"};
+  for (int i = 0; i < BENCH_RUNS; i++)
+  {
+    int64_t start = sim_now_us();
+    CHECK(wifi_api_configure("home", "wrong") == ESP_FAIL);
+    bench_sample(&wrong, test_elapsed_ms(start));
+    test_disconnect();
+  }
+
+  sim_ap_set_reject(office, WIFI_REASON_AUTH_FAIL);
+  wifi_api_profile_t profiles[] = {
+    {.ssid = "office", .password = "password", .priority = 2},
+    {.ssid = "home", .password = "password", .priority = 1},
+  };
+  for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++)
+    CHECK_OK(wifi_api_add_profile(&profiles[i]));
+
+  bench_result_t sw = {.name = "connect, switch profile"};
+  for (int i = 0; i < BENCH_RUNS; i++)
+  {
+    int64_t start = sim_now_us();
+    CHECK_OK(wifi_api_configure_profiles(0));
+    bench_sample(&sw, test_elapsed_ms(start));
+    CHECK(sim_connected_ap() != office);
+    test_disconnect();
+  }
+  wifi_api_remove_profile("office");
+  wifi_api_remove_profile("home");
+  wifi_api_retry_config_t defaults = WIFI_API_RETRY_CONFIG_DEFAULT();
+  wifi_api_set_retry_config(&defaults);
+
+  bench_print(&wrong);
+  bench_print(&sw);
+}
+
+int main()
+{
+  printf("  %-32s %4s %10s %10s %10s\n", "scenario (virtual ms)", "runs",
+         "min", "avg", "max");
+  test_run("connect", &bench_connect);
+  test_run("ap_flap", &bench_ap_flap);
+  test_run("dense", &bench_dense);
+  test_run("auth_failure", &bench_auth_failure);
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file sim.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Simulated Wi-Fi environment of the host build
+ *
+ * The FreeRTOS tasks are coroutines scheduled one at a time on a virtual
+ * clock, which only advances when every task is blocked, so a run is
+ * deterministic and takes no real time. The access points, the driver
+ * timing, the DHCP server and the gateway are scripted through this API.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <esp_log.h>
+#include <esp_wifi_types.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of simulated access points.
+ */
+#define SIM_MAX_APS 64
+
+/**
+ * @brief Number of 2.4 GHz channels the driver scans.
+ */
+#define SIM_CHANNELS 13
+
+/**
+ * @brief A simulated access point.
+ */
+typedef struct
+{
+  const char *ssid;          /**< SSID, copied. */
+  uint8_t bssid[6];          /**< MAC address. */
+  uint8_t channel;           /**< Primary channel, 1 to `SIM_CHANNELS`. */
+  int8_t rssi;               /**< Signal strength seen by the station. */
+  wifi_auth_mode_t authmode; /**< Authentication mode. */
+  const char *password;      /**< Password, copied, ignored when open. */
+  uint8_t subnet;            /**< Third octet of 192.168.x.0/24, 0 for 1. */
+  bool rrm;                  /**< Answers 802.11k neighbor report requests. */
+  uint8_t reject_reason;     /**< Reason every association fails with. */
+} sim_ap_t;
+
+/**
+ * @brief Timing of the simulated driver, DHCP server and gateway.
+ */
+typedef struct
+{
+  uint32_t start_ms;          /**< `esp_wifi_start` to `STA_START`. */
+  uint32_t active_dwell_ms;   /**< Active dwell per channel by default. */
+  uint32_t passive_dwell_ms;  /**< Passive dwell per channel by default. */
+  uint32_t auth_ms;           /**< Authentication and association. */
+  uint32_t handshake_ms;      /**< 4-way handshake. */
+  uint32_t fail_ms;           /**< Handshake timeout of a wrong password. */
+  uint32_t ft_ms;             /**< Fast transition reassociation. */
+  uint32_t dhcp_ms;           /**< DHCP exchange. */
+  uint32_t lease_s;           /**< DHCP lease time. */
+  uint32_t beacon_timeout_ms; /**< Beacon loss before disconnecting. */
+  uint32_t neighbor_ms;       /**< Neighbor report round trip. */
+  uint32_t ping_ms;           /**< Gateway round trip. */
+} sim_timing_t;
+
+/**
+ * @brief Default timing, close to an ESP32 on a quiet home network.
+ */
+#define SIM_TIMING_DEFAULT()                                                   \
+  {                                                                            \
+    .start_ms = 60, .active_dwell_ms = 120, .passive_dwell_ms = 360,           \
+    .auth_ms = 40, .handshake_ms = 30, .fail_ms = 1000, .ft_ms = 15,           \
+    .dhcp_ms = 500, .lease_s = 86400, .beacon_timeout_ms = 6000,               \
+    .neighbor_ms = 20, .ping_ms = 3,                                           \
+  }
+
+/**
+ * @brief Counters of the simulated driver.
+ */
+typedef struct
+{
+  uint32_t scans;             /**< Scans started by `esp_wifi_scan_start`. */
+  uint32_t scanned_channels;  /**< Channels dwelt on, scans and connects. */
+  uint32_t connects;          /**< Calls to `esp_wifi_connect`. */
+  uint32_t associations;      /**< Successful associations. */
+  uint32_t dhcp_exchanges;    /**< Completed DHCP exchanges. */
+  uint32_t neighbor_requests; /**< Neighbor report requests. */
+  uint32_t nvs_writes;        /**< Blobs written to NVS. */
+} sim_stats_t;
+
+/**
+ * @brief Run a function as the main task of the simulation.
+ *
+ * The scheduler runs every task until `fn` returns. The tasks created by a
+ * previous run keep running in the next one, and the clock keeps its value.
+ *
+ * @param fn The main function.
+ * @param arg Argument of `fn`.
+ */
+void sim_run(void (*fn)(void *), void *arg);
+
+/**
+ * @brief Remove every access point, restore the default timing and reseed
+ * `esp_random`. NVS and the state of the tasks are kept.
+ *
+ * @param seed The seed of `esp_random`.
+ */
+void sim_reset(uint32_t seed);
+
+/**
+ * @brief Replace the timing.
+ *
+ * @param timing The new timing.
+ */
+void sim_set_timing(const sim_timing_t *timing);
+
+/**
+ * @brief Get the current timing.
+ *
+ * @return The timing.
+ */
+sim_timing_t sim_get_timing(void);
+
+/**
+ * @brief Add an access point, up.
+ *
+ * @param ap The access point.
+ * @return Its index, -1 if `SIM_MAX_APS` are defined.
+ */
+int sim_ap_add(const sim_ap_t *ap);
+
+/**
+ * @brief Switch an access point on or off. The station connected to an AP
+ * switched off loses it after `beacon_timeout_ms`.
+ *
+ * @param ap The index of the access point.
+ * @param up Whether the AP is on.
+ */
+void sim_ap_set_up(int ap, bool up);
+
+/**
+ * @brief Change the RSSI of an access point. `WIFI_EVENT_STA_BSS_RSSI_LOW`
+ * is posted when the RSSI of the connected AP crosses the armed threshold.
+ *
+ * @param ap The index of the access point.
+ * @param rssi The new RSSI.
+ */
+void sim_ap_set_rssi(int ap, int8_t rssi);
+
+/**
+ * @brief Change the reason the associations with an access point fail with.
+ *
+ * @param ap The index of the access point.
+ * @param reason The disconnect reason, 0 to accept associations.
+ */
+void sim_ap_set_reject(int ap, uint8_t reason);
+
+/**
+ * @brief Make the supplicant roam to another access point by itself, as
+ * after a BSS transition request: `WIFI_REASON_ROAMING` is reported, then
+ * the station joins `ap` after `ft_ms`.
+ *
+ * @param ap The index of the target access point.
+ * @return true if the station was connected.
+ */
+bool sim_supplicant_roam(int ap);
+
+/**
+ * @brief Get the access point the station is connected to.
+ *
+ * @return Its index, -1 when disconnected.
+ */
+int sim_connected_ap(void);
+
+/**
+ * @brief Get the counters of the simulated driver.
+ *
+ * @return The counters since the last `sim_reset_stats`.
+ */
+sim_stats_t sim_stats(void);
+
+/**
+ * @brief Clear the counters.
+ */
+void sim_reset_stats(void);
+
+/**
+ * @brief Erase the whole NVS.
+ */
+void sim_nvs_erase(void);
+
+/**
+ * @brief Set the level of the logs written to stderr, `ESP_LOG_WARN` by
+ * default or the value of the `SIM_LOG` environment variable.
+ *
+ * @param level The most verbose level written.
+ */
+void sim_log_level(esp_log_level_t level);
+
+/**
+ * @brief Block the calling task for a virtual time.
+ *
+ * @param ms The time in milliseconds.
+ */
+void sim_sleep_ms(uint32_t ms);
+
+/**
+ * @brief Get the virtual time.
+ *
+ * @return Microseconds since the start of the simulation.
+ */
+int64_t sim_now_us(void);
+
+#endif /* SIM_H */
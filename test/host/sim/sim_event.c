@@ -0,0 +1,256 @@
+/**
+ * @file sim_event.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Default event loop, its handlers run on a simulated task in the
+ * order they were registered
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "sim_priv.h"
+
+#include <esp_event.h>
+#include <esp_wifi.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+ESP_EVENT_DEFINE_BASE(WIFI_EVENT);
+ESP_EVENT_DEFINE_BASE(IP_EVENT);
+
+/**
+ * @brief Length of the queue of the default loop.
+ */
+#define SIM_EVENT_QUEUE_LENGTH 32
+
+/**
+ * @brief A registered handler.
+ */
+struct sim_event_handler
+{
+  esp_event_base_t base;           /**< Event base. */
+  int32_t id;                      /**< Event id, or `ESP_EVENT_ANY_ID`. */
+  esp_event_handler_t handler;     /**< Handler. */
+  void *arg;                       /**< Argument of the handler. */
+  bool removed;                    /**< Unregistered during a dispatch. */
+  struct sim_event_handler *next;  /**< Next handler. */
+};
+
+/**
+ * @brief A posted event.
+ */
+typedef struct
+{
+  esp_event_base_t base; /**< Event base. */
+  int32_t id;            /**< Event id. */
+  void *data;            /**< Copy of the event data. */
+} sim_event_t;
+
+/**
+ * @brief Queue of the default loop, NULL when it does not exist.
+ */
+static QueueHandle_t s_queue = NULL;
+
+/**
+ * @brief Handlers, in registration order.
+ */
+static struct sim_event_handler *s_handlers = NULL;
+
+/**
+ * @brief Number of dispatches running, the removed handlers are freed
+ * after.
+ */
+static int s_dispatching = 0;
+
+/**
+ * @brief Free the handlers unregistered during a dispatch.
+ */
+static void handlers_collect()
+{
+  for (struct sim_event_handler **link = &s_handlers; *link;)
+  {
+    struct sim_event_handler *entry = *link;
+    if (entry->removed)
+    {
+      *link = entry->next;
+      free(entry);
+    }
+    else
+      link = &entry->next;
+  }
+}
+
+/**
+ * @brief Task of the default loop.
+ *
+ * @param arg The queue.
+ */
+static void event_task(void *arg)
+{
+  QueueHandle_t queue = arg;
+  sim_event_t event;
+  while (xQueueReceive(queue, &event, portMAX_DELAY) == pdTRUE)
+  {
+    s_dispatching++;
+    for (struct sim_event_handler *entry = s_handlers; entry;
+         entry = entry->next)
+    {
+      if (entry->removed || entry->base != event.base)
+        continue;
+      if (entry->id != ESP_EVENT_ANY_ID && entry->id != event.id)
+        continue;
+      entry->handler(entry->arg, event.base, event.id, event.data);
+    }
+    s_dispatching--;
+    if (s_dispatching == 0)
+      handlers_collect();
+    free(event.data);
+  }
+}
+
+esp_err_t esp_event_loop_create_default()
+{
+  if (s_queue)
+    return ESP_ERR_INVALID_STATE;
+  s_queue = xQueueCreate(SIM_EVENT_QUEUE_LENGTH, sizeof(sim_event_t));
+  if (!s_queue)
+    return ESP_ERR_NO_MEM;
+  if (xTaskCreate(event_task, "sys_evt", 0, s_queue, 20, NULL) != pdPASS)
+  {
+    vQueueDelete(s_queue);
+    s_queue = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_event_loop_delete_default()
+{
+  // The task keeps its queue, as the loop is never deleted while running
+  if (!s_queue)
+    return ESP_ERR_INVALID_STATE;
+  s_queue = NULL;
+  return ESP_OK;
+}
+
+esp_err_t esp_event_handler_instance_register(
+  esp_event_base_t event_base, int32_t event_id,
+  esp_event_handler_t event_handler, void *event_handler_arg,
+  esp_event_handler_instance_t *instance)
+{
+  if (!s_queue)
+    return ESP_ERR_INVALID_STATE;
+  if (!event_base || !event_handler)
+    return ESP_ERR_INVALID_ARG;
+
+  struct sim_event_handler *entry = calloc(1, sizeof(*entry));
+  if (!entry)
+    return ESP_ERR_NO_MEM;
+  entry->base = event_base;
+  entry->id = event_id;
+  entry->handler = event_handler;
+  entry->arg = event_handler_arg;
+
+  struct sim_event_handler **link = &s_handlers;
+  while (*link)
+    link = &(*link)->next;
+  *link = entry;
+  if (instance)
+    *instance = entry;
+  return ESP_OK;
+}
+
+/**
+ * @brief Remove a handler, or mark it during a dispatch.
+ *
+ * @param entry The handler.
+ */
+static void handler_remove(struct sim_event_handler *entry)
+{
+  entry->removed = true;
+  if (s_dispatching == 0)
+    handlers_collect();
+}
+
+esp_err_t esp_event_handler_instance_unregister(
+  esp_event_base_t event_base, int32_t event_id,
+  esp_event_handler_instance_t instance)
+{
+  for (struct sim_event_handler *entry = s_handlers; entry;
+       entry = entry->next)
+  {
+    if (entry == instance && !entry->removed)
+    {
+      handler_remove(entry);
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_event_handler_register(esp_event_base_t event_base,
+                                     int32_t event_id,
+                                     esp_event_handler_t event_handler,
+                                     void *event_handler_arg)
+{
+  // As in the SDK, registering a handler again only updates its argument
+  for (struct sim_event_handler *entry = s_handlers; entry;
+       entry = entry->next)
+  {
+    if (!entry->removed && entry->base == event_base &&
+        entry->id == event_id && entry->handler == event_handler)
+    {
+      entry->arg = event_handler_arg;
+      return ESP_OK;
+    }
+  }
+  return esp_event_handler_instance_register(
+    event_base, event_id, event_handler, event_handler_arg, NULL);
+}
+
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base,
+                                       int32_t event_id,
+                                       esp_event_handler_t event_handler)
+{
+  for (struct sim_event_handler *entry = s_handlers; entry;
+       entry = entry->next)
+  {
+    if (!entry->removed && entry->base == event_base &&
+        entry->id == event_id && entry->handler == event_handler)
+    {
+      handler_remove(entry);
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id,
+                         const void *event_data, size_t event_data_size,
+                         TickType_t ticks_to_wait)
+{
+  if (!s_queue)
+    return ESP_ERR_INVALID_STATE;
+
+  sim_event_t event = {.base = event_base, .id = event_id};
+  if (event_data && event_data_size > 0)
+  {
+    event.data = malloc(event_data_size);
+    if (!event.data)
+      return ESP_ERR_NO_MEM;
+    memcpy(event.data, event_data, event_data_size);
+  }
+  if (xQueueSend(s_queue, &event, ticks_to_wait) != pdTRUE)
+  {
+    free(event.data);
+    return ESP_ERR_TIMEOUT;
+  }
+  return ESP_OK;
+}
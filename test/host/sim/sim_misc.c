@@ -0,0 +1,158 @@
+/**
+ * @file sim_misc.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Logging, random numbers, error names and the counters of the
+ * simulator
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "sim_priv.h"
+
+#include <esp_random.h>
+#include <esp_system.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Most verbose level logged, -1 until read from `SIM_LOG`.
+ */
+static int s_log_level = -1;
+
+/**
+ * @brief State of `esp_random`.
+ */
+static uint32_t s_random = 1;
+
+/**
+ * @brief Counters.
+ */
+static sim_stats_t s_stats;
+
+void sim_log_level(esp_log_level_t level)
+{
+  s_log_level = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format,
+                   ...)
+{
+  if (s_log_level < 0)
+  {
+    const char *env = getenv("SIM_LOG");
+    s_log_level = env ? atoi(env) : ESP_LOG_WARN;
+  }
+  if ((int)level > s_log_level)
+    return;
+
+  static const char letters[] = "NEWIDV";
+  fprintf(stderr, "%c (%10.3f) %s: ", letters[level], sim_now_us() / 1e6,
+          tag);
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+void sim_random_seed(uint32_t seed)
+{
+  s_random = seed ? seed : 1;
+}
+
+uint32_t esp_random()
+{
+  // xorshift32, reproducible for a given seed
+  s_random ^= s_random << 13;
+  s_random ^= s_random >> 17;
+  s_random ^= s_random << 5;
+  return s_random;
+}
+
+sim_stats_t *sim_stats_ref()
+{
+  return &s_stats;
+}
+
+sim_stats_t sim_stats()
+{
+  return s_stats;
+}
+
+void sim_reset_stats()
+{
+  memset(&s_stats, 0, sizeof(s_stats));
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+  switch (code)
+  {
+    case ESP_OK:
+      return "ESP_OK";
+    case ESP_FAIL:
+      return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+      return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+      return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+      return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+      return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+      return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+      return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_NVS_NOT_FOUND:
+      return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_WIFI_NOT_INIT:
+      return "ESP_ERR_WIFI_NOT_INIT";
+    case ESP_ERR_WIFI_NOT_STARTED:
+      return "ESP_ERR_WIFI_NOT_STARTED";
+    case ESP_ERR_WIFI_STATE:
+      return "ESP_ERR_WIFI_STATE";
+    case ESP_ERR_WIFI_NOT_CONNECT:
+      return "ESP_ERR_WIFI_NOT_CONNECT";
+    case ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED:
+      return "ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED";
+    case ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED:
+      return "ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED";
+    case ESP_ERR_ESP_NETIF_DHCP_NOT_STOPPED:
+      return "ESP_ERR_ESP_NETIF_DHCP_NOT_STOPPED";
+    default:
+      return "UNKNOWN ERROR";
+  }
+}
+
+size_t strlcpy(char *dst, const char *src, size_t size)
+{
+  size_t length = strlen(src);
+  if (size > 0)
+  {
+    size_t copied = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, copied);
+    dst[copied] = '\0';
+  }
+  return length;
+}
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle)
+{
+  return ESP_OK;
+}
+
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handle)
+{
+  return ESP_OK;
+}
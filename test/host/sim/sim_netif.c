@@ -0,0 +1,559 @@
+/**
+ * @file sim_netif.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Simulated station interface, its DHCP client and the ping sessions
+ *
+ * The interface follows the state machine of esp_netif: the DHCP client
+ * starts on association unless stopped, a static address is announced on
+ * association, and the address is dropped with the association while DHCP
+ * runs. The DHCP server and the gateway of each access point answer after
+ * the simulated timing.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "sim_priv.h"
+
+#include <esp_netif_net_stack.h>
+#include <esp_wifi.h>
+#include <lwip/dhcp.h>
+#include <ping/ping_sock.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Host part of the address offered by every DHCP server.
+ */
+#define SIM_DHCP_HOST 100
+
+/**
+ * @brief The station interface.
+ */
+struct esp_netif_obj
+{
+  const char *if_key;                                /**< Key. */
+  bool up;                                           /**< Associated. */
+  esp_netif_dhcp_status_t dhcpc_status;              /**< DHCP client. */
+  esp_netif_ip_info_t ip_info;                       /**< Address. */
+  esp_netif_ip_info_t ip_info_old;                   /**< Last announced. */
+  esp_netif_dns_info_t dns[ESP_NETIF_DNS_MAX];       /**< DNS servers. */
+  struct netif lwip;                                 /**< lwIP interface. */
+  struct dhcp dhcp;                                  /**< lwIP DHCP client. */
+};
+
+/**
+ * @brief A ping session.
+ */
+typedef struct sim_ping
+{
+  esp_ping_config_t config;    /**< Configuration. */
+  esp_ping_callbacks_t cbs;    /**< Callbacks. */
+  esp_timer_handle_t timer;    /**< Next step. */
+  uint32_t requests;           /**< Requests sent. */
+  uint32_t replies;            /**< Replies received. */
+  uint32_t timegap_ms;         /**< Round trip of the last reply. */
+  int64_t start_us;            /**< Start of the session. */
+  uint32_t duration_ms;        /**< Duration of the session. */
+  struct sim_ping *next;       /**< Next session. */
+} sim_ping_t;
+
+/**
+ * @brief The station interface, NULL until created.
+ */
+static esp_netif_t *s_netif = NULL;
+
+/**
+ * @brief Timer of the DHCP exchange.
+ */
+static esp_timer_handle_t s_dhcp_timer = NULL;
+
+/**
+ * @brief Ping sessions.
+ */
+static sim_ping_t *s_pings = NULL;
+
+/**
+ * @brief Default receive function of the lwIP interface.
+ *
+ * @param p The packet.
+ * @param inp The interface.
+ * @return ERR_OK.
+ */
+static err_t netif_input(struct pbuf *p, struct netif *inp)
+{
+  return ERR_OK;
+}
+
+/**
+ * @brief Default transmit function of the lwIP interface.
+ *
+ * @param netif The interface.
+ * @param p The packet.
+ * @return ERR_OK.
+ */
+static err_t netif_linkoutput(struct netif *netif, struct pbuf *p)
+{
+  return ERR_OK;
+}
+
+/**
+ * @brief Post `IP_EVENT_STA_GOT_IP` with the current address.
+ *
+ * @param netif The interface.
+ */
+static void netif_got_ip(esp_netif_t *netif)
+{
+  ip_event_got_ip_t event = {.esp_netif = netif, .ip_info = netif->ip_info};
+  event.ip_changed =
+    memcmp(&netif->ip_info, &netif->ip_info_old, sizeof(netif->ip_info)) != 0;
+  netif->ip_info_old = netif->ip_info;
+  esp_event_post(IP_EVENT, IP_EVENT_STA_GOT_IP, &event, sizeof(event),
+                 portMAX_DELAY);
+}
+
+/**
+ * @brief Complete the DHCP exchange with the server of the joined AP.
+ *
+ * @param arg The interface.
+ */
+static void dhcp_bound(void *arg)
+{
+  esp_netif_t *netif = arg;
+  if (netif->dhcpc_status != ESP_NETIF_DHCP_STARTED || !netif->up)
+    return;
+
+  int subnet = sim_wifi_subnet();
+  if (subnet < 0)
+  {
+    // Discovery is retried until the association completes
+    sim_after(&s_dhcp_timer, &dhcp_bound, netif, sim_get_timing().dhcp_ms);
+    return;
+  }
+
+  netif->ip_info.ip.addr = ESP_IP4TOADDR(192, 168, subnet, SIM_DHCP_HOST);
+  netif->ip_info.gw.addr = ESP_IP4TOADDR(192, 168, subnet, 1);
+  netif->ip_info.netmask.addr = ESP_IP4TOADDR(255, 255, 255, 0);
+  netif->dns[ESP_NETIF_DNS_MAIN].ip.u_addr.ip4 = netif->ip_info.gw;
+  netif->dns[ESP_NETIF_DNS_MAIN].ip.type = ESP_IPADDR_TYPE_V4;
+  netif->dhcp.offered_t0_lease = sim_get_timing().lease_s;
+  sim_stats_ref()->dhcp_exchanges++;
+  netif_got_ip(netif);
+}
+
+/**
+ * @brief Start the DHCP exchange.
+ *
+ * @param netif The interface.
+ */
+static void dhcp_begin(esp_netif_t *netif)
+{
+  netif->dhcpc_status = ESP_NETIF_DHCP_STARTED;
+  netif->lwip.dhcp = &netif->dhcp;
+  sim_after(&s_dhcp_timer, &dhcp_bound, netif, sim_get_timing().dhcp_ms);
+}
+
+/**
+ * @brief Stop a running DHCP client and drop its address, as on
+ * disassociation.
+ *
+ * @param netif The interface.
+ */
+static void dhcp_drop(esp_netif_t *netif)
+{
+  if (netif->dhcpc_status != ESP_NETIF_DHCP_STARTED)
+    return;
+  sim_cancel(s_dhcp_timer);
+  netif->dhcpc_status = ESP_NETIF_DHCP_INIT;
+  memset(&netif->ip_info, 0, sizeof(netif->ip_info));
+}
+
+/**
+ * @brief Default handler of the station events, drives the interface as
+ * the handlers of esp_wifi do.
+ *
+ * @param arg The interface.
+ * @param event_base Base ID of the event.
+ * @param event_id ID of the event.
+ * @param event_data Event-specific data.
+ */
+static void netif_wifi_handler(void *arg, esp_event_base_t event_base,
+                               int32_t event_id, void *event_data)
+{
+  esp_netif_t *netif = arg;
+  switch (event_id)
+  {
+    case WIFI_EVENT_STA_START:
+      netif->lwip.input = &netif_input;
+      netif->lwip.linkoutput = &netif_linkoutput;
+      break;
+    case WIFI_EVENT_STA_STOP:
+      netif->up = false;
+      dhcp_drop(netif);
+      break;
+    case WIFI_EVENT_STA_CONNECTED:
+      netif->up = true;
+      if (netif->dhcpc_status != ESP_NETIF_DHCP_STOPPED)
+        esp_netif_dhcpc_start(netif);
+      else if (netif->ip_info.ip.addr != 0)
+        netif_got_ip(netif);
+      break;
+    case WIFI_EVENT_STA_DISCONNECTED:
+      netif->up = false;
+      dhcp_drop(netif);
+      break;
+    default:
+      break;
+  }
+}
+
+void sim_netif_reset()
+{
+  sim_cancel(s_dhcp_timer);
+  for (sim_ping_t *ping = s_pings; ping; ping = ping->next)
+    sim_cancel(ping->timer);
+}
+
+esp_err_t esp_netif_init()
+{
+  return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_wifi(wifi_interface_t wifi_if,
+                                   const esp_netif_inherent_config_t *config)
+{
+  if (s_netif || wifi_if != WIFI_IF_STA)
+    return NULL;
+  esp_netif_t *netif = calloc(1, sizeof(*netif));
+  if (!netif)
+    return NULL;
+  netif->if_key = config->if_key;
+  netif->dhcpc_status = ESP_NETIF_DHCP_INIT;
+  netif->lwip.input = &netif_input;
+  netif->lwip.linkoutput = &netif_linkoutput;
+  s_netif = netif;
+  return netif;
+}
+
+void esp_netif_destroy(esp_netif_t *esp_netif)
+{
+  if (!esp_netif)
+    return;
+  sim_cancel(s_dhcp_timer);
+  if (esp_netif == s_netif)
+    s_netif = NULL;
+  free(esp_netif);
+}
+
+esp_err_t esp_wifi_set_default_wifi_sta_handlers()
+{
+  if (!s_netif)
+    return ESP_ERR_INVALID_STATE;
+  return esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
+                                    &netif_wifi_handler, s_netif);
+}
+
+esp_err_t esp_wifi_clear_default_wifi_driver_and_handlers(void *esp_netif)
+{
+  return esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID,
+                                      &netif_wifi_handler);
+}
+
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key)
+{
+  if (s_netif && if_key && strcmp(s_netif->if_key, if_key) == 0)
+    return s_netif;
+  return NULL;
+}
+
+esp_err_t esp_netif_dhcpc_start(esp_netif_t *esp_netif)
+{
+  if (!esp_netif)
+    return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+  if (esp_netif->dhcpc_status == ESP_NETIF_DHCP_STARTED)
+    return ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED;
+
+  memset(&esp_netif->ip_info, 0, sizeof(esp_netif->ip_info));
+  if (esp_netif->up)
+    dhcp_begin(esp_netif);
+  else
+    esp_netif->dhcpc_status = ESP_NETIF_DHCP_INIT;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t *esp_netif)
+{
+  if (!esp_netif)
+    return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+  if (esp_netif->dhcpc_status == ESP_NETIF_DHCP_STOPPED)
+    return ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED;
+
+  sim_cancel(s_dhcp_timer);
+  memset(&esp_netif->ip_info, 0, sizeof(esp_netif->ip_info));
+  esp_netif->dhcpc_status = ESP_NETIF_DHCP_STOPPED;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_dhcpc_get_status(esp_netif_t *esp_netif,
+                                     esp_netif_dhcp_status_t *status)
+{
+  if (!esp_netif || !status)
+    return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+  *status = esp_netif->dhcpc_status;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif,
+                                esp_netif_ip_info_t *ip_info)
+{
+  if (!esp_netif || !ip_info)
+    return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+  *ip_info = esp_netif->ip_info;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_set_ip_info(esp_netif_t *esp_netif,
+                                const esp_netif_ip_info_t *ip_info)
+{
+  if (!esp_netif || !ip_info)
+    return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+  if (esp_netif->dhcpc_status != ESP_NETIF_DHCP_STOPPED)
+    return ESP_ERR_ESP_NETIF_DHCP_NOT_STOPPED;
+
+  esp_netif->ip_info = *ip_info;
+  // As esp_netif does, an address set on a running interface is announced
+  if (esp_netif->up && ip_info->ip.addr != 0)
+    netif_got_ip(esp_netif);
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_get_dns_info(esp_netif_t *esp_netif,
+                                 esp_netif_dns_type_t type,
+                                 esp_netif_dns_info_t *dns)
+{
+  if (!esp_netif || !dns || type >= ESP_NETIF_DNS_MAX)
+    return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+  *dns = esp_netif->dns[type];
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_set_dns_info(esp_netif_t *esp_netif,
+                                 esp_netif_dns_type_t type,
+                                 esp_netif_dns_info_t *dns)
+{
+  if (!esp_netif || !dns || type >= ESP_NETIF_DNS_MAX)
+    return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+  esp_netif->dns[type] = *dns;
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_create_ip6_linklocal(esp_netif_t *esp_netif)
+{
+  return ESP_OK;
+}
+
+int esp_netif_get_netif_impl_index(esp_netif_t *esp_netif)
+{
+  return esp_netif ? esp_netif->lwip.num + 1 : -1;
+}
+
+void *esp_netif_get_netif_impl(esp_netif_t *esp_netif)
+{
+  return esp_netif ? &esp_netif->lwip : NULL;
+}
+
+esp_err_t esp_netif_str_to_ip4(const char *src, esp_ip4_addr_t *dst)
+{
+  unsigned a, b, c, d;
+  char end;
+  if (!src || !dst ||
+      sscanf(src, "%u.%u.%u.%u%c", &a, &b, &c, &d, &end) != 4 || a > 255 ||
+      b > 255 || c > 255 || d > 255)
+    return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+  dst->addr = ESP_IP4TOADDR(a, b, c, d);
+  return ESP_OK;
+}
+
+esp_err_t esp_netif_tcpip_exec(esp_netif_callback_fn fn, void *ctx)
+{
+  return fn(ctx);
+}
+
+/**
+ * @brief Whether the gateway of the joined AP answers a request.
+ *
+ * @param target The target address.
+ * @return true if the station has an address on its network and the target
+ * is its gateway.
+ */
+static bool ping_reachable(uint32_t target)
+{
+  int subnet = sim_wifi_subnet();
+  if (subnet < 0 || !s_netif || !s_netif->up)
+    return false;
+  uint32_t network = ESP_IP4TOADDR(192, 168, subnet, 0);
+  uint32_t mask = ESP_IP4TOADDR(255, 255, 255, 0);
+  return (s_netif->ip_info.ip.addr & mask) == network &&
+         s_netif->ip_info.ip.addr != network &&
+         target == ESP_IP4TOADDR(192, 168, subnet, 1);
+}
+
+/**
+ * @brief Send the next request of a session, or end it.
+ *
+ * @param arg The session.
+ */
+static void ping_send(void *arg);
+
+/**
+ * @brief Wait the interval before the next request, or end the session.
+ *
+ * @param ping The session.
+ */
+static void ping_next(sim_ping_t *ping)
+{
+  if (ping->requests < ping->config.count)
+  {
+    sim_after(&ping->timer, &ping_send, ping, ping->config.interval_ms);
+    return;
+  }
+  ping->duration_ms = (sim_now_us() - ping->start_us) / 1000;
+  // The callback may delete the session
+  if (ping->cbs.on_ping_end)
+    ping->cbs.on_ping_end(ping, ping->cbs.cb_args);
+}
+
+/**
+ * @brief Receive the reply of the last request.
+ *
+ * @param arg The session.
+ */
+static void ping_reply(void *arg)
+{
+  sim_ping_t *ping = arg;
+  ping->replies++;
+  ping->timegap_ms = sim_get_timing().ping_ms;
+  if (ping->cbs.on_ping_success)
+    ping->cbs.on_ping_success(ping, ping->cbs.cb_args);
+  ping_next(ping);
+}
+
+/**
+ * @brief Give up on the reply of the last request.
+ *
+ * @param arg The session.
+ */
+static void ping_timeout(void *arg)
+{
+  sim_ping_t *ping = arg;
+  if (ping->cbs.on_ping_timeout)
+    ping->cbs.on_ping_timeout(ping, ping->cbs.cb_args);
+  ping_next(ping);
+}
+
+static void ping_send(void *arg)
+{
+  sim_ping_t *ping = arg;
+  ping->requests++;
+  uint32_t rtt = sim_get_timing().ping_ms;
+  if (ping_reachable(ping->config.target_addr.u_addr.ip4.addr) &&
+      rtt < ping->config.timeout_ms)
+    sim_after(&ping->timer, &ping_reply, ping, rtt);
+  else
+    sim_after(&ping->timer, &ping_timeout, ping, ping->config.timeout_ms);
+}
+
+esp_err_t esp_ping_new_session(const esp_ping_config_t *config,
+                               const esp_ping_callbacks_t *cbs,
+                               esp_ping_handle_t *hdl_out)
+{
+  if (!config || !cbs || !hdl_out || config->count == 0)
+    return ESP_ERR_INVALID_ARG;
+  sim_ping_t *ping = calloc(1, sizeof(*ping));
+  if (!ping)
+    return ESP_ERR_NO_MEM;
+  ping->config = *config;
+  ping->cbs = *cbs;
+  ping->next = s_pings;
+  s_pings = ping;
+  *hdl_out = ping;
+  return ESP_OK;
+}
+
+esp_err_t esp_ping_delete_session(esp_ping_handle_t hdl)
+{
+  if (!hdl)
+    return ESP_ERR_INVALID_ARG;
+  for (sim_ping_t **link = &s_pings; *link; link = &(*link)->next)
+  {
+    if (*link == hdl)
+    {
+      *link = (*link)->next;
+      break;
+    }
+  }
+  sim_ping_t *ping = hdl;
+  if (ping->timer)
+  {
+    esp_timer_stop(ping->timer);
+    esp_timer_delete(ping->timer);
+  }
+  free(ping);
+  return ESP_OK;
+}
+
+esp_err_t esp_ping_start(esp_ping_handle_t hdl)
+{
+  sim_ping_t *ping = hdl;
+  if (!ping)
+    return ESP_ERR_INVALID_ARG;
+  ping->requests = ping->replies = 0;
+  ping->start_us = sim_now_us();
+  sim_after(&ping->timer, &ping_send, ping, 0);
+  return ESP_OK;
+}
+
+esp_err_t esp_ping_stop(esp_ping_handle_t hdl)
+{
+  sim_ping_t *ping = hdl;
+  if (!ping)
+    return ESP_ERR_INVALID_ARG;
+  sim_cancel(ping->timer);
+  return ESP_OK;
+}
+
+esp_err_t esp_ping_get_profile(esp_ping_handle_t hdl,
+                               esp_ping_profile_t profile, void *data,
+                               uint32_t size)
+{
+  sim_ping_t *ping = hdl;
+  uint32_t value;
+  switch (profile)
+  {
+    case ESP_PING_PROF_SEQNO:
+    case ESP_PING_PROF_REQUEST:
+      value = ping->requests;
+      break;
+    case ESP_PING_PROF_REPLY:
+      value = ping->replies;
+      break;
+    case ESP_PING_PROF_TIMEGAP:
+      value = ping->timegap_ms;
+      break;
+    case ESP_PING_PROF_DURATION:
+      value = ping->duration_ms;
+      break;
+    default:
+      return ESP_ERR_INVALID_ARG;
+  }
+  if (!data || size < sizeof(value))
+    return ESP_ERR_INVALID_SIZE;
+  memcpy(data, &value, sizeof(value));
+  return ESP_OK;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file sim_nvs.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief In-memory NVS, the blobs of every partition share one store and
+ * survive the deinitialization of the component
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "sim_priv.h"
+
+#include <nvs_flash.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Maximum number of open handles.
+ */
+#define SIM_NVS_HANDLES 16
+
+/**
+ * @brief Maximum length of a namespace name.
+ */
+#define SIM_NVS_NAME_SIZE 16
+
+/**
+ * @brief A stored blob.
+ */
+typedef struct sim_nvs_entry
+{
+  char ns[SIM_NVS_NAME_SIZE];        /**< Namespace. */
+  char key[NVS_KEY_NAME_MAX_SIZE];   /**< Key, empty for a namespace marker. */
+  void *value;                       /**< Blob. */
+  size_t length;                     /**< Length of the blob. */
+  struct sim_nvs_entry *next;        /**< Next entry. */
+} sim_nvs_entry_t;
+
+/**
+ * @brief An open handle.
+ */
+typedef struct
+{
+  bool used;                  /**< Whether the handle is open. */
+  bool writable;              /**< Opened read-write. */
+  char ns[SIM_NVS_NAME_SIZE]; /**< Namespace. */
+} sim_nvs_handle_t;
+
+/**
+ * @brief Stored blobs, and a marker per namespace created.
+ */
+static sim_nvs_entry_t *s_entries = NULL;
+
+/**
+ * @brief Handles, `nvs_handle_t` is the index plus one.
+ */
+static sim_nvs_handle_t s_handles[SIM_NVS_HANDLES];
+
+/**
+ * @brief Find an entry.
+ *
+ * @param ns The namespace.
+ * @param key The key, "" for the namespace marker.
+ * @return The link to the entry, to the end of the list if not found.
+ */
+static sim_nvs_entry_t **entry_find(const char *ns, const char *key)
+{
+  sim_nvs_entry_t **link = &s_entries;
+  while (*link &&
+         (strcmp((*link)->ns, ns) != 0 || strcmp((*link)->key, key) != 0))
+    link = &(*link)->next;
+  return link;
+}
+
+/**
+ * @brief Get an open handle.
+ *
+ * @param handle The handle.
+ * @return The handle, NULL if not open.
+ */
+static sim_nvs_handle_t *handle_get(nvs_handle_t handle)
+{
+  if (handle == 0 || handle > SIM_NVS_HANDLES || !s_handles[handle - 1].used)
+    return NULL;
+  return &s_handles[handle - 1];
+}
+
+void sim_nvs_erase()
+{
+  while (s_entries)
+  {
+    sim_nvs_entry_t *entry = s_entries;
+    s_entries = entry->next;
+    free(entry->value);
+    free(entry);
+  }
+}
+
+esp_err_t nvs_flash_init()
+{
+  return ESP_OK;
+}
+
+esp_err_t nvs_flash_init_partition(const char *partition_label)
+{
+  return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase()
+{
+  sim_nvs_erase();
+  return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode,
+                   nvs_handle_t *out_handle)
+{
+  return nvs_open_from_partition(NVS_DEFAULT_PART_NAME, namespace_name,
+                                 open_mode, out_handle);
+}
+
+esp_err_t nvs_open_from_partition(const char *part_name,
+                                  const char *namespace_name,
+                                  nvs_open_mode_t open_mode,
+                                  nvs_handle_t *out_handle)
+{
+  if (!namespace_name || strlen(namespace_name) >= SIM_NVS_NAME_SIZE ||
+      !out_handle)
+    return ESP_ERR_INVALID_ARG;
+
+  // A namespace only exists once opened for writing
+  sim_nvs_entry_t **marker = entry_find(namespace_name, "");
+  if (!*marker)
+  {
+    if (open_mode == NVS_READONLY)
+      return ESP_ERR_NVS_NOT_FOUND;
+    *marker = calloc(1, sizeof(**marker));
+    if (!*marker)
+      return ESP_ERR_NO_MEM;
+    strcpy((*marker)->ns, namespace_name);
+  }
+
+  for (int i = 0; i < SIM_NVS_HANDLES; i++)
+  {
+    if (!s_handles[i].used)
+    {
+      s_handles[i].used = true;
+      s_handles[i].writable = open_mode == NVS_READWRITE;
+      strcpy(s_handles[i].ns, namespace_name);
+      *out_handle = i + 1;
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_NO_MEM;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value,
+                       size_t *length)
+{
+  sim_nvs_handle_t *h = handle_get(handle);
+  if (!h)
+    return ESP_ERR_NVS_INVALID_HANDLE;
+  if (!key || !*key || !length)
+    return ESP_ERR_INVALID_ARG;
+
+  sim_nvs_entry_t *entry = *entry_find(h->ns, key);
+  if (!entry)
+    return ESP_ERR_NVS_NOT_FOUND;
+  if (!out_value)
+  {
+    *length = entry->length;
+    return ESP_OK;
+  }
+  if (*length < entry->length)
+  {
+    *length = entry->length;
+    return ESP_ERR_NVS_INVALID_LENGTH;
+  }
+  memcpy(out_value, entry->value, entry->length);
+  *length = entry->length;
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value,
+                       size_t length)
+{
+  sim_nvs_handle_t *h = handle_get(handle);
+  if (!h)
+    return ESP_ERR_NVS_INVALID_HANDLE;
+  if (!h->writable)
+    return ESP_ERR_NVS_READ_ONLY;
+  if (!key || !*key || strlen(key) >= NVS_KEY_NAME_MAX_SIZE ||
+      (!value && length))
+    return ESP_ERR_INVALID_ARG;
+
+  void *copy = malloc(length ? length : 1);
+  if (!copy)
+    return ESP_ERR_NO_MEM;
+  memcpy(copy, value, length);
+
+  sim_nvs_entry_t **link = entry_find(h->ns, key);
+  if (!*link)
+  {
+    *link = calloc(1, sizeof(**link));
+    if (!*link)
+    {
+      free(copy);
+      return ESP_ERR_NO_MEM;
+    }
+    strcpy((*link)->ns, h->ns);
+    strcpy((*link)->key, key);
+  }
+  free((*link)->value);
+  (*link)->value = copy;
+  (*link)->length = length;
+  sim_stats_ref()->nvs_writes++;
+  return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+  sim_nvs_handle_t *h = handle_get(handle);
+  if (!h)
+    return ESP_ERR_NVS_INVALID_HANDLE;
+  if (!h->writable)
+    return ESP_ERR_NVS_READ_ONLY;
+  if (!key || !*key)
+    return ESP_ERR_INVALID_ARG;
+
+  sim_nvs_entry_t **link = entry_find(h->ns, key);
+  sim_nvs_entry_t *entry = *link;
+  if (!entry)
+    return ESP_ERR_NVS_NOT_FOUND;
+  *link = entry->next;
+  free(entry->value);
+  free(entry);
+  return ESP_OK;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+  return handle_get(handle) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+  sim_nvs_handle_t *h = handle_get(handle);
+  if (h)
+    h->used = false;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file sim_priv.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Internal interfaces between the parts of the simulator
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SIM_PRIV_H
+#define SIM_PRIV_H
+
+#include "sim.h"
+
+#include <esp_netif.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+/**
+ * @brief Block the current task until an object is signaled or a deadline.
+ *
+ * @param obj The object waited on, NULL for a plain delay.
+ * @param wake_us Virtual time to wake up at, -1 for none.
+ * @return true if woken by `sim_sched_signal`, false at the deadline.
+ */
+bool sim_sched_block(const void *obj, int64_t wake_us);
+
+/**
+ * @brief Make every task blocked on an object ready.
+ *
+ * @param obj The object.
+ */
+void sim_sched_signal(const void *obj);
+
+/**
+ * @brief Whether the caller runs on a simulated task.
+ *
+ * @return true inside `sim_run`.
+ */
+bool sim_sched_in_task(void);
+
+/**
+ * @brief Convert a FreeRTOS timeout to a deadline.
+ *
+ * @param ticks The timeout in ticks.
+ * @return The virtual time of the deadline, -1 for `portMAX_DELAY`.
+ */
+int64_t sim_sched_deadline(TickType_t ticks);
+
+/**
+ * @brief Counters shared by the parts of the simulator.
+ *
+ * @return The counters.
+ */
+sim_stats_t *sim_stats_ref(void);
+
+/**
+ * @brief Run a function after a virtual delay on the timer task.
+ *
+ * @param timer The timer, created on first use.
+ * @param cb The function.
+ * @param arg Argument of `cb`.
+ * @param delay_ms The delay in milliseconds.
+ */
+void sim_after(esp_timer_handle_t *timer, void (*cb)(void *), void *arg,
+               uint32_t delay_ms);
+
+/**
+ * @brief Cancel a function scheduled with `sim_after`.
+ *
+ * @param timer The timer.
+ */
+void sim_cancel(esp_timer_handle_t timer);
+
+/**
+ * @brief Get the subnet of the access point the station is associated
+ * with.
+ *
+ * @return The third octet of its network, -1 when not associated.
+ */
+int sim_wifi_subnet(void);
+
+/**
+ * @brief Cancel the DHCP exchange and the ping sessions, on `sim_reset`.
+ */
+void sim_netif_reset(void);
+
+/**
+ * @brief Reseed `esp_random`.
+ *
+ * @param seed The seed.
+ */
+void sim_random_seed(uint32_t seed);
+
+#endif /* SIM_PRIV_H */
@@ -0,0 +1,608 @@
+/**
+ * @file sim_sched.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Cooperative scheduler of the simulated FreeRTOS tasks, their queues,
+ * semaphores, event groups and notifications
+ *
+ * Each task is a coroutine with its own stack. A task runs until it blocks,
+ * the ready tasks run in FIFO order, and the virtual clock jumps to the
+ * earliest deadline once none is ready. Nothing preempts a task, so the
+ * critical sections are empty.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "sim_priv.h"
+
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+
+/**
+ * @brief Stack of every task, the host C library needs more than the
+ * FreeRTOS stack sizes of the component.
+ */
+#define SIM_STACK_SIZE (256 * 1024)
+
+/**
+ * @brief Virtual time after which a run is considered stuck.
+ */
+#define SIM_HORIZON_US (7 * 24 * 3600 * 1000000LL)
+
+/**
+ * @brief State of a task.
+ */
+typedef enum
+{
+  SIM_TASK_READY,
+  SIM_TASK_BLOCKED,
+  SIM_TASK_DELETED,
+} sim_task_state_t;
+
+/**
+ * @brief A simulated task.
+ */
+struct sim_task
+{
+  ucontext_t ctx;          /**< Saved context. */
+  void *stack;             /**< Stack. */
+  TaskFunction_t code;     /**< Entry function. */
+  void *arg;               /**< Argument of `code`. */
+  char name[16];           /**< Name, for the deadlock report. */
+  sim_task_state_t state;  /**< State. */
+  const void *wait_obj;    /**< Object blocked on. */
+  int64_t wake_us;         /**< Deadline of the block, -1 for none. */
+  bool signaled;           /**< Whether the block ended by a signal. */
+  uint32_t notify;         /**< Notification value. */
+  struct sim_task *next;   /**< Next task in creation order. */
+  struct sim_task *ready;  /**< Next ready task. */
+};
+
+/**
+ * @brief A queue or semaphore, semaphores have no item.
+ */
+struct sim_queue
+{
+  uint8_t *items;   /**< Storage, NULL for semaphores. */
+  size_t item_size; /**< Size of an item. */
+  size_t length;    /**< Capacity. */
+  size_t count;     /**< Items held. */
+  size_t head;      /**< Index of the oldest item. */
+  bool is_static;   /**< Whether the caller owns the memory. */
+};
+
+/**
+ * @brief An event group.
+ */
+struct sim_event_group
+{
+  EventBits_t bits; /**< Bits. */
+};
+
+_Static_assert(sizeof(struct sim_queue) <= sizeof(StaticQueue_t),
+               "StaticQueue_t too small");
+_Static_assert(sizeof(struct sim_event_group) <= sizeof(StaticEventGroup_t),
+               "StaticEventGroup_t too small");
+
+/**
+ * @brief Every task, in creation order.
+ */
+static struct sim_task *s_tasks = NULL;
+
+/**
+ * @brief Ready tasks, in the order they became ready.
+ */
+static struct sim_task *s_ready_head = NULL;
+
+/**
+ * @brief Last ready task.
+ */
+static struct sim_task *s_ready_tail = NULL;
+
+/**
+ * @brief Task running, NULL in the scheduler.
+ */
+static struct sim_task *s_current = NULL;
+
+/**
+ * @brief Context of the scheduler.
+ */
+static ucontext_t s_sched_ctx;
+
+/**
+ * @brief Virtual time in microseconds.
+ */
+static int64_t s_now_us = 0;
+
+/**
+ * @brief Append a task to the ready list.
+ *
+ * @param task The task.
+ */
+static void ready_push(struct sim_task *task)
+{
+  task->state = SIM_TASK_READY;
+  task->ready = NULL;
+  if (s_ready_tail)
+    s_ready_tail->ready = task;
+  else
+    s_ready_head = task;
+  s_ready_tail = task;
+}
+
+/**
+ * @brief Take the first ready task.
+ *
+ * @return The task, NULL if none is ready.
+ */
+static struct sim_task *ready_pop()
+{
+  struct sim_task *task = s_ready_head;
+  if (task)
+  {
+    s_ready_head = task->ready;
+    if (!s_ready_head)
+      s_ready_tail = NULL;
+  }
+  return task;
+}
+
+/**
+ * @brief Entry of every task, deletes it when its function returns.
+ */
+static void task_entry()
+{
+  s_current->code(s_current->arg);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Report the blocked tasks and abort.
+ *
+ * @param why What went wrong.
+ */
+static void sched_abort(const char *why)
+{
+  fprintf(stderr, "[%10.6f] simulation %s, blocked tasks:\n", s_now_us / 1e6,
+          why);
+  for (struct sim_task *task = s_tasks; task; task = task->next)
+  {
+    if (task->state == SIM_TASK_BLOCKED)
+      fprintf(stderr, "  %s on %p until %lld\n", task->name, task->wait_obj,
+              (long long)task->wake_us);
+  }
+  abort();
+}
+
+/**
+ * @brief Advance the clock to the earliest deadline and wake its tasks.
+ *
+ * @param horizon_us Virtual time the run must not pass.
+ */
+static void sched_advance(int64_t horizon_us)
+{
+  int64_t next = -1;
+  for (struct sim_task *task = s_tasks; task; task = task->next)
+  {
+    if (task->state == SIM_TASK_BLOCKED && task->wake_us >= 0 &&
+        (next < 0 || task->wake_us < next))
+      next = task->wake_us;
+  }
+  if (next < 0)
+    sched_abort("deadlocked");
+  if (next > horizon_us)
+    sched_abort("passed its horizon");
+
+  if (next > s_now_us)
+    s_now_us = next;
+  for (struct sim_task *task = s_tasks; task; task = task->next)
+  {
+    if (task->state == SIM_TASK_BLOCKED && task->wake_us >= 0 &&
+        task->wake_us <= s_now_us)
+    {
+      task->signaled = false;
+      ready_push(task);
+    }
+  }
+}
+
+void sim_run(void (*fn)(void *), void *arg)
+{
+  TaskHandle_t main_task;
+  if (xTaskCreate(fn, "main", 0, arg, 1, &main_task) != pdPASS)
+    abort();
+
+  int64_t horizon_us = s_now_us + SIM_HORIZON_US;
+  while (main_task->state != SIM_TASK_DELETED)
+  {
+    struct sim_task *task = ready_pop();
+    if (!task)
+    {
+      sched_advance(horizon_us);
+      continue;
+    }
+    s_current = task;
+    swapcontext(&s_sched_ctx, &task->ctx);
+    s_current = NULL;
+  }
+
+  // The stacks are only released here, never by the task running on them
+  for (struct sim_task **link = &s_tasks; *link;)
+  {
+    struct sim_task *task = *link;
+    if (task->state == SIM_TASK_DELETED)
+    {
+      *link = task->next;
+      free(task->stack);
+      free(task);
+    }
+    else
+      link = &task->next;
+  }
+}
+
+bool sim_sched_block(const void *obj, int64_t wake_us)
+{
+  struct sim_task *task = s_current;
+  if (!task)
+  {
+    fprintf(stderr, "blocking call outside of a simulated task\n");
+    abort();
+  }
+  task->state = SIM_TASK_BLOCKED;
+  task->wait_obj = obj;
+  task->wake_us = wake_us;
+  task->signaled = false;
+  swapcontext(&task->ctx, &s_sched_ctx);
+  return task->signaled;
+}
+
+void sim_sched_signal(const void *obj)
+{
+  if (!obj)
+    return;
+  for (struct sim_task *task = s_tasks; task; task = task->next)
+  {
+    if (task->state == SIM_TASK_BLOCKED && task->wait_obj == obj)
+    {
+      task->signaled = true;
+      ready_push(task);
+    }
+  }
+}
+
+bool sim_sched_in_task()
+{
+  return s_current != NULL;
+}
+
+int64_t sim_sched_deadline(TickType_t ticks)
+{
+  if (ticks == portMAX_DELAY)
+    return -1;
+  return s_now_us + (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+int64_t sim_now_us()
+{
+  return s_now_us;
+}
+
+int64_t esp_timer_get_time()
+{
+  return s_now_us;
+}
+
+void sim_sleep_ms(uint32_t ms)
+{
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+/**
+ * @brief Whether a timed wait is over.
+ *
+ * @param deadline The deadline, -1 for none.
+ * @return true if the deadline passed.
+ */
+static bool deadline_passed(int64_t deadline)
+{
+  return deadline >= 0 && s_now_us >= deadline;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name,
+                                   uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created,
+                                   BaseType_t core)
+{
+  struct sim_task *task = calloc(1, sizeof(*task));
+  void *stack = malloc(SIM_STACK_SIZE);
+  if (!task || !stack)
+  {
+    free(task);
+    free(stack);
+    return pdFAIL;
+  }
+
+  task->stack = stack;
+  task->code = code;
+  task->arg = arg;
+  strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+  getcontext(&task->ctx);
+  task->ctx.uc_stack.ss_sp = stack;
+  task->ctx.uc_stack.ss_size = SIM_STACK_SIZE;
+  task->ctx.uc_link = NULL;
+  makecontext(&task->ctx, &task_entry, 0);
+
+  struct sim_task **link = &s_tasks;
+  while (*link)
+    link = &(*link)->next;
+  *link = task;
+  ready_push(task);
+
+  if (created)
+    *created = task;
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name,
+                       uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *created)
+{
+  return xTaskCreatePinnedToCore(code, name, stack_depth, arg, priority,
+                                 created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  if (!task)
+    task = s_current;
+
+  // A ready task is left in the ready list and skipped when popped
+  for (struct sim_task **link = &s_ready_head; *link; link = &(*link)->ready)
+  {
+    if (*link == task)
+    {
+      *link = task->ready;
+      if (s_ready_tail == task)
+      {
+        s_ready_tail = NULL;
+        for (struct sim_task *last = s_ready_head; last; last = last->ready)
+          s_ready_tail = last;
+      }
+      break;
+    }
+  }
+  task->state = SIM_TASK_DELETED;
+  if (task == s_current)
+    swapcontext(&task->ctx, &s_sched_ctx);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  if (!s_current)
+  {
+    struct timespec ts = {.tv_sec = ticks / 1000,
+                          .tv_nsec = (ticks % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+    return;
+  }
+  int64_t deadline = sim_sched_deadline(ticks);
+  while (!deadline_passed(deadline))
+    sim_sched_block(NULL, deadline);
+}
+
+TickType_t xTaskGetTickCount()
+{
+  return (TickType_t)(s_now_us / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  return s_current;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+  task->notify++;
+  sim_sched_signal(&task->notify);
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+  struct sim_task *task = s_current;
+  int64_t deadline = sim_sched_deadline(ticks);
+  while (task->notify == 0 && ticks != 0 && !deadline_passed(deadline))
+    sim_sched_block(&task->notify, deadline);
+
+  uint32_t value = task->notify;
+  if (value > 0)
+    task->notify = clear ? 0 : value - 1;
+  return value;
+}
+
+configRUN_TIME_COUNTER_TYPE ulTaskGetIdleRunTimeCounterForCore(BaseType_t core)
+{
+  return 0;
+}
+
+/**
+ * @brief Initialize a queue.
+ *
+ * @param queue The queue.
+ * @param length The capacity.
+ * @param item_size The size of an item, 0 for semaphores.
+ * @return false if the storage could not be allocated.
+ */
+static bool queue_init(struct sim_queue *queue, size_t length,
+                       size_t item_size)
+{
+  memset(queue, 0, sizeof(*queue));
+  queue->length = length;
+  queue->item_size = item_size;
+  if (item_size > 0)
+  {
+    queue->items = malloc(length * item_size);
+    if (!queue->items)
+      return false;
+  }
+  return true;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+  struct sim_queue *queue = malloc(sizeof(*queue));
+  if (!queue || !queue_init(queue, length, item_size))
+  {
+    free(queue);
+    return NULL;
+  }
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+  free(queue->items);
+  if (!queue->is_static)
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait)
+{
+  int64_t deadline = sim_sched_deadline(wait);
+  while (queue->count == queue->length)
+  {
+    if (wait == 0 || !s_current || deadline_passed(deadline))
+      return pdFALSE;
+    sim_sched_block(queue, deadline);
+  }
+
+  if (queue->item_size > 0)
+  {
+    size_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+  }
+  queue->count++;
+  sim_sched_signal(queue);
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait)
+{
+  int64_t deadline = sim_sched_deadline(wait);
+  while (queue->count == 0)
+  {
+    if (wait == 0 || !s_current || deadline_passed(deadline))
+      return pdFALSE;
+    sim_sched_block(queue, deadline);
+  }
+
+  if (queue->item_size > 0)
+    memcpy(item, queue->items + queue->head * queue->item_size,
+           queue->item_size);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  sim_sched_signal(queue);
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+  return queue->count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+  return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+  SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+  if (mutex)
+    mutex->count = 1;
+  return mutex;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *buffer)
+{
+  struct sim_queue *mutex = (struct sim_queue *)buffer;
+  queue_init(mutex, 1, 0);
+  mutex->is_static = true;
+  mutex->count = 1;
+  return mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait)
+{
+  return xQueueReceive(semaphore, NULL, wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+  return xQueueSend(semaphore, NULL, 0);
+}
+
+EventGroupHandle_t xEventGroupCreate()
+{
+  return calloc(1, sizeof(struct sim_event_group));
+}
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t *buffer)
+{
+  struct sim_event_group *group = (struct sim_event_group *)buffer;
+  group->bits = 0;
+  return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+  group->bits |= bits;
+  sim_sched_signal(group);
+  return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+  EventBits_t previous = group->bits;
+  group->bits &= ~bits;
+  return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+  return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                BaseType_t clear_on_exit, BaseType_t wait_all,
+                                TickType_t wait)
+{
+  int64_t deadline = sim_sched_deadline(wait);
+  for (;;)
+  {
+    EventBits_t value = group->bits;
+    bool met = wait_all ? (value & bits) == bits : (value & bits) != 0;
+    if (met)
+    {
+      if (clear_on_exit)
+        group->bits &= ~bits;
+      return value;
+    }
+    if (wait == 0 || deadline_passed(deadline))
+      return value;
+    sim_sched_block(group, deadline);
+  }
+}
@@ -0,0 +1,206 @@
+/**
+ * @file sim_timer.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief High resolution timers, their callbacks run on a simulated task as
+ * with `ESP_TIMER_TASK`
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "sim_priv.h"
+
+#include <freertos/task.h>
+
+#include <stdlib.h>
+
+/**
+ * @brief A timer.
+ */
+struct esp_timer
+{
+  esp_timer_cb_t callback; /**< Callback. */
+  void *arg;               /**< Argument of the callback. */
+  int64_t deadline_us;     /**< Expiry, -1 when stopped. */
+  uint64_t period_us;      /**< Period, 0 for one-shot timers. */
+  uint64_t seq;            /**< Start order, breaks ties between deadlines. */
+  struct esp_timer *next;  /**< Next created timer. */
+};
+
+/**
+ * @brief Every timer.
+ */
+static struct esp_timer *s_timers = NULL;
+
+/**
+ * @brief Start counter.
+ */
+static uint64_t s_seq = 0;
+
+/**
+ * @brief Task running the callbacks.
+ */
+static TaskHandle_t s_task = NULL;
+
+/**
+ * @brief Find the next timer to expire.
+ *
+ * @return The timer, NULL if none is active.
+ */
+static struct esp_timer *timer_next()
+{
+  struct esp_timer *next = NULL;
+  for (struct esp_timer *timer = s_timers; timer; timer = timer->next)
+  {
+    if (timer->deadline_us < 0)
+      continue;
+    if (!next || timer->deadline_us < next->deadline_us ||
+        (timer->deadline_us == next->deadline_us && timer->seq < next->seq))
+      next = timer;
+  }
+  return next;
+}
+
+/**
+ * @brief Task running the expired callbacks.
+ *
+ * @param arg Unused.
+ */
+static void timer_task(void *arg)
+{
+  for (;;)
+  {
+    struct esp_timer *timer = timer_next();
+    if (!timer)
+    {
+      sim_sched_block(&s_timers, -1);
+      continue;
+    }
+    if (timer->deadline_us > sim_now_us())
+    {
+      sim_sched_block(&s_timers, timer->deadline_us);
+      continue;
+    }
+
+    if (timer->period_us > 0)
+    {
+      timer->deadline_us += timer->period_us;
+      timer->seq = s_seq++;
+    }
+    else
+      timer->deadline_us = -1;
+    timer->callback(timer->arg);
+  }
+}
+
+/**
+ * @brief Arm a timer and wake the timer task.
+ *
+ * @param timer The timer.
+ * @param timeout_us The delay.
+ * @param period_us The period, 0 for a one-shot timer.
+ * @return ESP_ERR_INVALID_STATE if the timer is already running.
+ */
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t timeout_us,
+                             uint64_t period_us)
+{
+  if (!timer)
+    return ESP_ERR_INVALID_ARG;
+  if (timer->deadline_us >= 0)
+    return ESP_ERR_INVALID_STATE;
+
+  if (!s_task)
+    xTaskCreate(timer_task, "esp_timer", 0, NULL, 22, &s_task);
+  timer->deadline_us = sim_now_us() + (int64_t)timeout_us;
+  timer->period_us = period_us;
+  timer->seq = s_seq++;
+  sim_sched_signal(&s_timers);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args,
+                           esp_timer_handle_t *out_handle)
+{
+  if (!create_args || !create_args->callback || !out_handle)
+    return ESP_ERR_INVALID_ARG;
+
+  struct esp_timer *timer = calloc(1, sizeof(*timer));
+  if (!timer)
+    return ESP_ERR_NO_MEM;
+  timer->callback = create_args->callback;
+  timer->arg = create_args->arg;
+  timer->deadline_us = -1;
+  timer->next = s_timers;
+  s_timers = timer;
+  *out_handle = timer;
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+  return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+  return timer_start(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+  if (!timer)
+    return ESP_ERR_INVALID_ARG;
+  if (timer->deadline_us < 0)
+    return ESP_ERR_INVALID_STATE;
+  timer->deadline_us = -1;
+  sim_sched_signal(&s_timers);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+  if (!timer)
+    return ESP_ERR_INVALID_ARG;
+  if (timer->deadline_us >= 0)
+    return ESP_ERR_INVALID_STATE;
+
+  for (struct esp_timer **link = &s_timers; *link; link = &(*link)->next)
+  {
+    if (*link == timer)
+    {
+      *link = timer->next;
+      break;
+    }
+  }
+  free(timer);
+  return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+  return timer && timer->deadline_us >= 0;
+}
+
+void sim_after(esp_timer_handle_t *timer, void (*cb)(void *), void *arg,
+               uint32_t delay_ms)
+{
+  if (!*timer)
+  {
+    esp_timer_create_args_t args = {.callback = cb, .arg = arg};
+    esp_timer_create(&args, timer);
+  }
+  (*timer)->callback = cb;
+  (*timer)->arg = arg;
+  esp_timer_stop(*timer);
+  esp_timer_start_once(*timer, (uint64_t)delay_ms * 1000);
+}
+
+void sim_cancel(esp_timer_handle_t timer)
+{
+  if (timer)
+    esp_timer_stop(timer);
+}
@@ -0,0 +1,842 @@
+/**
+ * @file sim_wifi.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Simulated Wi-Fi driver and supplicant, scanning and joining the
+ * access points of `sim.h` with the events and timing of the real driver
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "sim_priv.h"
+
+#include <esp_heap_caps.h>
+#include <esp_rrm.h>
+#include <esp_wifi.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Free internal RAM of the simulated device before the driver.
+ */
+#define SIM_HEAP_BYTES (220 * 1024)
+
+/**
+ * @brief RAM allocated by the driver besides its buffers.
+ */
+#define SIM_DRIVER_BYTES (52 * 1024)
+
+/**
+ * @brief Size of a driver buffer.
+ */
+#define SIM_BUFFER_BYTES 1600
+
+/**
+ * @brief Length of a neighbor report element.
+ */
+#define SIM_NEIGHBOR_ELEMENT 15
+
+/**
+ * @brief Beacon interval, 100 TU, at which the RSSI threshold is checked.
+ */
+#define SIM_BEACON_MS 102
+
+/**
+ * @brief A simulated access point and its state.
+ */
+typedef struct
+{
+  sim_ap_t ap;      /**< Definition, the strings point into this entry. */
+  char ssid[33];    /**< Copy of the SSID. */
+  char password[65];/**< Copy of the password. */
+  bool up;          /**< Whether the AP is on. */
+} sim_ap_entry_t;
+
+/**
+ * @brief State of the station.
+ */
+typedef enum
+{
+  SIM_STA_IDLE,       /**< Not associated. */
+  SIM_STA_SCANNING,   /**< Looking for the AP to join. */
+  SIM_STA_JOINING,    /**< Authenticating with `s_sta_ap`. */
+  SIM_STA_CONNECTED,  /**< Associated with `s_sta_ap`. */
+} sim_sta_state_t;
+
+/**
+ * @brief Access points.
+ */
+static sim_ap_entry_t s_aps[SIM_MAX_APS];
+
+/**
+ * @brief Number of access points.
+ */
+static int s_ap_count = 0;
+
+/**
+ * @brief Timing.
+ */
+static sim_timing_t s_timing = SIM_TIMING_DEFAULT();
+
+/**
+ * @brief Whether `esp_wifi_init` was called.
+ */
+static bool s_initialized = false;
+
+/**
+ * @brief Whether `esp_wifi_start` was called.
+ */
+static bool s_started = false;
+
+/**
+ * @brief Buffers allocated by `esp_wifi_init`.
+ */
+static size_t s_driver_bytes = 0;
+
+/**
+ * @brief Station configuration.
+ */
+static wifi_config_t s_config;
+
+/**
+ * @brief State of the station.
+ */
+static sim_sta_state_t s_sta = SIM_STA_IDLE;
+
+/**
+ * @brief Access point joined or being joined.
+ */
+static int s_sta_ap = -1;
+
+/**
+ * @brief Armed RSSI threshold, 0 when disarmed.
+ */
+static int32_t s_rssi_threshold = 0;
+
+/**
+ * @brief Whether a scan is running.
+ */
+static bool s_scanning = false;
+
+/**
+ * @brief Scan filter.
+ */
+static wifi_scan_config_t s_scan_filter;
+
+/**
+ * @brief SSID and BSSID of the scan filter.
+ */
+static struct
+{
+  uint8_t ssid[33]; /**< SSID. */
+  uint8_t bssid[6]; /**< BSSID. */
+} s_scan_match;
+
+/**
+ * @brief Scan results not yet read.
+ */
+static wifi_ap_record_t s_records[SIM_MAX_APS];
+
+/**
+ * @brief Number of scan results.
+ */
+static int s_record_count = 0;
+
+/**
+ * @brief Next scan result to read.
+ */
+static int s_record_next = 0;
+
+/**
+ * @brief Timers of the driver steps.
+ */
+static esp_timer_handle_t s_start_timer = NULL, s_scan_timer = NULL,
+                          s_join_timer = NULL, s_beacon_timer = NULL,
+                          s_neighbor_timer = NULL, s_rssi_timer = NULL;
+
+/**
+ * @brief Post a Wi-Fi event.
+ *
+ * @param id The event.
+ * @param data The event data.
+ * @param size The size of `data`.
+ */
+static void post(int32_t id, const void *data, size_t size)
+{
+  esp_event_post(WIFI_EVENT, id, data, size, portMAX_DELAY);
+}
+
+/**
+ * @brief Length of the configured SSID.
+ *
+ * @return The length.
+ */
+static size_t config_ssid_len()
+{
+  return strnlen((const char *)s_config.sta.ssid, sizeof(s_config.sta.ssid));
+}
+
+/**
+ * @brief Whether an AP can be joined with the station configuration.
+ *
+ * @param entry The access point.
+ * @return true if it matches.
+ */
+static bool ap_matches_config(const sim_ap_entry_t *entry)
+{
+  const wifi_sta_config_t *sta = &s_config.sta;
+  size_t len = config_ssid_len();
+  if (!entry->up || strlen(entry->ssid) != len ||
+      memcmp(entry->ssid, sta->ssid, len) != 0)
+    return false;
+  if (sta->bssid_set && memcmp(entry->ap.bssid, sta->bssid, 6) != 0)
+    return false;
+  if (entry->ap.authmode < sta->threshold.authmode)
+    return false;
+  return sta->threshold.rssi == 0 || entry->ap.rssi >= sta->threshold.rssi;
+}
+
+/**
+ * @brief Post `WIFI_EVENT_STA_DISCONNECTED` and return to idle.
+ *
+ * @param reason The reason.
+ */
+static void sta_disconnected(uint8_t reason)
+{
+  wifi_event_sta_disconnected_t event = {.reason = reason, .rssi = -127};
+  size_t len = config_ssid_len();
+  memcpy(event.ssid, s_config.sta.ssid, len);
+  event.ssid_len = len;
+  if (s_sta_ap >= 0)
+  {
+    memcpy(event.bssid, s_aps[s_sta_ap].ap.bssid, 6);
+    event.rssi = s_aps[s_sta_ap].ap.rssi;
+  }
+  else if (s_config.sta.bssid_set)
+    memcpy(event.bssid, s_config.sta.bssid, 6);
+
+  sim_cancel(s_join_timer);
+  sim_cancel(s_beacon_timer);
+  sim_cancel(s_neighbor_timer);
+  sim_cancel(s_rssi_timer);
+  s_sta = SIM_STA_IDLE;
+  s_sta_ap = -1;
+  post(WIFI_EVENT_STA_DISCONNECTED, &event, sizeof(event));
+}
+
+/**
+ * @brief Leave the AP joined or being joined, if any.
+ *
+ * @param reason The reason reported.
+ */
+static void sta_leave(uint8_t reason)
+{
+  if (s_sta != SIM_STA_IDLE)
+    sta_disconnected(reason);
+}
+
+/**
+ * @brief Post `WIFI_EVENT_STA_BSS_RSSI_LOW` if the RSSI of the joined AP is
+ * below the armed threshold, disarming it.
+ *
+ * @param arg Unused.
+ */
+static void rssi_check(void *arg)
+{
+  if (s_sta != SIM_STA_CONNECTED || s_rssi_threshold == 0)
+    return;
+  int8_t rssi = s_aps[s_sta_ap].ap.rssi;
+  if (rssi >= s_rssi_threshold)
+    return;
+  s_rssi_threshold = 0;
+  wifi_event_bss_rssi_low_t event = {.rssi = rssi};
+  post(WIFI_EVENT_STA_BSS_RSSI_LOW, &event, sizeof(event));
+}
+
+/**
+ * @brief Complete the association with `s_sta_ap`.
+ *
+ * @param arg Unused.
+ */
+static void join_associated(void *arg)
+{
+  sim_ap_entry_t *entry = &s_aps[s_sta_ap];
+  if (!entry->up)
+  {
+    sta_disconnected(WIFI_REASON_AUTH_EXPIRE);
+    return;
+  }
+  if (entry->ap.reject_reason)
+  {
+    sta_disconnected(entry->ap.reject_reason);
+    return;
+  }
+
+  s_sta = SIM_STA_CONNECTED;
+  sim_stats_ref()->associations++;
+  wifi_event_sta_connected_t event = {
+    .ssid_len = strlen(entry->ssid),
+    .channel = entry->ap.channel,
+    .authmode = entry->ap.authmode,
+    .aid = 1,
+  };
+  memcpy(event.ssid, entry->ssid, event.ssid_len);
+  memcpy(event.bssid, entry->ap.bssid, 6);
+  post(WIFI_EVENT_STA_CONNECTED, &event, sizeof(event));
+  rssi_check(NULL);
+}
+
+/**
+ * @brief Report the failed handshake of a wrong password.
+ *
+ * @param arg Unused.
+ */
+static void join_handshake_failed(void *arg)
+{
+  sta_disconnected(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT);
+}
+
+/**
+ * @brief Authenticate with `s_sta_ap` and run the handshake.
+ *
+ * @param arg Unused.
+ */
+static void join_authenticate(void *arg)
+{
+  sim_ap_entry_t *entry = &s_aps[s_sta_ap];
+  if (!entry->up)
+  {
+    sta_disconnected(WIFI_REASON_AUTH_EXPIRE);
+    return;
+  }
+
+  bool open = entry->ap.authmode == WIFI_AUTH_OPEN;
+  if (!open && strncmp((const char *)s_config.sta.password, entry->password,
+                       sizeof(s_config.sta.password)) != 0)
+  {
+    sim_after(&s_join_timer, &join_handshake_failed, NULL, s_timing.fail_ms);
+    return;
+  }
+  sim_after(&s_join_timer, &join_associated, NULL,
+            open ? 0 : s_timing.handshake_ms);
+}
+
+/**
+ * @brief End of the connection scan, join the AP found.
+ *
+ * @param arg The index of the AP found, -1 for none.
+ */
+static void join_scanned(void *arg)
+{
+  int ap = (int)(intptr_t)arg;
+  if (ap < 0 || !ap_matches_config(&s_aps[ap]))
+  {
+    sta_disconnected(WIFI_REASON_NO_AP_FOUND);
+    return;
+  }
+  s_sta = SIM_STA_JOINING;
+  s_sta_ap = ap;
+  sim_after(&s_join_timer, &join_authenticate, NULL, s_timing.auth_ms);
+}
+
+/**
+ * @brief Start joining the configured network, scanning for it as the
+ * driver does.
+ */
+static void join_start()
+{
+  const wifi_sta_config_t *sta = &s_config.sta;
+  uint8_t first = 1, last = SIM_CHANNELS;
+  if (sta->channel >= 1 && sta->channel <= SIM_CHANNELS)
+    first = last = sta->channel;
+
+  // The fast scan stops at the first channel with a match, the all-channel
+  // scan picks the strongest match
+  int best = -1;
+  uint32_t dwelt = 0;
+  for (uint8_t channel = first; channel <= last; channel++)
+  {
+    dwelt++;
+    for (int i = 0; i < s_ap_count; i++)
+    {
+      if (s_aps[i].ap.channel == channel && ap_matches_config(&s_aps[i]) &&
+          (best < 0 || s_aps[i].ap.rssi > s_aps[best].ap.rssi))
+        best = i;
+    }
+    if (best >= 0 && sta->scan_method == WIFI_FAST_SCAN)
+      break;
+  }
+
+  sim_stats_ref()->scanned_channels += dwelt;
+  s_sta = SIM_STA_SCANNING;
+  s_sta_ap = -1;
+  sim_after(&s_join_timer, &join_scanned, (void *)(intptr_t)best,
+            dwelt * s_timing.active_dwell_ms);
+}
+
+/**
+ * @brief Post `WIFI_EVENT_STA_START`.
+ *
+ * @param arg Unused.
+ */
+static void start_done(void *arg)
+{
+  post(WIFI_EVENT_STA_START, NULL, 0);
+}
+
+/**
+ * @brief Lose the joined AP after its beacons stopped.
+ *
+ * @param arg Unused.
+ */
+static void beacon_lost(void *arg)
+{
+  if (s_sta != SIM_STA_CONNECTED)
+    return;
+  post(WIFI_EVENT_STA_BEACON_TIMEOUT, NULL, 0);
+  sta_disconnected(WIFI_REASON_BEACON_TIMEOUT);
+}
+
+/**
+ * @brief Compare scan records by decreasing RSSI.
+ *
+ * @param a A record.
+ * @param b A record.
+ * @return The order.
+ */
+static int record_compare(const void *a, const void *b)
+{
+  const wifi_ap_record_t *ra = a, *rb = b;
+  return rb->rssi - ra->rssi;
+}
+
+/**
+ * @brief End of a scan, collect the APs heard.
+ *
+ * @param arg Unused.
+ */
+static void scan_done(void *arg)
+{
+  s_scanning = false;
+  s_record_count = 0;
+  s_record_next = 0;
+  for (int i = 0; i < s_ap_count; i++)
+  {
+    const sim_ap_entry_t *entry = &s_aps[i];
+    if (!entry->up)
+      continue;
+    if (s_scan_filter.channel && entry->ap.channel != s_scan_filter.channel)
+      continue;
+    if (s_scan_filter.ssid && strcmp(entry->ssid, (char *)s_scan_match.ssid))
+      continue;
+    if (s_scan_filter.bssid && memcmp(entry->ap.bssid, s_scan_match.bssid, 6))
+      continue;
+
+    wifi_ap_record_t *record = &s_records[s_record_count++];
+    memset(record, 0, sizeof(*record));
+    memcpy(record->bssid, entry->ap.bssid, 6);
+    strncpy((char *)record->ssid, entry->ssid, sizeof(record->ssid) - 1);
+    record->primary = entry->ap.channel;
+    record->rssi = entry->ap.rssi;
+    record->authmode = entry->ap.authmode;
+    record->pairwise_cipher = entry->ap.authmode == WIFI_AUTH_OPEN
+                                ? WIFI_CIPHER_TYPE_NONE
+                                : WIFI_CIPHER_TYPE_CCMP;
+    record->group_cipher = record->pairwise_cipher;
+    record->phy_11b = record->phy_11g = record->phy_11n = 1;
+  }
+  qsort(s_records, s_record_count, sizeof(s_records[0]), &record_compare);
+
+  wifi_event_sta_scan_done_t event = {.status = 0, .number = s_record_count};
+  post(WIFI_EVENT_SCAN_DONE, &event, sizeof(event));
+}
+
+/**
+ * @brief Answer a neighbor report request with the other APs of the
+ * network.
+ *
+ * @param arg Unused.
+ */
+static void neighbor_report(void *arg)
+{
+  if (s_sta != SIM_STA_CONNECTED)
+    return;
+
+  static wifi_event_neighbor_report_t event;
+  memset(&event, 0, sizeof(event));
+  const sim_ap_entry_t *current = &s_aps[s_sta_ap];
+  for (int i = 0; i < s_ap_count; i++)
+  {
+    const sim_ap_entry_t *entry = &s_aps[i];
+    if (i == s_sta_ap || strcmp(entry->ssid, current->ssid) != 0 ||
+        event.report_len + SIM_NEIGHBOR_ELEMENT > sizeof(event.report))
+      continue;
+
+    uint8_t *element = event.report + event.report_len;
+    element[0] = 52;
+    element[1] = SIM_NEIGHBOR_ELEMENT - 2;
+    memcpy(element + 2, entry->ap.bssid, 6);
+    element[12] = 81;
+    element[13] = entry->ap.channel;
+    element[14] = 7;
+    event.report_len += SIM_NEIGHBOR_ELEMENT;
+  }
+  post(WIFI_EVENT_STA_NEIGHBOR_REP, &event, sizeof(event));
+}
+
+void sim_reset(uint32_t seed)
+{
+  sim_cancel(s_join_timer);
+  sim_cancel(s_beacon_timer);
+  sim_cancel(s_neighbor_timer);
+  sim_cancel(s_rssi_timer);
+  sim_cancel(s_scan_timer);
+  s_sta = SIM_STA_IDLE;
+  s_sta_ap = -1;
+  s_scanning = false;
+  s_record_count = 0;
+  s_ap_count = 0;
+  s_rssi_threshold = 0;
+  s_timing = (sim_timing_t)SIM_TIMING_DEFAULT();
+  sim_netif_reset();
+  sim_random_seed(seed);
+  sim_reset_stats();
+}
+
+void sim_set_timing(const sim_timing_t *timing)
+{
+  s_timing = *timing;
+}
+
+sim_timing_t sim_get_timing()
+{
+  return s_timing;
+}
+
+int sim_ap_add(const sim_ap_t *ap)
+{
+  if (s_ap_count == SIM_MAX_APS)
+    return -1;
+  sim_ap_entry_t *entry = &s_aps[s_ap_count];
+  memset(entry, 0, sizeof(*entry));
+  entry->ap = *ap;
+  strncpy(entry->ssid, ap->ssid ? ap->ssid : "", sizeof(entry->ssid) - 1);
+  strncpy(entry->password, ap->password ? ap->password : "",
+          sizeof(entry->password) - 1);
+  entry->ap.ssid = entry->ssid;
+  entry->ap.password = entry->password;
+  if (entry->ap.subnet == 0)
+    entry->ap.subnet = 1;
+  entry->up = true;
+  return s_ap_count++;
+}
+
+void sim_ap_set_up(int ap, bool up)
+{
+  if (s_aps[ap].up == up)
+    return;
+  s_aps[ap].up = up;
+  if (s_sta != SIM_STA_CONNECTED || s_sta_ap != ap)
+    return;
+  // The beacons are back before the station gave up on them
+  if (up)
+    sim_cancel(s_beacon_timer);
+  else
+    sim_after(&s_beacon_timer, &beacon_lost, NULL,
+              s_timing.beacon_timeout_ms);
+}
+
+void sim_ap_set_rssi(int ap, int8_t rssi)
+{
+  s_aps[ap].ap.rssi = rssi;
+  if (s_sta_ap == ap)
+    rssi_check(NULL);
+}
+
+void sim_ap_set_reject(int ap, uint8_t reason)
+{
+  s_aps[ap].ap.reject_reason = reason;
+}
+
+bool sim_supplicant_roam(int ap)
+{
+  if (s_sta != SIM_STA_CONNECTED)
+    return false;
+  sta_disconnected(WIFI_REASON_ROAMING);
+  s_sta = SIM_STA_JOINING;
+  s_sta_ap = ap;
+  sim_after(&s_join_timer, &join_associated, NULL, s_timing.ft_ms);
+  return true;
+}
+
+int sim_connected_ap()
+{
+  return s_sta == SIM_STA_CONNECTED ? s_sta_ap : -1;
+}
+
+int sim_wifi_subnet()
+{
+  return s_sta == SIM_STA_CONNECTED ? s_aps[s_sta_ap].ap.subnet : -1;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+  return SIM_HEAP_BYTES - s_driver_bytes;
+}
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config)
+{
+  if (s_initialized)
+    return ESP_OK;
+  s_initialized = true;
+  s_driver_bytes =
+    SIM_DRIVER_BYTES + (size_t)(config->static_rx_buf_num +
+                                config->static_tx_buf_num) * SIM_BUFFER_BYTES;
+  memset(&s_config, 0, sizeof(s_config));
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_deinit()
+{
+  if (!s_initialized)
+    return ESP_ERR_WIFI_NOT_INIT;
+  if (s_started)
+    return ESP_ERR_WIFI_NOT_STARTED;
+  s_initialized = false;
+  s_driver_bytes = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode)
+{
+  return s_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage)
+{
+  return s_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_start()
+{
+  if (!s_initialized)
+    return ESP_ERR_WIFI_NOT_INIT;
+  if (s_started)
+    return ESP_OK;
+  s_started = true;
+  sim_after(&s_start_timer, &start_done, NULL, s_timing.start_ms);
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_stop()
+{
+  if (!s_initialized)
+    return ESP_ERR_WIFI_NOT_INIT;
+  if (!s_started)
+    return ESP_OK;
+  sta_leave(WIFI_REASON_ASSOC_LEAVE);
+  if (s_scanning)
+  {
+    sim_cancel(s_scan_timer);
+    s_scanning = false;
+  }
+  sim_cancel(s_start_timer);
+  s_started = false;
+  post(WIFI_EVENT_STA_STOP, NULL, 0);
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_connect()
+{
+  if (!s_initialized)
+    return ESP_ERR_WIFI_NOT_INIT;
+  if (!s_started)
+    return ESP_ERR_WIFI_NOT_STARTED;
+  if (config_ssid_len() == 0)
+    return ESP_ERR_WIFI_STATE;
+
+  sim_stats_ref()->connects++;
+  if (s_sta == SIM_STA_CONNECTED)
+    sta_leave(WIFI_REASON_ASSOC_LEAVE);
+  join_start();
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect()
+{
+  if (!s_initialized)
+    return ESP_ERR_WIFI_NOT_INIT;
+  if (!s_started)
+    return ESP_ERR_WIFI_NOT_STARTED;
+  sta_leave(WIFI_REASON_ASSOC_LEAVE);
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+  if (!s_initialized)
+    return ESP_ERR_WIFI_NOT_INIT;
+  if (interface != WIFI_IF_STA || !conf)
+    return ESP_ERR_INVALID_ARG;
+  s_config = *conf;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf)
+{
+  if (!s_initialized)
+    return ESP_ERR_WIFI_NOT_INIT;
+  if (interface != WIFI_IF_STA || !conf)
+    return ESP_ERR_INVALID_ARG;
+  *conf = s_config;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block)
+{
+  if (!s_started)
+    return ESP_ERR_WIFI_NOT_STARTED;
+  if (s_scanning || s_sta == SIM_STA_SCANNING || s_sta == SIM_STA_JOINING)
+    return ESP_ERR_WIFI_STATE;
+
+  memset(&s_scan_filter, 0, sizeof(s_scan_filter));
+  memset(&s_scan_match, 0, sizeof(s_scan_match));
+  if (config)
+  {
+    s_scan_filter = *config;
+    if (config->ssid)
+      strncpy((char *)s_scan_match.ssid, (const char *)config->ssid,
+              sizeof(s_scan_match.ssid) - 1);
+    if (config->bssid)
+      memcpy(s_scan_match.bssid, config->bssid, 6);
+  }
+
+  uint32_t dwell;
+  if (s_scan_filter.scan_type == WIFI_SCAN_TYPE_PASSIVE)
+    dwell = s_scan_filter.scan_time.passive ? s_scan_filter.scan_time.passive
+                                            : s_timing.passive_dwell_ms;
+  else
+    dwell = s_scan_filter.scan_time.active.max
+              ? s_scan_filter.scan_time.active.max
+              : s_timing.active_dwell_ms;
+  uint32_t channels = s_scan_filter.channel ? 1 : SIM_CHANNELS;
+
+  sim_stats_t *stats = sim_stats_ref();
+  stats->scans++;
+  stats->scanned_channels += channels;
+  s_scanning = true;
+  if (block)
+  {
+    sim_sleep_ms(channels * dwell);
+    scan_done(NULL);
+  }
+  else
+    sim_after(&s_scan_timer, &scan_done, NULL, channels * dwell);
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_stop()
+{
+  if (!s_started)
+    return ESP_ERR_WIFI_NOT_STARTED;
+  if (!s_scanning)
+    return ESP_OK;
+  sim_cancel(s_scan_timer);
+  s_scanning = false;
+  s_record_count = 0;
+  wifi_event_sta_scan_done_t event = {.status = 1};
+  post(WIFI_EVENT_SCAN_DONE, &event, sizeof(event));
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number)
+{
+  *number = s_record_count - s_record_next;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number,
+                                       wifi_ap_record_t *ap_records)
+{
+  uint16_t count = 0;
+  while (count < *number && s_record_next < s_record_count)
+    ap_records[count++] = s_records[s_record_next++];
+  *number = count;
+  // The records not read are freed, as by the driver
+  s_record_count = 0;
+  s_record_next = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_record(wifi_ap_record_t *ap_record)
+{
+  if (s_record_next >= s_record_count)
+    return ESP_FAIL;
+  *ap_record = s_records[s_record_next++];
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_clear_ap_list()
+{
+  s_record_count = 0;
+  s_record_next = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+  if (s_sta != SIM_STA_CONNECTED)
+    return ESP_ERR_WIFI_NOT_CONNECT;
+  const sim_ap_entry_t *entry = &s_aps[s_sta_ap];
+  memset(ap_info, 0, sizeof(*ap_info));
+  memcpy(ap_info->bssid, entry->ap.bssid, 6);
+  strncpy((char *)ap_info->ssid, entry->ssid, sizeof(ap_info->ssid) - 1);
+  ap_info->primary = entry->ap.channel;
+  ap_info->rssi = entry->ap.rssi;
+  ap_info->authmode = entry->ap.authmode;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_rssi(int *rssi)
+{
+  if (s_sta != SIM_STA_CONNECTED)
+    return ESP_ERR_WIFI_NOT_CONNECT;
+  *rssi = s_aps[s_sta_ap].ap.rssi;
+  return ESP_OK;
+}
+
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type)
+{
+  return s_initialized ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_set_rssi_threshold(int32_t rssi)
+{
+  if (!s_initialized)
+    return ESP_ERR_WIFI_NOT_INIT;
+  // Checked on the next beacon, so a threshold armed below the RSSI does not
+  // report it again at once
+  s_rssi_threshold = rssi;
+  sim_after(&s_rssi_timer, &rssi_check, NULL, SIM_BEACON_MS);
+  return ESP_OK;
+}
+
+bool esp_rrm_is_rrm_supported_connection()
+{
+  return s_sta == SIM_STA_CONNECTED && s_config.sta.rm_enabled &&
+         s_aps[s_sta_ap].ap.rrm;
+}
+
+int esp_rrm_send_neighbor_report_request()
+{
+  if (!esp_rrm_is_rrm_supported_connection())
+    return -1;
+  sim_stats_ref()->neighbor_requests++;
+  sim_after(&s_neighbor_timer, &neighbor_report, NULL, s_timing.neighbor_ms);
+  return 0;
+}
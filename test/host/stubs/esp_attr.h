@@ -0,0 +1,22 @@
+/**
+ * @file esp_attr.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Memory placement attributes, without effect on the host
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#endif /* ESP_ATTR_H */
@@ -0,0 +1,53 @@
+/**
+ * @file esp_event.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Default event loop of the host build, run by a simulated task
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_EVENT_H
+#define ESP_EVENT_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef const char *esp_event_base_t;
+typedef struct sim_event_handler *esp_event_handler_instance_t;
+typedef void (*esp_event_handler_t)(void *arg, esp_event_base_t event_base,
+                                    int32_t event_id, void *event_data);
+
+#define ESP_EVENT_ANY_ID -1
+
+#define ESP_EVENT_DECLARE_BASE(id) extern esp_event_base_t const id
+#define ESP_EVENT_DEFINE_BASE(id) esp_event_base_t const id = #id
+
+esp_err_t esp_event_loop_create_default(void);
+esp_err_t esp_event_loop_delete_default(void);
+esp_err_t esp_event_handler_instance_register(
+  esp_event_base_t event_base, int32_t event_id,
+  esp_event_handler_t event_handler, void *event_handler_arg,
+  esp_event_handler_instance_t *instance);
+esp_err_t esp_event_handler_instance_unregister(
+  esp_event_base_t event_base, int32_t event_id,
+  esp_event_handler_instance_t instance);
+esp_err_t esp_event_handler_register(esp_event_base_t event_base,
+                                     int32_t event_id,
+                                     esp_event_handler_t event_handler,
+                                     void *event_handler_arg);
+esp_err_t esp_event_handler_unregister(esp_event_base_t event_base,
+                                       int32_t event_id,
+                                       esp_event_handler_t event_handler);
+esp_err_t esp_event_post(esp_event_base_t event_base, int32_t event_id,
+                         const void *event_data, size_t event_data_size,
+                         TickType_t ticks_to_wait);
+
+#endif /* ESP_EVENT_H */
@@ -0,0 +1,31 @@
+/**
+ * @file esp_heap_caps.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Heap capabilities, the free size is set by the simulator
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+/**
+ * @brief Get the free heap size, minus the simulated driver buffers.
+ *
+ * @param caps The capabilities of the memory.
+ * @return The free size in bytes.
+ */
+size_t heap_caps_get_free_size(uint32_t caps);
+
+#endif /* ESP_HEAP_CAPS_H */
@@ -0,0 +1,28 @@
+/**
+ * @file esp_idf_version.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Version of the SDK the host build stands for
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_IDF_VERSION_H
+#define ESP_IDF_VERSION_H
+
+#define ESP_IDF_VERSION_MAJOR 5
+#define ESP_IDF_VERSION_MINOR 3
+#define ESP_IDF_VERSION_PATCH 1
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch)                               \
+  (((major) << 16) | ((minor) << 8) | (patch))
+
+#define ESP_IDF_VERSION                                                        \
+  ESP_IDF_VERSION_VAL(ESP_IDF_VERSION_MAJOR, ESP_IDF_VERSION_MINOR,            \
+                      ESP_IDF_VERSION_PATCH)
+
+#endif /* ESP_IDF_VERSION_H */
@@ -0,0 +1,48 @@
+/**
+ * @file esp_netif.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Network interface API of the host build, the DHCP client is
+ * simulated on the virtual clock
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_NETIF_H
+#define ESP_NETIF_H
+
+#include "esp_err.h"
+#include "esp_netif_types.h"
+
+#define ESP_NETIF_INHERENT_DEFAULT_WIFI_STA()                                  \
+  {                                                                            \
+    .flags = 0, .if_key = "WIFI_STA_DEF", .if_desc = "sta", .route_prio = 100, \
+  }
+
+esp_err_t esp_netif_init(void);
+void esp_netif_destroy(esp_netif_t *esp_netif);
+esp_netif_t *esp_netif_get_handle_from_ifkey(const char *if_key);
+esp_err_t esp_netif_dhcpc_start(esp_netif_t *esp_netif);
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t *esp_netif);
+esp_err_t esp_netif_dhcpc_get_status(esp_netif_t *esp_netif,
+                                     esp_netif_dhcp_status_t *status);
+esp_err_t esp_netif_get_ip_info(esp_netif_t *esp_netif,
+                                esp_netif_ip_info_t *ip_info);
+esp_err_t esp_netif_set_ip_info(esp_netif_t *esp_netif,
+                                const esp_netif_ip_info_t *ip_info);
+esp_err_t esp_netif_get_dns_info(esp_netif_t *esp_netif,
+                                 esp_netif_dns_type_t type,
+                                 esp_netif_dns_info_t *dns);
+esp_err_t esp_netif_set_dns_info(esp_netif_t *esp_netif,
+                                 esp_netif_dns_type_t type,
+                                 esp_netif_dns_info_t *dns);
+esp_err_t esp_netif_create_ip6_linklocal(esp_netif_t *esp_netif);
+int esp_netif_get_netif_impl_index(esp_netif_t *esp_netif);
+esp_err_t esp_netif_str_to_ip4(const char *src, esp_ip4_addr_t *dst);
+esp_err_t esp_netif_tcpip_exec(esp_netif_callback_fn fn, void *ctx);
+
+#endif /* ESP_NETIF_H */
@@ -0,0 +1,21 @@
+/**
+ * @file esp_netif_net_stack.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Access to the lwIP interface behind an esp_netif
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_NETIF_NET_STACK_H
+#define ESP_NETIF_NET_STACK_H
+
+#include "esp_netif.h"
+
+void *esp_netif_get_netif_impl(esp_netif_t *esp_netif);
+
+#endif /* ESP_NETIF_NET_STACK_H */
@@ -0,0 +1,122 @@
+/**
+ * @file esp_netif_types.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Network interface types of SDK v5.3 used by the component
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_NETIF_TYPES_H
+#define ESP_NETIF_TYPES_H
+
+#include "esp_event.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+ESP_EVENT_DECLARE_BASE(IP_EVENT);
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct
+{
+  uint32_t addr; /**< Address in network byte order. */
+} esp_ip4_addr_t;
+
+typedef struct
+{
+  uint32_t addr[4]; /**< Address in network byte order. */
+  uint8_t zone;     /**< Zone. */
+} esp_ip6_addr_t;
+
+#define ESP_IPADDR_TYPE_V4 0
+#define ESP_IPADDR_TYPE_V6 6
+
+typedef struct
+{
+  union
+  {
+    esp_ip6_addr_t ip6; /**< IPv6 address. */
+    esp_ip4_addr_t ip4; /**< IPv4 address. */
+  } u_addr;             /**< Address. */
+  uint8_t type;         /**< `ESP_IPADDR_TYPE_V4` or `ESP_IPADDR_TYPE_V6`. */
+} esp_ip_addr_t;
+
+typedef struct
+{
+  esp_ip4_addr_t ip;      /**< Address. */
+  esp_ip4_addr_t netmask; /**< Netmask. */
+  esp_ip4_addr_t gw;      /**< Gateway. */
+} esp_netif_ip_info_t;
+
+typedef enum
+{
+  ESP_NETIF_DNS_MAIN = 0,
+  ESP_NETIF_DNS_BACKUP,
+  ESP_NETIF_DNS_FALLBACK,
+  ESP_NETIF_DNS_MAX,
+} esp_netif_dns_type_t;
+
+typedef struct
+{
+  esp_ip_addr_t ip; /**< Server address. */
+} esp_netif_dns_info_t;
+
+typedef enum
+{
+  ESP_NETIF_DHCP_INIT = 0,
+  ESP_NETIF_DHCP_STARTED,
+  ESP_NETIF_DHCP_STOPPED,
+} esp_netif_dhcp_status_t;
+
+typedef enum
+{
+  IP_EVENT_STA_GOT_IP,
+  IP_EVENT_STA_LOST_IP,
+  IP_EVENT_AP_STAIPASSIGNED,
+  IP_EVENT_GOT_IP6,
+  IP_EVENT_ETH_GOT_IP,
+  IP_EVENT_ETH_LOST_IP,
+  IP_EVENT_PPP_GOT_IP,
+  IP_EVENT_PPP_LOST_IP,
+} ip_event_t;
+
+typedef struct
+{
+  esp_netif_t *esp_netif;      /**< Interface. */
+  esp_netif_ip_info_t ip_info; /**< Address information. */
+  bool ip_changed;             /**< Whether the address changed. */
+} ip_event_got_ip_t;
+
+typedef struct
+{
+  esp_netif_t *esp_netif;  /**< Interface. */
+  esp_ip6_addr_t ip6_info; /**< Address. */
+  int ip_index;            /**< Index of the address. */
+} ip_event_got_ip6_t;
+
+typedef struct
+{
+  int flags;           /**< Not simulated. */
+  const char *if_key;  /**< Key of the interface. */
+  const char *if_desc; /**< Description of the interface. */
+  int route_prio;      /**< Route priority. */
+} esp_netif_inherent_config_t;
+
+typedef esp_err_t (*esp_netif_callback_fn)(void *ctx);
+
+#define IP2STR(ipaddr)                                                         \
+  (int)((ipaddr)->addr & 0xff), (int)(((ipaddr)->addr >> 8) & 0xff),          \
+    (int)(((ipaddr)->addr >> 16) & 0xff), (int)(((ipaddr)->addr >> 24) & 0xff)
+#define IPSTR "%d.%d.%d.%d"
+
+#define ESP_IP4TOADDR(a, b, c, d)                                              \
+  ((uint32_t)(d) << 24 | (uint32_t)(c) << 16 | (uint32_t)(b) << 8 |            \
+   (uint32_t)(a))
+
+#endif /* ESP_NETIF_TYPES_H */
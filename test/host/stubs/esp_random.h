@@ -0,0 +1,26 @@
+/**
+ * @file esp_random.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Random numbers, seeded by the simulator for repeatable runs
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_RANDOM_H
+#define ESP_RANDOM_H
+
+#include <stdint.h>
+
+/**
+ * @brief Get a pseudo-random number from the seed of `sim_seed`.
+ *
+ * @return A random 32-bit value.
+ */
+uint32_t esp_random(void);
+
+#endif /* ESP_RANDOM_H */
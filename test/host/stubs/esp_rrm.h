@@ -0,0 +1,23 @@
+/**
+ * @file esp_rrm.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief 802.11k radio measurement of the supplicant, the report is built
+ * from the simulated access points
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_RRM_H
+#define ESP_RRM_H
+
+#include <stdbool.h>
+
+bool esp_rrm_is_rrm_supported_connection(void);
+int esp_rrm_send_neighbor_report_request(void);
+
+#endif /* ESP_RRM_H */
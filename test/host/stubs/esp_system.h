@@ -0,0 +1,40 @@
+/**
+ * @file esp_system.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief System functions used by the component
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#include "esp_err.h"
+
+/**
+ * @brief Shutdown handler type.
+ */
+typedef void (*shutdown_handler_t)(void);
+
+/**
+ * @brief Register a handler run by `sim_restart`.
+ *
+ * @param handle The handler.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if already registered.
+ */
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle);
+
+/**
+ * @brief Unregister a shutdown handler.
+ *
+ * @param handle The handler.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not registered.
+ */
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handle);
+
+#endif /* ESP_SYSTEM_H */
@@ -0,0 +1,68 @@
+/**
+ * @file esp_timer.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief High resolution timers, driven by the virtual clock
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include "esp_err.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Opaque timer handle.
+ */
+typedef struct esp_timer *esp_timer_handle_t;
+
+/**
+ * @brief Timer callback type.
+ */
+typedef void (*esp_timer_cb_t)(void *arg);
+
+/**
+ * @brief Dispatch method of the callbacks, only the task is simulated.
+ */
+typedef enum
+{
+  ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+/**
+ * @brief Timer configuration.
+ */
+typedef struct
+{
+  esp_timer_cb_t callback;              /**< Callback. */
+  void *arg;                            /**< Argument of the callback. */
+  esp_timer_dispatch_t dispatch_method; /**< Dispatch method. */
+  const char *name;                     /**< Name, for debugging. */
+  bool skip_unhandled_events;           /**< Not simulated. */
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args,
+                           esp_timer_handle_t *out_handle);
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer,
+                                   uint64_t period);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+bool esp_timer_is_active(esp_timer_handle_t timer);
+
+/**
+ * @brief Get the virtual time.
+ *
+ * @return Microseconds since the simulation started.
+ */
+int64_t esp_timer_get_time(void);
+
+#endif /* ESP_TIMER_H */
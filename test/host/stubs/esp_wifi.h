@@ -0,0 +1,85 @@
+/**
+ * @file esp_wifi.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi driver API of the host build, backed by the simulated
+ * access points of `sim.h`
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_WIFI_H
+#define ESP_WIFI_H
+
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_system.h"
+#include "esp_wifi_types.h"
+
+/**
+ * @brief Driver initialization configuration, the buffer fields only.
+ */
+typedef struct
+{
+  int static_rx_buf_num;  /**< Static RX buffers. */
+  int dynamic_rx_buf_num; /**< Dynamic RX buffers. */
+  int tx_buf_type;        /**< 0 static, 1 dynamic TX buffers. */
+  int static_tx_buf_num;  /**< Static TX buffers. */
+  int dynamic_tx_buf_num; /**< Dynamic TX buffers. */
+  int cache_tx_buf_num;   /**< TX buffers cached in PSRAM. */
+  int ampdu_rx_enable;    /**< AMPDU RX. */
+  int ampdu_tx_enable;    /**< AMPDU TX. */
+  int rx_ba_win;          /**< Block ack window. */
+} wifi_init_config_t;
+
+#define WIFI_INIT_CONFIG_DEFAULT()                                             \
+  {                                                                            \
+    .static_rx_buf_num = CONFIG_ESP_WIFI_STATIC_RX_BUFFER_NUM,                 \
+    .dynamic_rx_buf_num = CONFIG_ESP_WIFI_DYNAMIC_RX_BUFFER_NUM,               \
+    .tx_buf_type = 1, .static_tx_buf_num = 0,                                  \
+    .dynamic_tx_buf_num = CONFIG_ESP_WIFI_DYNAMIC_TX_BUFFER_NUM,               \
+    .cache_tx_buf_num = 0, .ampdu_rx_enable = 1, .ampdu_tx_enable = 1,         \
+    .rx_ba_win = 6,                                                            \
+  }
+
+esp_err_t esp_wifi_init(const wifi_init_config_t *config);
+esp_err_t esp_wifi_deinit(void);
+esp_err_t esp_wifi_set_mode(wifi_mode_t mode);
+esp_err_t esp_wifi_set_storage(wifi_storage_t storage);
+esp_err_t esp_wifi_start(void);
+esp_err_t esp_wifi_stop(void);
+esp_err_t esp_wifi_connect(void);
+esp_err_t esp_wifi_disconnect(void);
+esp_err_t esp_wifi_set_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t *conf);
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *config, bool block);
+esp_err_t esp_wifi_scan_stop(void);
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *number);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *number,
+                                       wifi_ap_record_t *ap_records);
+esp_err_t esp_wifi_scan_get_ap_record(wifi_ap_record_t *ap_record);
+esp_err_t esp_wifi_clear_ap_list(void);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info);
+esp_err_t esp_wifi_sta_get_rssi(int *rssi);
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t type);
+esp_err_t esp_wifi_set_rssi_threshold(int32_t rssi);
+
+/**
+ * @brief Attach the station interface to the driver and register the
+ * default handlers, the simulated driver drives it directly.
+ *
+ * @param wifi_if The interface.
+ * @param config The interface configuration.
+ * @return The interface, NULL if out of memory.
+ */
+esp_netif_t *esp_netif_create_wifi(wifi_interface_t wifi_if,
+                                   const esp_netif_inherent_config_t *config);
+esp_err_t esp_wifi_set_default_wifi_sta_handlers(void);
+esp_err_t esp_wifi_clear_default_wifi_driver_and_handlers(void *esp_netif);
+
+#endif /* ESP_WIFI_H */
@@ -0,0 +1,302 @@
+/**
+ * @file esp_wifi_types.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi driver types of SDK v5.3 used by the component
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ESP_WIFI_TYPES_H
+#define ESP_WIFI_TYPES_H
+
+#include "esp_event.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+ESP_EVENT_DECLARE_BASE(WIFI_EVENT);
+
+typedef enum
+{
+  WIFI_MODE_NULL = 0,
+  WIFI_MODE_STA,
+  WIFI_MODE_AP,
+  WIFI_MODE_APSTA,
+  WIFI_MODE_MAX,
+} wifi_mode_t;
+
+typedef enum
+{
+  WIFI_IF_STA = 0,
+  WIFI_IF_AP,
+} wifi_interface_t;
+
+#define ESP_IF_WIFI_STA WIFI_IF_STA
+
+typedef enum
+{
+  WIFI_AUTH_OPEN = 0,
+  WIFI_AUTH_WEP,
+  WIFI_AUTH_WPA_PSK,
+  WIFI_AUTH_WPA2_PSK,
+  WIFI_AUTH_WPA_WPA2_PSK,
+  WIFI_AUTH_ENTERPRISE,
+  WIFI_AUTH_WPA2_ENTERPRISE = WIFI_AUTH_ENTERPRISE,
+  WIFI_AUTH_WPA3_PSK,
+  WIFI_AUTH_WPA2_WPA3_PSK,
+  WIFI_AUTH_WAPI_PSK,
+  WIFI_AUTH_OWE,
+  WIFI_AUTH_WPA3_ENT_192,
+  WIFI_AUTH_WPA3_EXT_PSK,
+  WIFI_AUTH_WPA3_EXT_PSK_MIXED_MODE,
+  WIFI_AUTH_DPP,
+  WIFI_AUTH_WPA3_ENTERPRISE,
+  WIFI_AUTH_WPA2_WPA3_ENTERPRISE,
+  WIFI_AUTH_MAX,
+} wifi_auth_mode_t;
+
+typedef enum
+{
+  WIFI_REASON_UNSPECIFIED = 1,
+  WIFI_REASON_AUTH_EXPIRE = 2,
+  WIFI_REASON_AUTH_LEAVE = 3,
+  WIFI_REASON_ASSOC_EXPIRE = 4,
+  WIFI_REASON_ASSOC_TOOMANY = 5,
+  WIFI_REASON_NOT_AUTHED = 6,
+  WIFI_REASON_NOT_ASSOCED = 7,
+  WIFI_REASON_ASSOC_LEAVE = 8,
+  WIFI_REASON_ASSOC_NOT_AUTHED = 9,
+  WIFI_REASON_MIC_FAILURE = 14,
+  WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT = 15,
+  WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT = 16,
+  WIFI_REASON_802_1X_AUTH_FAILED = 23,
+  WIFI_REASON_BEACON_TIMEOUT = 200,
+  WIFI_REASON_NO_AP_FOUND = 201,
+  WIFI_REASON_AUTH_FAIL = 202,
+  WIFI_REASON_ASSOC_FAIL = 203,
+  WIFI_REASON_HANDSHAKE_TIMEOUT = 204,
+  WIFI_REASON_CONNECTION_FAIL = 205,
+  WIFI_REASON_AP_TSF_RESET = 206,
+  WIFI_REASON_ROAMING = 207,
+  WIFI_REASON_ASSOC_COMEBACK_TIME_TOO_LONG = 208,
+  WIFI_REASON_SA_QUERY_TIMEOUT = 209,
+  WIFI_REASON_NO_AP_FOUND_W_COMPATIBLE_SECURITY = 210,
+  WIFI_REASON_NO_AP_FOUND_IN_AUTHMODE_THRESHOLD = 211,
+  WIFI_REASON_NO_AP_FOUND_IN_RSSI_THRESHOLD = 212,
+} wifi_err_reason_t;
+
+typedef enum
+{
+  WIFI_SECOND_CHAN_NONE = 0,
+  WIFI_SECOND_CHAN_ABOVE,
+  WIFI_SECOND_CHAN_BELOW,
+} wifi_second_chan_t;
+
+typedef enum
+{
+  WIFI_SCAN_TYPE_ACTIVE = 0,
+  WIFI_SCAN_TYPE_PASSIVE,
+} wifi_scan_type_t;
+
+typedef struct
+{
+  uint32_t min; /**< Minimum active dwell per channel, ms. */
+  uint32_t max; /**< Maximum active dwell per channel, ms. */
+} wifi_active_scan_time_t;
+
+typedef struct
+{
+  wifi_active_scan_time_t active; /**< Active scan dwell. */
+  uint32_t passive;               /**< Passive dwell per channel, ms. */
+} wifi_scan_time_t;
+
+typedef struct
+{
+  uint8_t *ssid;              /**< SSID filter, NULL for any. */
+  uint8_t *bssid;             /**< BSSID filter, NULL for any. */
+  uint8_t channel;            /**< Channel, 0 for all. */
+  bool show_hidden;           /**< Report hidden APs. */
+  wifi_scan_type_t scan_type; /**< Active or passive. */
+  wifi_scan_time_t scan_time; /**< Dwell per channel. */
+  uint8_t home_chan_dwell_time; /**< Not simulated. */
+} wifi_scan_config_t;
+
+typedef enum
+{
+  WIFI_CIPHER_TYPE_NONE = 0,
+  WIFI_CIPHER_TYPE_CCMP = 4,
+} wifi_cipher_type_t;
+
+typedef struct
+{
+  uint8_t bssid[6];                   /**< MAC address of the AP. */
+  uint8_t ssid[33];                   /**< SSID of the AP. */
+  uint8_t primary;                    /**< Primary channel. */
+  wifi_second_chan_t second;          /**< Secondary channel. */
+  int8_t rssi;                        /**< Signal strength. */
+  wifi_auth_mode_t authmode;          /**< Authentication mode. */
+  wifi_cipher_type_t pairwise_cipher; /**< Pairwise cipher. */
+  wifi_cipher_type_t group_cipher;    /**< Group cipher. */
+  uint32_t phy_11b : 1;               /**< 802.11b. */
+  uint32_t phy_11g : 1;               /**< 802.11g. */
+  uint32_t phy_11n : 1;               /**< 802.11n. */
+  uint32_t reserved : 29;             /**< Reserved. */
+} wifi_ap_record_t;
+
+typedef enum
+{
+  WIFI_FAST_SCAN = 0,
+  WIFI_ALL_CHANNEL_SCAN,
+} wifi_scan_method_t;
+
+typedef enum
+{
+  WIFI_CONNECT_AP_BY_SIGNAL = 0,
+  WIFI_CONNECT_AP_BY_SECURITY,
+} wifi_sort_method_t;
+
+typedef struct
+{
+  int8_t rssi;               /**< Minimum RSSI. */
+  wifi_auth_mode_t authmode; /**< Weakest accepted authentication mode. */
+} wifi_scan_threshold_t;
+
+typedef struct
+{
+  bool capable;  /**< PMF capable. */
+  bool required; /**< PMF required. */
+} wifi_pmf_config_t;
+
+typedef struct
+{
+  uint8_t ssid[32];                /**< SSID of the network. */
+  uint8_t password[64];            /**< Password of the network. */
+  wifi_scan_method_t scan_method;  /**< Fast or all-channel scan. */
+  bool bssid_set;                  /**< Connect to `bssid` only. */
+  uint8_t bssid[6];                /**< MAC address of the target AP. */
+  uint8_t channel;                 /**< Channel of the target AP, 0 unknown. */
+  uint16_t listen_interval;        /**< Beacon intervals between wakes. */
+  wifi_sort_method_t sort_method;  /**< AP selection. */
+  wifi_scan_threshold_t threshold; /**< Minimum RSSI and authentication. */
+  wifi_pmf_config_t pmf_cfg;       /**< Protected management frames. */
+  uint32_t rm_enabled : 1;         /**< 802.11k radio measurement. */
+  uint32_t btm_enabled : 1;        /**< 802.11v BSS transition. */
+  uint32_t mbo_enabled : 1;        /**< Multi band operation. */
+  uint32_t ft_enabled : 1;         /**< 802.11r fast transition. */
+  uint32_t owe_enabled : 1;        /**< Opportunistic wireless encryption. */
+  uint32_t reserved : 27;          /**< Reserved. */
+} wifi_sta_config_t;
+
+typedef union
+{
+  wifi_sta_config_t sta; /**< Station configuration. */
+} wifi_config_t;
+
+typedef enum
+{
+  WIFI_PS_NONE,
+  WIFI_PS_MIN_MODEM,
+  WIFI_PS_MAX_MODEM,
+} wifi_ps_type_t;
+
+typedef enum
+{
+  WIFI_STORAGE_FLASH,
+  WIFI_STORAGE_RAM,
+} wifi_storage_t;
+
+typedef enum
+{
+  WIFI_EVENT_WIFI_READY = 0,
+  WIFI_EVENT_SCAN_DONE,
+  WIFI_EVENT_STA_START,
+  WIFI_EVENT_STA_STOP,
+  WIFI_EVENT_STA_CONNECTED,
+  WIFI_EVENT_STA_DISCONNECTED,
+  WIFI_EVENT_STA_AUTHMODE_CHANGE,
+  WIFI_EVENT_STA_WPS_ER_SUCCESS,
+  WIFI_EVENT_STA_WPS_ER_FAILED,
+  WIFI_EVENT_STA_WPS_ER_TIMEOUT,
+  WIFI_EVENT_STA_WPS_ER_PIN,
+  WIFI_EVENT_STA_WPS_ER_PBC_OVERLAP,
+  WIFI_EVENT_AP_START,
+  WIFI_EVENT_AP_STOP,
+  WIFI_EVENT_AP_STACONNECTED,
+  WIFI_EVENT_AP_STADISCONNECTED,
+  WIFI_EVENT_AP_PROBEREQRECVED,
+  WIFI_EVENT_FTM_REPORT,
+  WIFI_EVENT_STA_BSS_RSSI_LOW,
+  WIFI_EVENT_ACTION_TX_STATUS,
+  WIFI_EVENT_ROC_DONE,
+  WIFI_EVENT_STA_BEACON_TIMEOUT,
+  WIFI_EVENT_CONNECTIONLESS_MODULE_WAKE_INTERVAL_START,
+  WIFI_EVENT_AP_WPS_RG_SUCCESS,
+  WIFI_EVENT_AP_WPS_RG_FAILED,
+  WIFI_EVENT_AP_WPS_RG_TIMEOUT,
+  WIFI_EVENT_AP_WPS_RG_PIN,
+  WIFI_EVENT_AP_WPS_RG_PBC_OVERLAP,
+  WIFI_EVENT_ITWT_SETUP,
+  WIFI_EVENT_ITWT_TEARDOWN,
+  WIFI_EVENT_ITWT_PROBE,
+  WIFI_EVENT_ITWT_SUSPEND,
+  WIFI_EVENT_TWT_WAKEUP,
+  WIFI_EVENT_BTWT_SETUP,
+  WIFI_EVENT_BTWT_TEARDOWN,
+  WIFI_EVENT_NAN_STARTED,
+  WIFI_EVENT_NAN_STOPPED,
+  WIFI_EVENT_NAN_SVC_MATCH,
+  WIFI_EVENT_NAN_REPLIED,
+  WIFI_EVENT_NAN_RECEIVE,
+  WIFI_EVENT_NDP_INDICATION,
+  WIFI_EVENT_NDP_CONFIRM,
+  WIFI_EVENT_NDP_TERMINATED,
+  WIFI_EVENT_HOME_CHANNEL_CHANGE,
+  WIFI_EVENT_STA_NEIGHBOR_REP,
+  WIFI_EVENT_MAX,
+} wifi_event_t;
+
+typedef struct
+{
+  uint32_t status; /**< 0 on success. */
+  uint8_t number;  /**< Number of APs found. */
+  uint8_t scan_id; /**< Scan sequence number. */
+} wifi_event_sta_scan_done_t;
+
+typedef struct
+{
+  uint8_t ssid[32];          /**< SSID of the AP. */
+  uint8_t ssid_len;          /**< Length of the SSID. */
+  uint8_t bssid[6];          /**< MAC address of the AP. */
+  uint8_t channel;           /**< Channel of the AP. */
+  wifi_auth_mode_t authmode; /**< Authentication mode. */
+  uint16_t aid;              /**< Association identifier. */
+} wifi_event_sta_connected_t;
+
+typedef struct
+{
+  uint8_t ssid[32]; /**< SSID of the AP. */
+  uint8_t ssid_len; /**< Length of the SSID. */
+  uint8_t bssid[6]; /**< MAC address of the AP. */
+  uint8_t reason;   /**< Disconnect reason. */
+  int8_t rssi;      /**< Last RSSI of the AP. */
+} wifi_event_sta_disconnected_t;
+
+typedef struct
+{
+  int32_t rssi; /**< RSSI that crossed the threshold. */
+} wifi_event_bss_rssi_low_t;
+
+#define ESP_WIFI_MAX_NEIGHBOR_REP_LEN 1264
+
+typedef struct
+{
+  uint8_t report[ESP_WIFI_MAX_NEIGHBOR_REP_LEN]; /**< Neighbor elements. */
+  uint16_t report_len;                           /**< Length of `report`. */
+} wifi_event_neighbor_report_t;
+
+#endif /* ESP_WIFI_TYPES_H */
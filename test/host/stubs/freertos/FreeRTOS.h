@@ -0,0 +1,69 @@
+/**
+ * @file FreeRTOS.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief FreeRTOS types of the host build, the tasks are cooperative
+ * coroutines scheduled on the virtual clock
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include "sdkconfig.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t StackType_t;
+typedef uint64_t configRUN_TIME_COUNTER_TYPE;
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+#define configTICK_RATE_HZ CONFIG_FREERTOS_HZ
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)                                                      \
+  ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000U))
+#define portNUM_PROCESSORS 1
+
+/**
+ * @brief Spinlock type, critical sections are empty as the tasks never
+ * preempt each other.
+ */
+typedef struct
+{
+  int owner; /**< Unused. */
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define taskENTER_CRITICAL(mux) ((void)(mux))
+#define taskEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+/**
+ * @brief Storage of the statically allocated queues, semaphores and event
+ * groups, large enough for the simulated objects.
+ */
+typedef struct
+{
+  void *storage[16]; /**< Opaque. */
+} StaticQueue_t;
+
+typedef StaticQueue_t StaticSemaphore_t;
+typedef StaticQueue_t StaticEventGroup_t;
+
+#endif /* FREERTOS_H */
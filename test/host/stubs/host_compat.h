@@ -0,0 +1,32 @@
+/**
+ * @file host_compat.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Included before every source of the host build, provides what the
+ * newlib of the SDK has and glibc lacks
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef HOST_COMPAT_H
+#define HOST_COMPAT_H
+
+#include "sdkconfig.h"
+
+#include <stddef.h>
+
+/**
+ * @brief Copy a string with truncation, as BSD `strlcpy`.
+ *
+ * @param dst The destination buffer.
+ * @param src The string to copy.
+ * @param size Capacity of `dst`.
+ * @return The length of `src`.
+ */
+size_t strlcpy(char *dst, const char *src, size_t size);
+
+#endif /* HOST_COMPAT_H */
@@ -0,0 +1,19 @@
+/**
+ * @file dhcp.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief lwIP DHCP client state of the host build
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef LWIP_DHCP_H
+#define LWIP_DHCP_H
+
+#include "lwip/netif.h"
+
+#endif /* LWIP_DHCP_H */
@@ -0,0 +1,51 @@
+/**
+ * @file netif.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief lwIP interface of the host build, the hooks the power governor
+ * wraps and the DHCP state of the lease cache
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef LWIP_NETIF_H
+#define LWIP_NETIF_H
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+
+#define ERR_OK 0
+
+struct pbuf;
+struct netif;
+
+typedef err_t (*netif_input_fn)(struct pbuf *p, struct netif *inp);
+typedef err_t (*netif_linkoutput_fn)(struct netif *netif, struct pbuf *p);
+
+/**
+ * @brief State of the DHCP client.
+ */
+struct dhcp
+{
+  uint32_t offered_t0_lease; /**< Lease time offered by the server, s. */
+};
+
+/**
+ * @brief lwIP interface.
+ */
+struct netif
+{
+  netif_input_fn input;           /**< Receive hook. */
+  netif_linkoutput_fn linkoutput; /**< Transmit hook. */
+  struct dhcp *dhcp;              /**< DHCP client, NULL if never started. */
+  uint8_t num;                    /**< Interface index. */
+};
+
+#define netif_dhcp_data(netif) ((netif)->dhcp)
+
+#endif /* LWIP_NETIF_H */
@@ -0,0 +1,107 @@
+/**
+ * @file ping_sock.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief ICMP echo sessions of the host build, answered by the gateway of
+ * the simulated access point
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef PING_SOCK_H
+#define PING_SOCK_H
+
+#include "esp_err.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief lwIP address, IPv4 only.
+ */
+typedef struct
+{
+  union
+  {
+    struct
+    {
+      uint32_t addr; /**< Address in network byte order. */
+    } ip4;           /**< IPv4 address. */
+  } u_addr;          /**< Address. */
+  uint8_t type;      /**< Address type. */
+} ip_addr_t;
+
+#define IPADDR_TYPE_V4 0
+
+#define ip_addr_set_ip4_u32(ipaddr, value)                                     \
+  do                                                                           \
+  {                                                                            \
+    (ipaddr)->u_addr.ip4.addr = (value);                                       \
+    (ipaddr)->type = IPADDR_TYPE_V4;                                           \
+  } while (0)
+
+typedef void *esp_ping_handle_t;
+
+/**
+ * @brief Callbacks of a session, run on the ping task.
+ */
+typedef struct
+{
+  void *cb_args;                                           /**< Argument. */
+  void (*on_ping_success)(esp_ping_handle_t hdl, void *args); /**< Reply. */
+  void (*on_ping_timeout)(esp_ping_handle_t hdl, void *args); /**< Lost. */
+  void (*on_ping_end)(esp_ping_handle_t hdl, void *args);     /**< End. */
+} esp_ping_callbacks_t;
+
+/**
+ * @brief Session configuration.
+ */
+typedef struct
+{
+  uint32_t count;           /**< Echo requests to send. */
+  uint32_t interval_ms;     /**< Time between requests. */
+  uint32_t timeout_ms;      /**< Time to wait for each reply. */
+  uint32_t data_size;       /**< Payload size. */
+  int tos;                  /**< Type of service. */
+  int ttl;                  /**< Time to live. */
+  ip_addr_t target_addr;    /**< Target address. */
+  uint32_t task_stack_size; /**< Stack size of the ping task. */
+  uint32_t task_prio;       /**< Priority of the ping task. */
+  uint32_t interface;       /**< Interface index, 0 for any. */
+} esp_ping_config_t;
+
+#define ESP_PING_DEFAULT_CONFIG()                                              \
+  {                                                                            \
+    .count = 5, .interval_ms = 1000, .timeout_ms = 1000, .data_size = 64,      \
+    .tos = 0, .ttl = 64, .target_addr = {{{0}}, 0}, .task_stack_size = 2048,   \
+    .task_prio = 2, .interface = 0,                                            \
+  }
+
+typedef enum
+{
+  ESP_PING_PROF_SEQNO,
+  ESP_PING_PROF_TOS,
+  ESP_PING_PROF_TTL,
+  ESP_PING_PROF_REQUEST,
+  ESP_PING_PROF_REPLY,
+  ESP_PING_PROF_IPADDR,
+  ESP_PING_PROF_SIZE,
+  ESP_PING_PROF_TIMEGAP,
+  ESP_PING_PROF_DURATION,
+} esp_ping_profile_t;
+
+esp_err_t esp_ping_new_session(const esp_ping_config_t *config,
+                               const esp_ping_callbacks_t *cbs,
+                               esp_ping_handle_t *hdl_out);
+esp_err_t esp_ping_delete_session(esp_ping_handle_t hdl);
+esp_err_t esp_ping_start(esp_ping_handle_t hdl);
+esp_err_t esp_ping_stop(esp_ping_handle_t hdl);
+esp_err_t esp_ping_get_profile(esp_ping_handle_t hdl,
+                               esp_ping_profile_t profile, void *data,
+                               uint32_t size);
+
+#endif /* PING_SOCK_H */
@@ -0,0 +1,50 @@
+/**
+ * @file sdkconfig.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Configuration of the host build, the Kconfig defaults of the
+ * component and the SDK options it depends on
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+#define CONFIG_WIFI_API_TASK_STACK_SIZE 4096
+#define CONFIG_WIFI_API_TASK_PRIORITY 5
+#define CONFIG_WIFI_API_TASK_CORE_ID -1
+#define CONFIG_WIFI_API_QUEUE_LENGTH 8
+#define CONFIG_WIFI_API_MAX_SUBSCRIBERS 4
+#define CONFIG_WIFI_API_EVENT_QUEUE_LENGTH 8
+#define CONFIG_WIFI_API_TRACE 1
+#define CONFIG_WIFI_API_TRACE_SIZE 64
+#define CONFIG_WIFI_API_MAX_PROFILES 4
+#define CONFIG_WIFI_API_11K 1
+#define CONFIG_WIFI_API_11V 1
+#define CONFIG_WIFI_API_11R 1
+#define CONFIG_WIFI_API_STORE_PARTITION "nvs"
+#define CONFIG_WIFI_API_DRIVER_PROFILE_BALANCED 1
+#define CONFIG_WIFI_API_STATIC_RX_BUF_NUM 0
+#define CONFIG_WIFI_API_DYNAMIC_RX_BUF_NUM 0
+#define CONFIG_WIFI_API_DYNAMIC_TX_BUF_NUM 0
+#define CONFIG_WIFI_API_CACHE_TX_BUF_NUM 0
+#define CONFIG_WIFI_API_RX_BA_WIN 0
+
+#define CONFIG_ESP_WIFI_11KV_SUPPORT 1
+#define CONFIG_ESP_WIFI_11R_SUPPORT 1
+#define CONFIG_ESP_WIFI_STATIC_RX_BUFFER_NUM 10
+#define CONFIG_ESP_WIFI_DYNAMIC_RX_BUFFER_NUM 32
+#define CONFIG_ESP_WIFI_DYNAMIC_TX_BUFFER_NUM 32
+#define CONFIG_FREERTOS_HZ 1000
+
+// The sockets library is built as on the `linux` target of the SDK
+#ifndef CONFIG_IDF_TARGET_LINUX
+#define CONFIG_IDF_TARGET_LINUX 0
+#endif
+
+#endif /* SDKCONFIG_H */
@@ -0,0 +1,218 @@
+/**
+ * @file test_backoff.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Reconnection delays of a station, and spread of the reconnections
+ * of many stations after an AP reboot
+ *
+ * Every station is simulated in turn with its own `esp_random` seed, against
+ * the same outage of the AP.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+
+/**
+ * @brief Number of simulated stations.
+ */
+#define STATIONS 32
+
+/**
+ * @brief Time the AP stays down after the stations noticed it.
+ */
+#define OUTAGE_MS 20000
+
+/**
+ * @brief Width of the histogram buckets.
+ */
+#define BUCKET_MS 500
+
+/**
+ * @brief Maximum number of disconnections recorded.
+ */
+#define MAX_DISCONNECTS 64
+
+/**
+ * @brief Result of a station.
+ */
+typedef struct
+{
+  double reconnect_ms; /**< AP back up to the new address. */
+  uint32_t attempts;   /**< Connection attempts during the outage. */
+} station_t;
+
+/**
+ * @brief A disconnection reported by the driver.
+ */
+typedef struct
+{
+  int64_t time_us; /**< Virtual time of the event. */
+  uint32_t dwelt;  /**< Channels dwelt on up to the event. */
+} disconnect_t;
+
+/**
+ * @brief Disconnections recorded by `record_disconnect`.
+ */
+static disconnect_t s_disconnects[MAX_DISCONNECTS];
+
+/**
+ * @brief Number of disconnections recorded.
+ */
+static int s_disconnect_count = 0;
+
+/**
+ * @brief Record a failed attempt, the beacon timeout that started them is
+ * retried at once.
+ *
+ * @param arg Unused.
+ * @param event_base Unused.
+ * @param event_id Unused.
+ * @param event_data The `wifi_event_sta_disconnected_t`.
+ */
+static void record_disconnect(void *arg, esp_event_base_t event_base,
+                              int32_t event_id, void *event_data)
+{
+  wifi_event_sta_disconnected_t *event = event_data;
+  if (event->reason != WIFI_REASON_NO_AP_FOUND ||
+      s_disconnect_count == MAX_DISCONNECTS)
+    return;
+  disconnect_t *disconnect = &s_disconnects[s_disconnect_count++];
+  disconnect->time_us = sim_now_us();
+  disconnect->dwelt = sim_stats().scanned_channels;
+}
+
+/**
+ * @brief Each delay before a reconnection is drawn between the base delay
+ * and three times the previous one, capped at the maximum.
+ */
+static void test_backoff_bounds(void *arg)
+{
+  int ap = test_ap("home", 1, 6, -50);
+  wifi_api_retry_config_t retry = {
+    .base_delay_ms = 250, .max_delay_ms = 4000, .max_retry = 10};
+  CHECK_OK(wifi_api_set_retry_config(&retry));
+  CHECK_OK(wifi_api_configure("home", "password"));
+
+  s_disconnect_count = 0;
+  CHECK_OK(esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                                      &record_disconnect, NULL));
+  sim_ap_set_up(ap, false);
+  sim_sleep_ms(sim_get_timing().beacon_timeout_ms + 60000);
+  esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                               &record_disconnect);
+  CHECK(s_disconnect_count > 10);
+
+  // Between two failures, the delay then the scan of the attempt
+  uint32_t dwell_ms = sim_get_timing().active_dwell_ms;
+  uint32_t previous = retry.base_delay_ms, longest = 0;
+  bool jitter = false;
+  for (int i = 1; i < s_disconnect_count; i++)
+  {
+    const disconnect_t *last = &s_disconnects[i - 1], *next = &s_disconnects[i];
+    uint32_t delay = (next->time_us - last->time_us) / 1000 -
+                     (next->dwelt - last->dwelt) * dwell_ms;
+    uint32_t upper = previous * 3;
+    if (upper > retry.max_delay_ms)
+      upper = retry.max_delay_ms;
+    CHECK(delay >= retry.base_delay_ms && delay <= upper);
+    if (delay != previous)
+      jitter = true;
+    if (delay > longest)
+      longest = delay;
+    previous = delay;
+  }
+  CHECK(jitter);
+  CHECK(longest > retry.max_delay_ms / 2);
+
+  wifi_api_retry_config_t defaults = WIFI_API_RETRY_CONFIG_DEFAULT();
+  wifi_api_set_retry_config(&defaults);
+  test_disconnect();
+}
+
+/**
+ * @brief Reboot the AP of a connected station and time its reconnection.
+ *
+ * @param arg The result of the station.
+ */
+static void station_run(void *arg)
+{
+  station_t *station = arg;
+  int ap = test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+
+  sim_ap_set_up(ap, false);
+  sim_sleep_ms(sim_get_timing().beacon_timeout_ms);
+  sim_reset_stats();
+  sim_sleep_ms(OUTAGE_MS);
+  station->attempts = sim_stats().connects;
+
+  sim_ap_set_up(ap, true);
+  int64_t start = sim_now_us();
+  CHECK(test_wait_got_ip(120000));
+  station->reconnect_ms = test_elapsed_ms(start);
+  test_disconnect();
+}
+
+/**
+ * @brief The stations neither come back in a burst nor poll the missing AP.
+ */
+static void test_backoff_spread()
+{
+  int failures = s_test_failures;
+  station_t stations[STATIONS] = {0};
+  for (int i = 0; i < STATIONS; i++)
+  {
+    sim_reset(i + 1);
+    sim_nvs_erase();
+    sim_run(&station_run, &stations[i]);
+  }
+
+  double min_ms = stations[0].reconnect_ms, max_ms = min_ms;
+  uint32_t max_attempts = 0;
+  uint32_t buckets[120000 / BUCKET_MS + 1] = {0};
+  for (int i = 0; i < STATIONS; i++)
+  {
+    double ms = stations[i].reconnect_ms;
+    if (ms < min_ms)
+      min_ms = ms;
+    if (ms > max_ms)
+      max_ms = ms;
+    if (stations[i].attempts > max_attempts)
+      max_attempts = stations[i].attempts;
+    buckets[(int)ms / BUCKET_MS]++;
+  }
+
+  printf("  %d stations reconnected within %.1f to %.1f ms, at most %u "
+         "attempts in %d ms\n",
+         STATIONS, min_ms, max_ms, (unsigned)max_attempts, OUTAGE_MS);
+  uint32_t crowded = 0;
+  for (size_t i = 0; i < sizeof(buckets) / sizeof(buckets[0]); i++)
+  {
+    if (buckets[i] == 0)
+      continue;
+    printf("  %6zu ms %3u ", i * BUCKET_MS, (unsigned)buckets[i]);
+    for (uint32_t j = 0; j < buckets[i]; j++)
+      putchar('#');
+    putchar('\n');
+    if (buckets[i] > crowded)
+      crowded = buckets[i];
+  }
+
+  CHECK(max_ms - min_ms >= 5 * BUCKET_MS);
+  CHECK(crowded <= STATIONS / 4);
+  CHECK(max_attempts <= 10);
+  printf("%-40s %s\n", "backoff_spread",
+         s_test_failures == failures ? "ok" : "FAILED");
+}
+
+int main()
+{
+  test_run("backoff_bounds", &test_backoff_bounds);
+  test_backoff_spread();
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,419 @@
+/**
+ * @file test_connect.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Connection, reconnection and failure paths against the simulated
+ * driver
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+
+#include <freertos/task.h>
+
+/**
+ * @brief A connection gets an address from the AP and a disconnection
+ * releases it.
+ */
+static void test_connect_disconnect(void *arg)
+{
+  int ap = test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(sim_connected_ap() == ap);
+  CHECK(sim_stats().dhcp_exchanges == 1);
+
+  test_disconnect();
+  CHECK(sim_connected_ap() < 0);
+}
+
+/**
+ * @brief A reconnection joins the cached AP on its channel, faster than a
+ * connection scanning every channel, also after NVS was erased.
+ */
+static void test_cached_ap(void *arg)
+{
+  int ap = test_ap("home", 1, 11, -50);
+
+  sim_reset_stats();
+  int64_t start = sim_now_us();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  double cold_ms = test_elapsed_ms(start);
+  sim_stats_t cold = sim_stats();
+  CHECK(cold.nvs_writes > 0);
+  test_disconnect();
+
+  sim_reset_stats();
+  start = sim_now_us();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  double cached_ms = test_elapsed_ms(start);
+  sim_stats_t cached = sim_stats();
+  CHECK(sim_connected_ap() == ap);
+  CHECK(cached.connects == 1);
+  CHECK(cached.scanned_channels == 1);
+  CHECK(cached.scanned_channels < cold.scanned_channels);
+  CHECK(cached.nvs_writes == 0);
+  CHECK(cached_ms < cold_ms);
+  test_disconnect();
+  printf("  connect: %.1f ms scanning %u channels, %.1f ms cached\n", cold_ms,
+         (unsigned)cold.scanned_channels, cached_ms);
+
+  // The AP is cached again on a device whose NVS was erased
+  sim_nvs_erase();
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(sim_stats().nvs_writes > 0);
+  test_disconnect();
+}
+
+/**
+ * @brief A cached AP that is gone makes the directed attempt fail, the
+ * connection falls back to a scan of every channel without using a retry.
+ */
+static void test_cached_ap_gone(void *arg)
+{
+  int old = test_ap("home", 1, 11, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+  test_disconnect();
+
+  sim_ap_set_up(old, false);
+  int ap = test_ap("home", 2, 6, -50);
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(sim_connected_ap() == ap);
+  CHECK(sim_stats().connects == 2);
+  // The directed attempt, then the fast scan up to the channel of the new AP
+  CHECK(sim_stats().scanned_channels == 1 + 6);
+  test_disconnect();
+
+  // The new AP replaced the cached one
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(sim_stats().connects == 1 && sim_stats().scanned_channels == 1);
+  test_disconnect();
+}
+
+/**
+ * @brief A directed attempt cut short by a disconnection does not make the
+ * next connection, to another network, take its failure for a stale cache.
+ */
+static void test_cached_ap_aborted(void *arg)
+{
+  test_ap("home", 1, 11, -50);
+  test_ap("lab", 2, 6, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+  test_disconnect();
+
+  // Disconnected during the directed attempt to the cached AP
+  CHECK_OK(wifi_api_configure_async("home", "password", 0, NULL, NULL));
+  sim_sleep_ms(10);
+  test_disconnect();
+
+  wifi_api_retry_config_t retry = {
+    .base_delay_ms = 100, .max_delay_ms = 200, .max_retry = 1};
+  CHECK_OK(wifi_api_set_retry_config(&retry));
+  CHECK(wifi_api_configure("lab", "wrong") == ESP_FAIL);
+  test_disconnect();
+  wifi_api_retry_config_t defaults = WIFI_API_RETRY_CONFIG_DEFAULT();
+  wifi_api_set_retry_config(&defaults);
+
+  // The AP of the first network is still cached
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(sim_stats().connects == 1 && sim_stats().scanned_channels == 1);
+  test_disconnect();
+}
+
+/**
+ * @brief Among profiles, the cached AP is joined without a scan only when no
+ * profile is preferred to it, so a preferred network in range is found.
+ */
+static void test_profiles_cached_ap(void *arg)
+{
+  wifi_api_profile_t home = {.ssid = "home", .password = "password",
+                             .priority = 1};
+  wifi_api_profile_t office = {.ssid = "office", .password = "password",
+                               .priority = 2};
+  int ap = test_ap("home", 1, 11, -50);
+  CHECK_OK(wifi_api_add_profile(&home));
+  CHECK_OK(wifi_api_configure_profiles(0));
+  test_disconnect();
+
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure_profiles(0));
+  CHECK(sim_connected_ap() == ap);
+  CHECK(sim_stats().scanned_channels == 1);
+  test_disconnect();
+
+  // A preferred profile whose AP came in range
+  CHECK_OK(wifi_api_add_profile(&office));
+  int preferred = test_ap("office", 2, 6, -60);
+  CHECK_OK(wifi_api_configure_profiles(0));
+  CHECK(sim_connected_ap() == preferred);
+  test_disconnect();
+
+  CHECK_OK(wifi_api_remove_profile("office"));
+  CHECK(wifi_api_remove_profile("office") == ESP_ERR_NOT_FOUND);
+  CHECK_OK(wifi_api_remove_profile("home"));
+  CHECK(wifi_api_get_profile_count() == 0);
+}
+
+/**
+ * @brief A wrong password fails after the retries without an association.
+ */
+static void test_wrong_password(void *arg)
+{
+  test_ap("home", 1, 6, -50);
+  wifi_api_retry_config_t retry = {
+    .base_delay_ms = 100, .max_delay_ms = 200, .max_retry = 3};
+  CHECK_OK(wifi_api_set_retry_config(&retry));
+
+  CHECK(wifi_api_configure("home", "wrong") == ESP_FAIL);
+  CHECK(sim_connected_ap() < 0);
+  CHECK(wifi_api_get_disconnect_count(WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT) >
+        0);
+  CHECK(sim_stats().associations == 0);
+  test_disconnect();
+  wifi_api_reset_disconnect_counts();
+  wifi_api_retry_config_t defaults = WIFI_API_RETRY_CONFIG_DEFAULT();
+  wifi_api_set_retry_config(&defaults);
+}
+
+/**
+ * @brief Results reported by `record_result`.
+ */
+typedef struct
+{
+  int count;                 /**< Number of results. */
+  wifi_api_result_t result;  /**< The last result. */
+  int64_t at_us;             /**< Virtual time of the last result. */
+} result_log_t;
+
+/**
+ * @brief Connection result callback recording into a `result_log_t`.
+ *
+ * @param result The result of the attempt.
+ * @param arg The `result_log_t`.
+ */
+static void record_result(wifi_api_result_t result, void *arg)
+{
+  result_log_t *log = arg;
+  log->count++;
+  log->result = result;
+  log->at_us = sim_now_us();
+}
+
+/**
+ * @brief The asynchronous configuration returns before the connection and
+ * reports a success, an authentication failure or a timeout once, a pending
+ * attempt replaced by a new configuration reports a timeout.
+ */
+static void test_configure_async(void *arg)
+{
+  test_ap("home", 1, 6, -50);
+
+  result_log_t log = {0};
+  int64_t start = sim_now_us();
+  CHECK_OK(wifi_api_configure_async("home", "password", 10000, &record_result,
+                                    &log));
+  CHECK(sim_now_us() == start && log.count == 0);
+  CHECK(wifi_api_wait_state(WIFI_API_STATE_GOT_IP4, false, 10000) &
+        WIFI_API_STATE_GOT_IP4);
+  sim_sleep_ms(1);
+  CHECK(log.count == 1 && log.result == WIFI_API_RESULT_CONNECTED);
+  // The stopped timeout does not report again
+  sim_sleep_ms(10000);
+  CHECK(log.count == 1);
+  test_disconnect();
+
+  wifi_api_retry_config_t retry = {
+    .base_delay_ms = 100, .max_delay_ms = 200, .max_retry = 1};
+  CHECK_OK(wifi_api_set_retry_config(&retry));
+  log = (result_log_t){0};
+  CHECK_OK(wifi_api_configure_async("home", "wrong", 10000, &record_result,
+                                    &log));
+  sim_sleep_ms(10000);
+  CHECK(log.count == 1 && log.result == WIFI_API_RESULT_FAILED);
+  test_disconnect();
+  wifi_api_retry_config_t defaults = WIFI_API_RETRY_CONFIG_DEFAULT();
+  wifi_api_set_retry_config(&defaults);
+
+  log = (result_log_t){0};
+  start = sim_now_us();
+  CHECK_OK(wifi_api_configure_async("lab", "password", 2000, &record_result,
+                                    &log));
+  sim_sleep_ms(5000);
+  CHECK(log.count == 1 && log.result == WIFI_API_RESULT_TIMEOUT);
+  CHECK(log.at_us - start >= 2000000 && log.at_us - start < 2100000);
+
+  // Still pending without a timeout, then configured again
+  log = (result_log_t){0};
+  CHECK_OK(wifi_api_configure_async("lab", "password", 0, &record_result,
+                                    &log));
+  sim_sleep_ms(1000);
+  CHECK(log.count == 0);
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(log.count == 1 && log.result == WIFI_API_RESULT_TIMEOUT);
+  test_disconnect();
+  wifi_api_reset_disconnect_counts();
+}
+
+/**
+ * @brief The bounded configuration returns the result of the attempt or
+ * gives up after its timeout.
+ */
+static void test_configure_timeout(void *arg)
+{
+  test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_configure_timeout("home", "password", 10000));
+  test_disconnect();
+
+  wifi_api_retry_config_t retry = {
+    .base_delay_ms = 100, .max_delay_ms = 200, .max_retry = 1};
+  CHECK_OK(wifi_api_set_retry_config(&retry));
+  CHECK(wifi_api_configure_timeout("home", "wrong", 10000) == ESP_FAIL);
+  test_disconnect();
+  wifi_api_retry_config_t defaults = WIFI_API_RETRY_CONFIG_DEFAULT();
+  wifi_api_set_retry_config(&defaults);
+
+  int64_t start = sim_now_us();
+  CHECK(wifi_api_configure_timeout("lab", "password", 2000) ==
+        ESP_ERR_TIMEOUT);
+  CHECK(test_elapsed_ms(start) >= 2000 && test_elapsed_ms(start) < 2100);
+  test_disconnect();
+  wifi_api_reset_disconnect_counts();
+}
+
+/**
+ * @brief The station reconnects by itself once a lost AP is back.
+ */
+static void test_ap_flap(void *arg)
+{
+  int ap = test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+
+  sim_ap_set_up(ap, false);
+  sim_sleep_ms(sim_get_timing().beacon_timeout_ms + 100);
+  CHECK(sim_connected_ap() < 0);
+  CHECK(wifi_api_get_disconnect_count(WIFI_REASON_BEACON_TIMEOUT) == 1);
+
+  sim_ap_set_up(ap, true);
+  CHECK(test_wait_got_ip(60000));
+  CHECK(sim_connected_ap() == ap);
+  test_disconnect();
+  wifi_api_reset_disconnect_counts();
+}
+
+/**
+ * @brief A missing network times out and keeps retrying in the background.
+ */
+static void test_no_ap(void *arg)
+{
+  CHECK(wifi_api_configure_timeout("home", "password", 5000) ==
+        ESP_ERR_TIMEOUT);
+  CHECK(wifi_api_get_disconnect_count(WIFI_REASON_NO_AP_FOUND) > 0);
+
+  int ap = test_ap("home", 1, 11, -50);
+  CHECK(test_wait_got_ip(60000));
+  CHECK(sim_connected_ap() == ap);
+  test_disconnect();
+  wifi_api_reset_disconnect_counts();
+}
+
+/**
+ * @brief Component events in the order they were published.
+ */
+static wifi_api_event_t s_order[8];
+
+/**
+ * @brief Number of events in `s_order`.
+ */
+static size_t s_order_len = 0;
+
+/**
+ * @brief Record the order of component events.
+ *
+ * @param data The event data.
+ * @param arg Unused.
+ */
+static void record_event(const wifi_api_event_data_t *data, void *arg)
+{
+  if (s_order_len < sizeof(s_order) / sizeof(s_order[0]))
+    s_order[s_order_len++] = data->event;
+}
+
+/**
+ * @brief Scan completion callback holding the manager task.
+ *
+ * @param ap_count Unused.
+ * @param status Unused.
+ * @param arg Pointer to the time to hold the task, in milliseconds.
+ */
+static void hold_task(uint16_t ap_count, esp_err_t status, void *arg)
+{
+  vTaskDelay(pdMS_TO_TICKS(*(uint32_t *)arg));
+}
+
+/**
+ * @brief Driver events arriving while the command queue is full are neither
+ * dropped nor handled out of order.
+ */
+static void test_events_queue_full(void *arg)
+{
+  int ap = test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_set_rssi_threshold(-70));
+  CHECK_OK(wifi_api_configure("home", "password"));
+  s_order_len = 0;
+  CHECK_OK(wifi_api_subscribe(WIFI_API_EVENT_RSSI_LOW, &record_event, NULL,
+                              false));
+  CHECK_OK(wifi_api_subscribe(WIFI_API_EVENT_LOST_IP, &record_event, NULL,
+                              false));
+
+  uint32_t hold_ms = sim_get_timing().beacon_timeout_ms + 2000;
+  wifi_api_scan_config_t config = WIFI_API_SCAN_CONFIG_DEFAULT();
+  CHECK_OK(wifi_api_scan_start(&config, NULL, &hold_task, &hold_ms));
+  CHECK(wifi_api_wait_state(WIFI_API_STATE_SCANNING, false, 10000) &
+        WIFI_API_STATE_SCANNING);
+  while (wifi_api_get_state() & WIFI_API_STATE_SCANNING)
+    sim_sleep_ms(10);
+
+  // Held by the scan callback, the queue is filled and the AP weakens, then
+  // goes away
+  while (wifi_api_scan_stop() == ESP_OK)
+    ;
+  sim_ap_set_rssi(ap, -80);
+  sim_sleep_ms(500);
+  sim_ap_set_up(ap, false);
+  sim_sleep_ms(hold_ms + 1000);
+
+  CHECK(s_order_len == 2);
+  CHECK(s_order[0] == WIFI_API_EVENT_RSSI_LOW);
+  CHECK(s_order[1] == WIFI_API_EVENT_LOST_IP);
+  CHECK(wifi_api_get_disconnect_count(WIFI_REASON_BEACON_TIMEOUT) == 1);
+
+  wifi_api_unsubscribe(WIFI_API_EVENT_RSSI_LOW, &record_event, NULL);
+  wifi_api_unsubscribe(WIFI_API_EVENT_LOST_IP, &record_event, NULL);
+  CHECK_OK(wifi_api_set_rssi_threshold(0));
+  test_disconnect();
+  wifi_api_reset_disconnect_counts();
+}
+
+int main()
+{
+  test_run("connect_disconnect", &test_connect_disconnect);
+  test_run("cached_ap", &test_cached_ap);
+  test_run("cached_ap_gone", &test_cached_ap_gone);
+  test_run("cached_ap_aborted", &test_cached_ap_aborted);
+  test_run("profiles_cached_ap", &test_profiles_cached_ap);
+  test_run("wrong_password", &test_wrong_password);
+  test_run("configure_async", &test_configure_async);
+  test_run("configure_timeout", &test_configure_timeout);
+  test_run("ap_flap", &test_ap_flap);
+  test_run("no_ap", &test_no_ap);
+  test_run("events_queue_full", &test_events_queue_full);
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
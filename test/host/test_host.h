@@ -0,0 +1,142 @@
+/**
+ * @file test_host.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Checks and helpers shared by the host tests
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef TEST_HOST_H
+#define TEST_HOST_H
+
+#include "sim.h"
+#include "wifi_api.h"
+
+#include <esp_netif.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Number of failed checks.
+ */
+static int s_test_failures = 0;
+
+/**
+ * @brief Record a failed check without stopping the test.
+ */
+#define CHECK(cond)                                                            \
+  do                                                                           \
+  {                                                                            \
+    if (!(cond))                                                               \
+    {                                                                          \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      s_test_failures++;                                                       \
+    }                                                                          \
+  } while (0)
+
+/**
+ * @brief Check that an expression returns ESP_OK.
+ */
+#define CHECK_OK(expr) CHECK((expr) == ESP_OK)
+
+/**
+ * @brief Add a WPA2 access point.
+ *
+ * @param ssid The SSID.
+ * @param last Last byte of the BSSID.
+ * @param channel The channel.
+ * @param rssi The RSSI.
+ * @return Its index.
+ */
+static inline int test_ap(const char *ssid, uint8_t last, uint8_t channel,
+                          int8_t rssi)
+{
+  sim_ap_t ap = {
+    .ssid = ssid,
+    .bssid = {0x24, 0x0a, 0xc4, 0x00, 0x00, last},
+    .channel = channel,
+    .rssi = rssi,
+    .authmode = WIFI_AUTH_WPA2_PSK,
+    .password = "password",
+  };
+  return sim_ap_add(&ap);
+}
+
+/**
+ * @brief Disconnect and let the driver report it.
+ *
+ * The disconnection event is delivered after `wifi_api_disconnect` returned,
+ * a connection started at once would take it as its own failure.
+ */
+static inline void test_disconnect()
+{
+  CHECK_OK(wifi_api_disconnect());
+  sim_sleep_ms(1);
+}
+
+/**
+ * @brief Give the semaphore of `test_wait_got_ip`.
+ *
+ * @param arg The semaphore.
+ * @param event_base Unused.
+ * @param event_id Unused.
+ * @param event_data Unused.
+ */
+static void test_got_ip(void *arg, esp_event_base_t event_base,
+                        int32_t event_id, void *event_data)
+{
+  xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+/**
+ * @brief Wait for the next `IP_EVENT_STA_GOT_IP`, as an application would.
+ *
+ * @param timeout_ms The timeout in milliseconds.
+ * @return true if the station got an address in time.
+ */
+static inline bool test_wait_got_ip(uint32_t timeout_ms)
+{
+  SemaphoreHandle_t got_ip = xSemaphoreCreateBinary();
+  esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &test_got_ip,
+                             got_ip);
+  bool ok = xSemaphoreTake(got_ip, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+  esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, &test_got_ip);
+  vSemaphoreDelete(got_ip);
+  return ok;
+}
+
+/**
+ * @brief Get the time elapsed since a virtual time.
+ *
+ * @param start_us The start.
+ * @return The elapsed time in milliseconds.
+ */
+static inline double test_elapsed_ms(int64_t start_us)
+{
+  return (sim_now_us() - start_us) / 1000.0;
+}
+
+/**
+ * @brief Run a test on the main task of the simulation and report it.
+ *
+ * @param name The name of the test.
+ * @param fn The test.
+ */
+static inline void test_run(const char *name, void (*fn)(void *))
+{
+  int failures = s_test_failures;
+  sim_reset(1);
+  sim_nvs_erase();
+  sim_run(fn, NULL);
+  printf("%-40s %s\n", name, s_test_failures == failures ? "ok" : "FAILED");
+}
+
+#endif /* TEST_HOST_H */
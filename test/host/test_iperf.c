@@ -0,0 +1,157 @@
+/**
+ * @file test_iperf.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Benchmark client against the benchmark server over the loopback
+ *
+ * The benchmark only uses the socket API, so it runs on the host sockets
+ * and clock, outside of the simulation. The server runs in a thread.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+#include "wifi_api_iperf.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * @brief Port of the loopback server.
+ */
+#define IPERF_PORT 15001
+
+/**
+ * @brief Attempts of the client while the server is not listening yet.
+ */
+#define CLIENT_ATTEMPTS 20
+
+/**
+ * @brief A benchmark run in a thread.
+ */
+typedef struct
+{
+  wifi_api_iperf_config_t config; /**< The configuration. */
+  wifi_api_iperf_result_t result; /**< The result. */
+  esp_err_t err;                  /**< The status. */
+} iperf_run_t;
+
+/**
+ * @brief Run a benchmark.
+ *
+ * @param arg The run.
+ * @return NULL.
+ */
+static void *iperf_thread(void *arg)
+{
+  iperf_run_t *run = arg;
+  run->err = wifi_api_iperf_run(&run->config, &run->result);
+  return NULL;
+}
+
+/**
+ * @brief Run a client against a server thread on the loopback.
+ *
+ * @param proto The protocol.
+ * @param client The client run, the configuration filled.
+ * @param server The server run.
+ */
+static void iperf_loopback(wifi_api_iperf_proto_t proto, iperf_run_t *client,
+                           iperf_run_t *server)
+{
+  server->config = (wifi_api_iperf_config_t)WIFI_API_IPERF_CONFIG_DEFAULT();
+  server->config.role = WIFI_API_IPERF_SERVER;
+  server->config.proto = proto;
+  server->config.port = IPERF_PORT;
+  server->config.length = client->config.length;
+  server->config.interval_s = 0;
+  pthread_t thread;
+  CHECK(pthread_create(&thread, NULL, &iperf_thread, server) == 0);
+
+  client->config.role = WIFI_API_IPERF_CLIENT;
+  client->config.proto = proto;
+  client->config.host = "127.0.0.1";
+  client->config.port = IPERF_PORT;
+  client->config.interval_s = 0;
+  // The server may not be listening yet
+  for (int i = 0; i < CLIENT_ATTEMPTS; i++)
+  {
+    usleep(50000);
+    client->err = wifi_api_iperf_run(&client->config, &client->result);
+    if (client->err != ESP_FAIL || client->result.bytes > 0)
+      break;
+  }
+  pthread_join(thread, NULL);
+}
+
+/**
+ * @brief Every byte of a TCP stream reaches the server.
+ */
+static void test_iperf_tcp()
+{
+  iperf_run_t client = {.config = WIFI_API_IPERF_CONFIG_DEFAULT()};
+  iperf_run_t server = {0};
+  client.config.duration_s = 1;
+  iperf_loopback(WIFI_API_IPERF_TCP, &client, &server);
+
+  CHECK_OK(client.err);
+  CHECK_OK(server.err);
+  CHECK(client.result.bytes > 0);
+  CHECK(server.result.bytes == client.result.bytes);
+  CHECK(client.result.duration_ms >= 1000);
+  CHECK(client.result.throughput_kbps > 0);
+  printf("  tcp: %u kbit/s sent, %u kbit/s received\n",
+         (unsigned)client.result.throughput_kbps,
+         (unsigned)server.result.throughput_kbps);
+}
+
+/**
+ * @brief A paced UDP stream is received at its rate without loss, and the
+ * server reports back to the client.
+ */
+static void test_iperf_udp()
+{
+  iperf_run_t client = {.config = WIFI_API_IPERF_CONFIG_DEFAULT()};
+  iperf_run_t server = {0};
+  client.config.duration_s = 1;
+  client.config.bandwidth_kbps = 8000;
+  iperf_loopback(WIFI_API_IPERF_UDP, &client, &server);
+
+  CHECK_OK(client.err);
+  CHECK_OK(server.err);
+  CHECK(client.result.datagrams > 0);
+  CHECK(server.result.datagrams == client.result.datagrams);
+  CHECK(server.result.bytes == client.result.bytes);
+  CHECK(server.result.lost == 0 && client.result.lost == 0);
+  CHECK(server.result.out_of_order == 0);
+  // Within a tenth of the requested rate
+  CHECK(client.result.throughput_kbps > 7200 &&
+        client.result.throughput_kbps < 8800);
+  printf("  udp: %u kbit/s, %u datagrams, jitter %u us\n",
+         (unsigned)server.result.throughput_kbps,
+         (unsigned)server.result.datagrams, (unsigned)server.result.jitter_us);
+}
+
+/**
+ * @brief Run a test and report it.
+ *
+ * @param name The name of the test.
+ * @param fn The test.
+ */
+static void iperf_test_run(const char *name, void (*fn)())
+{
+  int failures = s_test_failures;
+  fn();
+  printf("%-40s %s\n", name, s_test_failures == failures ? "ok" : "FAILED");
+}
+
+int main()
+{
+  iperf_test_run("iperf_tcp", &test_iperf_tcp);
+  iperf_test_run("iperf_udp", &test_iperf_udp);
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
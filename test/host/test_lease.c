@@ -0,0 +1,131 @@
+/**
+ * @file test_lease.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Address acquisition through DHCP and the cached lease
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+
+/**
+ * @brief Get the address of the station interface.
+ *
+ * @return The address, 0 without an interface.
+ */
+static uint32_t station_ip()
+{
+  esp_netif_ip_info_t ip_info = {0};
+  esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+  if (netif)
+    esp_netif_get_ip_info(netif, &ip_info);
+  return ip_info.ip.addr;
+}
+
+/**
+ * @brief Get the longest `WIFI_API_PHASE_DHCP` sample and clear the phases.
+ *
+ * @return The longest sample in microseconds.
+ */
+static uint32_t dhcp_phase_us()
+{
+  wifi_api_phase_stats_t stats;
+  CHECK_OK(wifi_api_get_phase_stats(WIFI_API_PHASE_DHCP, &stats));
+  CHECK(stats.count == 1);
+  wifi_api_reset_phase_stats();
+  return stats.max_us;
+}
+
+/**
+ * @brief DHCP takes an exchange on every connection, the cached lease
+ * is applied at once and kept once the gateway answered.
+ */
+static void test_lease_dhcp_phase(void *arg)
+{
+  test_ap("home", 1, 6, -50);
+  uint32_t dhcp_us = sim_get_timing().dhcp_ms * 1000;
+
+  CHECK_OK(wifi_api_set_ip_mode(WIFI_API_IP_MODE_DHCP, NULL));
+  CHECK_OK(wifi_api_configure("home", "password"));
+  test_disconnect();
+  wifi_api_reset_phase_stats();
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(dhcp_phase_us() == dhcp_us);
+  CHECK(sim_stats().dhcp_exchanges == 1);
+  test_disconnect();
+
+  // The first connection stores the lease, the next one applies it
+  CHECK_OK(wifi_api_set_ip_mode(WIFI_API_IP_MODE_CACHED_LEASE, NULL));
+  CHECK_OK(wifi_api_configure("home", "password"));
+  uint32_t ip = station_ip();
+  test_disconnect();
+  wifi_api_reset_phase_stats();
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(dhcp_phase_us() < dhcp_us / 10);
+  CHECK(station_ip() == ip);
+
+  // Revalidated by the gateway, no exchange follows
+  sim_sleep_ms(5000);
+  CHECK(sim_stats().dhcp_exchanges == 0);
+  CHECK(station_ip() == ip);
+  test_disconnect();
+  CHECK_OK(wifi_api_set_ip_mode(WIFI_API_IP_MODE_DHCP, NULL));
+}
+
+/**
+ * @brief A cached lease whose gateway does not answer, as after the network
+ * was renumbered, is replaced through DHCP.
+ */
+static void test_lease_gateway_unreachable(void *arg)
+{
+  int old = test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_set_ip_mode(WIFI_API_IP_MODE_CACHED_LEASE, NULL));
+  CHECK_OK(wifi_api_configure("home", "password"));
+  uint32_t old_ip = station_ip();
+  test_disconnect();
+
+  sim_ap_set_up(old, false);
+  sim_ap_t ap = {
+    .ssid = "home",
+    .bssid = {0x24, 0x0a, 0xc4, 0x00, 0x00, 2},
+    .channel = 6,
+    .rssi = -50,
+    .authmode = WIFI_AUTH_WPA2_PSK,
+    .password = "password",
+    .subnet = 2,
+  };
+  sim_ap_add(&ap);
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(station_ip() == old_ip);
+  CHECK(sim_stats().dhcp_exchanges == 0);
+
+  sim_sleep_ms(5000);
+  CHECK(sim_stats().dhcp_exchanges == 1);
+  uint32_t new_ip = station_ip();
+  CHECK(new_ip != old_ip && new_ip != 0);
+  test_disconnect();
+
+  // The lease obtained on the new network replaced the stale one
+  sim_reset_stats();
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(station_ip() == new_ip);
+  sim_sleep_ms(5000);
+  CHECK(sim_stats().dhcp_exchanges == 0);
+  test_disconnect();
+  CHECK_OK(wifi_api_set_ip_mode(WIFI_API_IP_MODE_DHCP, NULL));
+}
+
+int main()
+{
+  test_run("lease_dhcp_phase", &test_lease_dhcp_phase);
+  test_run("lease_gateway_unreachable", &test_lease_gateway_unreachable);
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
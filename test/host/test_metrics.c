@@ -0,0 +1,102 @@
+/**
+ * @file test_metrics.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Connection phase statistics under a synthetic driver timing
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+
+/**
+ * @brief Connections whose phases are recorded.
+ */
+#define RUNS 20
+
+/**
+ * @brief Check the statistics of a phase.
+ */
+#define CHECK_PHASE(phase, n, min, avg, max, p95)                              \
+  do                                                                           \
+  {                                                                            \
+    wifi_api_phase_stats_t stats;                                              \
+    CHECK_OK(wifi_api_get_phase_stats(phase, &stats));                         \
+    CHECK(stats.count == (n));                                                 \
+    CHECK(stats.min_us == (min));                                              \
+    CHECK(stats.avg_us == (avg));                                              \
+    CHECK(stats.max_us == (max));                                              \
+    CHECK(stats.p95_us == (p95));                                              \
+  } while (0)
+
+/**
+ * @brief Each phase takes the time of the simulated step it spans, one slow
+ * DHCP exchange moves the average and the maximum but not the 95th
+ * percentile.
+ */
+static void test_phase_timing(void *arg)
+{
+  test_ap("home", 1, 6, -50);
+  sim_timing_t timing = sim_get_timing();
+  timing.start_ms = 50;
+  timing.active_dwell_ms = 100;
+  timing.auth_ms = 20;
+  timing.handshake_ms = 30;
+  timing.dhcp_ms = 100;
+  sim_set_timing(&timing);
+
+  // The AP is cached by the first connection, the next ones scan a channel
+  CHECK_OK(wifi_api_configure("home", "password"));
+  test_disconnect();
+  wifi_api_reset_phase_stats();
+
+  for (int i = 0; i < RUNS; i++)
+  {
+    if (i == RUNS - 1)
+    {
+      timing.dhcp_ms = 3000;
+      sim_set_timing(&timing);
+    }
+    CHECK_OK(wifi_api_configure("home", "password"));
+    test_disconnect();
+  }
+  wifi_api_dump_phase_stats();
+
+  CHECK_PHASE(WIFI_API_PHASE_START, RUNS, 50000, 50000, 50000, 50000);
+  CHECK_PHASE(WIFI_API_PHASE_CONNECT, RUNS, 150000, 150000, 150000, 150000);
+  // 19 samples of 100 ms in the 64 to 128 ms bucket, one of 3 s
+  CHECK_PHASE(WIFI_API_PHASE_DHCP, RUNS, 100000, 245000, 3000000, 128000);
+  CHECK_PHASE(WIFI_API_PHASE_TOTAL, RUNS, 300000, 445000, 3200000, 512000);
+  CHECK_PHASE(WIFI_API_PHASE_ROAM, 0, 0, 0, 0, 0);
+}
+
+/**
+ * @brief Resetting clears every phase, invalid arguments are rejected.
+ */
+static void test_phase_reset(void *arg)
+{
+  test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+  test_disconnect();
+
+  wifi_api_reset_phase_stats();
+  for (wifi_api_phase_t phase = 0; phase < WIFI_API_PHASE_MAX; phase++)
+    CHECK_PHASE(phase, 0, 0, 0, 0, 0);
+
+  wifi_api_phase_stats_t stats;
+  CHECK(wifi_api_get_phase_stats(WIFI_API_PHASE_MAX, &stats) ==
+        ESP_ERR_INVALID_ARG);
+  CHECK(wifi_api_get_phase_stats(WIFI_API_PHASE_DHCP, NULL) ==
+        ESP_ERR_INVALID_ARG);
+}
+
+int main()
+{
+  test_run("phase_timing", &test_phase_timing);
+  test_run("phase_reset", &test_phase_reset);
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
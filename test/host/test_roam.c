@@ -0,0 +1,218 @@
+/**
+ * @file test_roam.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Roaming between the access points of a network
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+
+#include <string.h>
+
+/**
+ * @brief Component events published during a test.
+ */
+static uint32_t s_events[WIFI_API_EVENT_MAX];
+
+/**
+ * @brief Address of the last `WIFI_API_EVENT_CONNECTED`.
+ */
+static esp_netif_ip_info_t s_ip_info;
+
+/**
+ * @brief Count a component event.
+ *
+ * @param data The event data.
+ * @param arg Unused.
+ */
+static void count_event(const wifi_api_event_data_t *data, void *arg)
+{
+  s_events[data->event]++;
+  if (data->event == WIFI_API_EVENT_CONNECTED)
+    s_ip_info = data->connected.ip_info;
+}
+
+/**
+ * @brief Subscribe to every component event and clear the counts.
+ */
+static void events_subscribe()
+{
+  memset(s_events, 0, sizeof(s_events));
+  for (int event = 0; event < WIFI_API_EVENT_MAX; event++)
+    wifi_api_subscribe(event, &count_event, NULL, false);
+}
+
+/**
+ * @brief Unsubscribe from every component event.
+ */
+static void events_unsubscribe()
+{
+  for (int event = 0; event < WIFI_API_EVENT_MAX; event++)
+    wifi_api_unsubscribe(event, &count_event, NULL);
+}
+
+/**
+ * @brief A weak AP is left for a stronger one of the network and the
+ * address is kept without being reported lost or obtained again early.
+ */
+static void test_roam_keeps_address(void *arg)
+{
+  int weak = test_ap("home", 1, 1, -60);
+  int strong = test_ap("home", 2, 6, -50);
+  wifi_api_roam_config_t roam = WIFI_API_ROAM_CONFIG_DEFAULT();
+  roam.min_interval_ms = 1000;
+  CHECK_OK(wifi_api_set_roaming(&roam));
+  events_subscribe();
+
+  // The fast scan joins the first AP found
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(sim_connected_ap() == weak);
+  CHECK(s_events[WIFI_API_EVENT_CONNECTED] == 1);
+  esp_netif_ip_info_t before = s_ip_info;
+  wifi_api_reset_phase_stats();
+
+  sim_ap_set_rssi(weak, -80);
+  sim_sleep_ms(5000);
+  CHECK(sim_connected_ap() == strong);
+  CHECK(wifi_api_get_state() & WIFI_API_STATE_GOT_IP4);
+  CHECK(!(wifi_api_get_state() & WIFI_API_STATE_ROAMING));
+  CHECK(s_events[WIFI_API_EVENT_ROAM] == 1);
+  CHECK(s_events[WIFI_API_EVENT_LOST_IP] == 0);
+  // Only the renewal on the new AP is reported
+  CHECK(s_events[WIFI_API_EVENT_CONNECTED] == 2);
+  CHECK(s_ip_info.ip.addr == before.ip.addr);
+  wifi_api_phase_stats_t phase;
+  CHECK_OK(wifi_api_get_phase_stats(WIFI_API_PHASE_ROAM, &phase));
+  CHECK(phase.count == 1);
+
+  events_unsubscribe();
+  CHECK_OK(wifi_api_set_roaming(NULL));
+  test_disconnect();
+}
+
+/**
+ * @brief An AP answering neighbor report requests has only the channels of
+ * its neighbors scanned.
+ */
+static void test_roam_neighbor_report(void *arg)
+{
+  sim_ap_t ap = {
+    .ssid = "home",
+    .bssid = {0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01},
+    .channel = 1,
+    .rssi = -60,
+    .authmode = WIFI_AUTH_WPA2_PSK,
+    .password = "password",
+    .rrm = true,
+  };
+  int weak = sim_ap_add(&ap);
+  int strong = test_ap("home", 2, 11, -50);
+  test_ap("other", 3, 6, -30);
+  wifi_api_roam_config_t roam = WIFI_API_ROAM_CONFIG_DEFAULT();
+  roam.min_interval_ms = 1000;
+  CHECK_OK(wifi_api_set_roaming(&roam));
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(sim_connected_ap() == weak);
+
+  sim_reset_stats();
+  sim_ap_set_rssi(weak, -80);
+  sim_sleep_ms(5000);
+  CHECK(sim_connected_ap() == strong);
+  CHECK(sim_stats().neighbor_requests == 1);
+  // The neighbor channel, then the reassociation on it
+  CHECK(sim_stats().scanned_channels == 2);
+  CHECK(!(wifi_api_get_state() & WIFI_API_STATE_ROAMING));
+
+  CHECK_OK(wifi_api_set_roaming(NULL));
+  test_disconnect();
+}
+
+/**
+ * @brief A roam started by the supplicant, as after a BSS transition
+ * request, is reported and timed without a reconnection of the component.
+ */
+static void test_roam_supplicant(void *arg)
+{
+  int first = test_ap("home", 1, 1, -60);
+  int second = test_ap("home", 2, 6, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+  CHECK(sim_connected_ap() == first);
+  events_subscribe();
+  wifi_api_reset_phase_stats();
+
+  sim_reset_stats();
+  CHECK(sim_supplicant_roam(second));
+  uint32_t state = wifi_api_wait_state(WIFI_API_STATE_GOT_IP4, true, 10000);
+  sim_sleep_ms(1000);
+  CHECK(state & WIFI_API_STATE_GOT_IP4);
+  CHECK(sim_connected_ap() == second);
+  CHECK(sim_stats().connects == 0);
+  CHECK(s_events[WIFI_API_EVENT_ROAM] == 1);
+  CHECK(s_events[WIFI_API_EVENT_LOST_IP] == 0);
+  CHECK(!(wifi_api_get_state() & WIFI_API_STATE_ROAMING));
+
+  // The fast transition is timed, well below a full reassociation
+  wifi_api_phase_stats_t phase;
+  CHECK_OK(wifi_api_get_phase_stats(WIFI_API_PHASE_ROAM, &phase));
+  CHECK(phase.count == 1);
+  CHECK(phase.max_us == sim_get_timing().ft_ms * 1000);
+  CHECK(phase.max_us < 50000);
+
+  events_unsubscribe();
+  test_disconnect();
+}
+
+/**
+ * @brief An RSSI staying below the threshold is reported once, a further
+ * drop is reported again, and the threshold is armed again only once a link
+ * sample shows the RSSI recovered above it.
+ */
+static void test_rssi_low_hysteresis(void *arg)
+{
+  int ap = test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_set_rssi_threshold(-70));
+  CHECK_OK(wifi_api_configure("home", "password"));
+  events_subscribe();
+
+  sim_ap_set_rssi(ap, -75);
+  sim_sleep_ms(5000);
+  CHECK(s_events[WIFI_API_EVENT_RSSI_LOW] == 1);
+  sim_ap_set_rssi(ap, -78);
+  sim_sleep_ms(2000);
+  CHECK(s_events[WIFI_API_EVENT_RSSI_LOW] == 1);
+  sim_ap_set_rssi(ap, -81);
+  sim_sleep_ms(2000);
+  CHECK(s_events[WIFI_API_EVENT_RSSI_LOW] == 2);
+
+  // Back above the threshold but within the hysteresis
+  sim_ap_set_rssi(ap, -68);
+  sim_sleep_ms(3000);
+  sim_ap_set_rssi(ap, -75);
+  sim_sleep_ms(2000);
+  CHECK(s_events[WIFI_API_EVENT_RSSI_LOW] == 2);
+
+  sim_ap_set_rssi(ap, -60);
+  sim_sleep_ms(3000);
+  sim_ap_set_rssi(ap, -75);
+  sim_sleep_ms(2000);
+  CHECK(s_events[WIFI_API_EVENT_RSSI_LOW] == 3);
+
+  events_unsubscribe();
+  CHECK_OK(wifi_api_set_rssi_threshold(0));
+  test_disconnect();
+}
+
+int main()
+{
+  test_run("roam_keeps_address", &test_roam_keeps_address);
+  test_run("roam_neighbor_report", &test_roam_neighbor_report);
+  test_run("roam_supplicant", &test_roam_supplicant);
+  test_run("rssi_low_hysteresis", &test_rssi_low_hysteresis);
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
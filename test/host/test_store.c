@@ -0,0 +1,87 @@
+/**
+ * @file test_store.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Credential profiles persisted in NVS
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+
+#include <nvs_flash.h>
+
+/**
+ * @brief Stored profiles are loaded back after being removed from memory and
+ * are gone once erased.
+ */
+static void test_store_load(void *arg)
+{
+  wifi_api_profile_t home = {.ssid = "home", .password = "password",
+                             .priority = 1};
+  wifi_api_profile_t office = {.ssid = "office", .password = "password",
+                               .priority = 2};
+  CHECK_OK(wifi_api_store_profile(&home));
+  CHECK_OK(wifi_api_store_profile(&office));
+
+  // An unchanged profile is not written again
+  sim_reset_stats();
+  CHECK_OK(wifi_api_store_profile(&home));
+  CHECK(sim_stats().nvs_writes == 0);
+
+  CHECK_OK(wifi_api_remove_profile("home"));
+  CHECK_OK(wifi_api_remove_profile("office"));
+  size_t count = 0;
+  CHECK_OK(wifi_api_load_profiles(&count));
+  CHECK(count == 2 && wifi_api_get_profile_count() == 2);
+
+  CHECK_OK(wifi_api_erase_profile("home"));
+  CHECK_OK(wifi_api_erase_profile("office"));
+  CHECK(wifi_api_erase_profile("office") == ESP_ERR_NOT_FOUND);
+  CHECK(wifi_api_get_profile_count() == 0);
+  CHECK_OK(wifi_api_load_profiles(&count));
+  CHECK(count == 0);
+}
+
+/**
+ * @brief An index written by a build with a higher
+ * `CONFIG_WIFI_API_MAX_PROFILES` is truncated instead of failing every load.
+ */
+static void test_store_index_larger(void *arg)
+{
+  wifi_api_profile_t home = {.ssid = "home", .password = "password",
+                             .priority = 1};
+  CHECK_OK(wifi_api_store_profile(&home));
+  CHECK_OK(wifi_api_remove_profile("home"));
+
+  // The slot of the profile, followed by slots of profiles not stored
+  nvs_handle_t handle;
+  uint32_t slots[CONFIG_WIFI_API_MAX_PROFILES + 2] = {0};
+  size_t length = sizeof(slots);
+  CHECK_OK(nvs_open_from_partition(CONFIG_WIFI_API_STORE_PARTITION,
+                                   "wifi_api_cred", NVS_READWRITE, &handle));
+  CHECK_OK(nvs_get_blob(handle, "index", slots, &length));
+  CHECK(length == sizeof(slots[0]));
+  for (size_t i = 1; i < sizeof(slots) / sizeof(slots[0]); i++)
+    slots[i] = slots[0] + i;
+  CHECK_OK(nvs_set_blob(handle, "index", slots, sizeof(slots)));
+  CHECK_OK(nvs_commit(handle));
+  nvs_close(handle);
+
+  size_t count = 0;
+  CHECK_OK(wifi_api_load_profiles(&count));
+  CHECK(count == 1 && wifi_api_get_profile_count() == 1);
+  CHECK_OK(wifi_api_erase_profile("home"));
+  CHECK(wifi_api_get_profile_count() == 0);
+}
+
+int main()
+{
+  test_run("store_load", &test_store_load);
+  test_run("store_index_larger", &test_store_index_larger);
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
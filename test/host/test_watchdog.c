@@ -0,0 +1,158 @@
+/**
+ * @file test_watchdog.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Connectivity watchdog probing a TCP listener on the loopback
+ *
+ * The probe uses the host sockets, the station and its recoveries are
+ * simulated.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "test_host.h"
+#include "wifi_api_probe.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Actions of the `WIFI_API_EVENT_WATCHDOG` events published.
+ */
+static uint32_t s_actions[WIFI_API_WATCHDOG_ACTION_MAX];
+
+/**
+ * @brief Count a watchdog event.
+ *
+ * @param data The event data.
+ * @param arg Unused.
+ */
+static void count_action(const wifi_api_event_data_t *data, void *arg)
+{
+  s_actions[data->watchdog.action]++;
+}
+
+/**
+ * @brief Open a TCP listener on the loopback.
+ *
+ * @param port The port, 0 for any, set to the bound port.
+ * @return The socket, -1 on failure.
+ */
+static int listener_open(uint16_t *port)
+{
+  int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  int reuse = 1;
+  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  struct sockaddr_in addr = {
+    .sin_family = AF_INET,
+    .sin_port = htons(*port),
+    .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+  };
+  socklen_t length = sizeof(addr);
+  // The probes are never accepted, the backlog holds them all
+  if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(sock, 64) != 0 ||
+      getsockname(sock, (struct sockaddr *)&addr, &length) != 0)
+  {
+    close(sock);
+    return -1;
+  }
+  *port = ntohs(addr.sin_port);
+  return sock;
+}
+
+/**
+ * @brief A listening port accepts the probe, a closed one refuses it.
+ */
+static void test_probe_tcp(void *arg)
+{
+  uint16_t port = 0;
+  int listener = listener_open(&port);
+  CHECK(listener >= 0);
+
+  uint32_t latency_us = UINT32_MAX;
+  CHECK_OK(wifi_api_probe_tcp("127.0.0.1", port, 1000, &latency_us));
+  CHECK(latency_us < 1000000);
+  CHECK_OK(wifi_api_probe_tcp("127.0.0.1", port, 1000, NULL));
+
+  close(listener);
+  CHECK(wifi_api_probe_tcp("127.0.0.1", port, 1000, NULL) == ESP_FAIL);
+  CHECK(wifi_api_probe_tcp("localhost", port, 1000, NULL) ==
+        ESP_ERR_INVALID_ARG);
+  CHECK(wifi_api_probe_tcp(NULL, port, 1000, NULL) == ESP_ERR_INVALID_ARG);
+}
+
+/**
+ * @brief Probes of a listening endpoint succeed and are timed. Once it is
+ * gone, the recoveries escalate every `failures` probes, and stop when it
+ * is back.
+ */
+static void test_watchdog_tcp(void *arg)
+{
+  uint16_t port = 0;
+  int listener = listener_open(&port);
+  CHECK(listener >= 0);
+  test_ap("home", 1, 6, -50);
+  CHECK_OK(wifi_api_configure("home", "password"));
+  memset(s_actions, 0, sizeof(s_actions));
+  CHECK_OK(wifi_api_subscribe(WIFI_API_EVENT_WATCHDOG, &count_action, NULL,
+                              false));
+  wifi_api_reset_watchdog_stats();
+  wifi_api_reset_phase_stats();
+
+  wifi_api_watchdog_config_t config = WIFI_API_WATCHDOG_CONFIG_DEFAULT();
+  config.probe = WIFI_API_WATCHDOG_TCP;
+  config.host = "127.0.0.1";
+  config.port = port;
+  config.interval_ms = 1000;
+  config.failures = 2;
+  CHECK_OK(wifi_api_set_watchdog(&config));
+
+  sim_sleep_ms(3500);
+  wifi_api_watchdog_stats_t stats;
+  CHECK_OK(wifi_api_get_watchdog_stats(&stats));
+  CHECK(stats.probes == 3 && stats.failures == 0);
+  wifi_api_phase_stats_t phase;
+  CHECK_OK(wifi_api_get_phase_stats(WIFI_API_PHASE_PROBE, &phase));
+  CHECK(phase.count == 3);
+
+  // The uplink is gone
+  close(listener);
+  sim_sleep_ms(30000);
+  CHECK_OK(wifi_api_get_watchdog_stats(&stats));
+  CHECK(stats.failures >= 6);
+  CHECK(stats.actions[WIFI_API_WATCHDOG_RENEW_DHCP] == 1);
+  CHECK(stats.actions[WIFI_API_WATCHDOG_REASSOCIATE] == 1);
+  CHECK(stats.actions[WIFI_API_WATCHDOG_RESTART] >= 1);
+  CHECK(memcmp(s_actions, stats.actions, sizeof(s_actions)) == 0);
+
+  // Back on the same port, the next probes succeed
+  listener = listener_open(&port);
+  CHECK(listener >= 0);
+  CHECK(wifi_api_wait_state(WIFI_API_STATE_GOT_IP4, true, 60000) &
+        WIFI_API_STATE_GOT_IP4);
+  sim_sleep_ms(3000);
+  wifi_api_watchdog_stats_t later;
+  CHECK_OK(wifi_api_get_watchdog_stats(&later));
+  CHECK(later.probes > stats.probes);
+  CHECK(memcmp(later.actions, stats.actions, sizeof(later.actions)) == 0);
+
+  CHECK_OK(wifi_api_set_watchdog(NULL));
+  wifi_api_unsubscribe(WIFI_API_EVENT_WATCHDOG, &count_action, NULL);
+  CHECK_OK(wifi_api_disconnect());
+  close(listener);
+}
+
+int main()
+{
+  test_run("probe_tcp", &test_probe_tcp);
+  test_run("watchdog_tcp", &test_watchdog_tcp);
+  return s_test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
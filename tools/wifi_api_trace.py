@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Decode an event trace exported with wifi_api_trace_read().
+
+The input is the raw array of 12-byte wifi_api_trace_entry_t entries, e.g.
+written to a file, sent over UART or uploaded by the application.
+
+Usage: wifi_api_trace.py trace.bin
+"""
+
+import struct
+import sys
+
+ENTRY = struct.Struct("<IBBBbB3x")
+
+WIFI_EVENTS = {
+    0: "WIFI_READY",
+    1: "SCAN_DONE",
+    2: "STA_START",
+    3: "STA_STOP",
+    4: "STA_CONNECTED",
+    5: "STA_DISCONNECTED",
+    6: "STA_AUTHMODE_CHANGE",
+    18: "STA_BSS_RSSI_LOW",
+    21: "STA_BEACON_TIMEOUT",
+}
+
+IP_EVENTS = {
+    0: "STA_GOT_IP",
+    1: "STA_LOST_IP",
+    2: "AP_STAIPASSIGNED",
+    3: "GOT_IP6",
+}
+
+
+def decode(data):
+    for offset in range(0, len(data) - ENTRY.size + 1, ENTRY.size):
+        time_ms, base, event_id, reason, rssi, channel = ENTRY.unpack_from(
+            data, offset)
+        if base == 2:
+            print("---- reset ----")
+            continue
+
+        if base == 1:
+            name = "IP_EVENT_" + IP_EVENTS.get(event_id, str(event_id))
+        else:
+            name = "WIFI_EVENT_" + WIFI_EVENTS.get(event_id, str(event_id))
+
+        fields = []
+        if reason:
+            fields.append("reason=%u" % reason)
+        if rssi:
+            fields.append("rssi=%d" % rssi)
+        if channel:
+            fields.append("channel=%u" % channel)
+        print("%10u ms  %-30s %s" % (time_ms, name, " ".join(fields)))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__.strip())
+    with open(sys.argv[1], "rb") as trace:
+        decode(trace.read())
+
+
+if __name__ == "__main__":
+    main()
@@ -13,14 +13,23 @@
  */
 
 #include "wifi_api.h"
+#include "wifi_api_priv.h"
 
 #include <esp_event.h>
 #include <esp_log.h>
+#include <esp_mac.h>
 #include <esp_netif.h>
+#include <esp_netif_net_stack.h>
+#include <esp_random.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>
-#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+#include <inttypes.h>
+#include <lwip/dhcp.h>
 #include <nvs_flash.h>
+#include <ping/ping_sock.h>
 #include <string.h>
+#include <time.h>
 
 /**
  * @brief Tag for logging.
@@ -28,14 +37,26 @@
 static const char *TAG = "WIFI_API";
 
 /**
- * @brief Description for the Wi-Fi station interface.
+ * @brief Ticks the event handler and the timers wait for a free slot in the
+ * command queue.
  */
-static const char *NETIF_DESC_STA = "STA";
+static const TickType_t EVENT_POST_WAIT = pdMS_TO_TICKS(100);
+
+/**
+ * @brief Drop in dB below the last reported RSSI before the driver reports
+ * it again, and rise above the threshold before it is armed again.
+ */
+static const int8_t RSSI_HYSTERESIS_DB = 5;
+
+/**
+ * @brief Lowest RSSI threshold accepted by `esp_wifi_set_rssi_threshold`.
+ */
+static const int8_t RSSI_THRESHOLD_MIN = -100;
 
 /**
- * @brief Maximum number of retry attempts for Wi-Fi connection.
+ * @brief Description for the Wi-Fi station interface.
  */
-static const uint8_t MAX_RETRY = 10;
+static const char *NETIF_DESC_STA = "STA";
 
 /**
  * @brief Wi-Fi station network interface.
@@ -43,111 +64,1557 @@ static const uint8_t MAX_RETRY = 10;
 static esp_netif_t *s_sta_netif = NULL;
 
 /**
- * @brief Semaphore to signal IP acquisition.
+ * @brief Event group publishing the `WIFI_API_STATE_*` bits.
+ */
+static EventGroupHandle_t s_state_group = NULL;
+
+/**
+ * @brief Storage of `s_state_group`.
+ */
+static StaticEventGroup_t s_state_group_buffer;
+
+/**
+ * @brief Lock protecting the creation of `s_state_group`.
  */
-static SemaphoreHandle_t s_ip_semaphore = NULL;
+static portMUX_TYPE s_state_lock = portMUX_INITIALIZER_UNLOCKED;
 
 /**
  * @brief Number of retry attempts for Wi-Fi connection.
  */
 static int s_retry_num = 0;
 
+/**
+ * @brief Reconnection backoff configuration.
+ */
+static wifi_api_retry_config_t s_retry_config = WIFI_API_RETRY_CONFIG_DEFAULT();
+
+/**
+ * @brief Delay in milliseconds of the last scheduled reconnection attempt.
+ */
+static uint32_t s_retry_delay_ms = 0;
+
+/**
+ * @brief Whether the station got an IP address since `wifi_api_configure`.
+ *
+ * Once connected, reconnection attempts are no longer limited by
+ * `max_retry`.
+ */
+static bool s_connected_once = false;
+
+/**
+ * @brief Timer that fires the next reconnection attempt.
+ */
+static esp_timer_handle_t s_retry_timer = NULL;
+
+/**
+ * @brief Maximum number of entries in the retry policy table.
+ */
+#define RETRY_POLICY_SIZE 24
+
+/**
+ * @brief Retry policy entry mapping a disconnect reason to an action.
+ */
+typedef struct
+{
+  uint8_t reason;                  /**< `wifi_err_reason_t` value. */
+  wifi_api_retry_action_t action;  /**< Action taken on this reason. */
+  uint8_t limit;    /**< Occurrences before giving up, 0 for no limit. */
+  uint8_t attempts; /**< Occurrences since the last successful connection. */
+} wifi_api_retry_policy_t;
+
+/**
+ * @brief Retry policy table, reasons not listed use `WIFI_API_RETRY_BACKOFF`.
+ */
+static wifi_api_retry_policy_t s_retry_policy[RETRY_POLICY_SIZE] = {
+  {WIFI_REASON_BEACON_TIMEOUT, WIFI_API_RETRY_NOW, 0, 0},
+  {WIFI_REASON_AP_TSF_RESET, WIFI_API_RETRY_NOW, 0, 0},
+  {WIFI_REASON_NO_AP_FOUND, WIFI_API_RETRY_RESCAN, 0, 0},
+  {WIFI_REASON_ASSOC_FAIL, WIFI_API_RETRY_RESCAN, 0, 0},
+  {WIFI_REASON_CONNECTION_FAIL, WIFI_API_RETRY_RESCAN, 0, 0},
+  {WIFI_REASON_AUTH_FAIL, WIFI_API_RETRY_SWITCH_PROFILE,
+   CONFIG_WIFI_API_MAX_PROFILES, 0},
+  {WIFI_REASON_MIC_FAILURE, WIFI_API_RETRY_GIVE_UP, 0, 0},
+  {WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT, WIFI_API_RETRY_BACKOFF, 2, 0},
+  {WIFI_REASON_HANDSHAKE_TIMEOUT, WIFI_API_RETRY_BACKOFF, 2, 0},
+};
+
+/**
+ * @brief Number of used entries in `s_retry_policy`.
+ */
+static size_t s_retry_policy_len = 9;
+
+/**
+ * @brief Number of disconnections per reason, saturating at `UINT16_MAX`.
+ */
+static uint16_t s_reason_count[UINT8_MAX + 1] = {0};
+
+/**
+ * @brief Lock protecting `s_reason_count`, read from any task.
+ */
+static portMUX_TYPE s_reason_lock = portMUX_INITIALIZER_UNLOCKED;
+
 /**
  * @brief Event handler instance for any Wi-Fi event.
  */
 static esp_event_handler_instance_t instance_any_id = NULL;
 
 /**
- * @brief Event handler instance for IP acquisition event.
+ * @brief Event handler instance for any IP event.
+ */
+static esp_event_handler_instance_t instance_ip = NULL;
+
+/**
+ * @brief References held on the initialized driver, by `wifi_api_init`, by
+ * each reference on the started driver and by the connection.
+ */
+static uint32_t s_init_refs = 0;
+
+/**
+ * @brief References held on the started driver, by `wifi_api_start` and by
+ * the connection.
+ */
+static uint32_t s_start_refs = 0;
+
+/**
+ * @brief Whether a connection was requested by `wifi_api_configure` and not
+ * released by `wifi_api_disconnect`.
+ */
+static bool s_connect_requested = false;
+
+/**
+ * @brief Timer bounding the connection attempt started by
+ * `wifi_api_configure_async`.
+ */
+static esp_timer_handle_t s_connect_timer = NULL;
+
+/**
+ * @brief Whether a connection attempt is waiting for its result.
+ */
+static bool s_connect_pending = false;
+
+/**
+ * @brief Completion callback of the pending connection attempt.
+ */
+static wifi_api_connect_cb_t s_connect_cb = NULL;
+
+/**
+ * @brief User argument passed to `s_connect_cb`.
+ */
+static void *s_connect_cb_arg = NULL;
+
+/**
+ * @brief RSSI threshold of `WIFI_API_EVENT_RSSI_LOW`, 0 when disabled.
+ */
+static int8_t s_rssi_threshold = 0;
+
+/**
+ * @brief Whether the driver threshold was lowered after a crossing, until
+ * the RSSI recovers.
+ */
+static bool s_rssi_low = false;
+
+/**
+ * @brief BSSID of the last association, to detect roaming.
+ */
+static uint8_t s_last_bssid[6] = {0};
+
+/**
+ * @brief Whether the network is selected among the credential profiles.
+ */
+static bool s_profile_mode = false;
+
+/**
+ * @brief Time `wifi_api_configure` was called, 0 once the first IP is
+ * obtained.
+ */
+static int64_t s_configure_us = 0;
+
+/**
+ * @brief Time `esp_wifi_start()` was called, 0 once `STA_START` is received.
+ */
+static int64_t s_start_us = 0;
+
+/**
+ * @brief Time of the last `esp_wifi_connect()`, 0 once associated.
+ */
+static int64_t s_connect_us = 0;
+
+/**
+ * @brief Time of the last association, 0 once an IP is obtained.
+ */
+static int64_t s_associated_us = 0;
+
+/**
+ * @brief NVS namespace used to persist the component data.
+ */
+static const char *NVS_NAMESPACE = "wifi_api";
+
+/**
+ * @brief NVS key of the access point cache used for fast reconnect.
+ */
+static const char *NVS_KEY_AP_CACHE = "ap_cache";
+
+/**
+ * @brief Access point parameters captured on the last successful connection.
+ *
+ * Stored in NVS on `IP_EVENT_STA_GOT_IP` and used on the next connection to
+ * skip the all-channel scan by connecting directly to the known BSSID and
+ * channel.
+ */
+typedef struct
+{
+  uint8_t ssid[32];          /**< SSID the record belongs to. */
+  uint8_t bssid[6];          /**< MAC address of the access point. */
+  uint8_t channel;           /**< Primary channel of the access point. */
+  wifi_auth_mode_t authmode; /**< Authentication mode of the access point. */
+} wifi_api_ap_cache_t;
+
+/**
+ * @brief Last access point record loaded from or stored in NVS.
+ */
+static wifi_api_ap_cache_t s_ap_cache = {0};
+
+/**
+ * @brief Whether a directed (cached BSSID and channel) attempt is in progress.
+ */
+static bool s_fast_connect = false;
+
+/**
+ * @brief NVS key of the last DHCP lease used by the cached lease mode.
+ */
+static const char *NVS_KEY_IP_LEASE = "ip_lease";
+
+/**
+ * @brief Number of gateway probes used to revalidate a cached lease.
+ */
+static const uint32_t LEASE_PROBE_COUNT = 3;
+
+/**
+ * @brief Timestamps below this value (2020-01-01) mean the clock is not set.
+ */
+static const time_t VALID_EPOCH = 1577836800;
+
+/**
+ * @brief DHCP lease stored in NVS by the cached lease mode.
+ */
+typedef struct
+{
+  uint8_t ssid[32];          /**< SSID the lease was obtained on. */
+  wifi_api_ip_config_t ip;   /**< Address, netmask, gateway and DNS. */
+  uint32_t lease_time;       /**< Lease duration in seconds. */
+  int64_t obtained_at;       /**< Wall clock at acquisition, 0 if unknown. */
+} wifi_api_ip_lease_t;
+
+/**
+ * @brief Last lease loaded from or stored in NVS.
+ */
+static wifi_api_ip_lease_t s_ip_lease = {0};
+
+/**
+ * @brief IP configuration mode selected by `wifi_api_set_ip_mode`.
+ */
+static wifi_api_ip_mode_t s_ip_mode = WIFI_API_IP_MODE_DHCP;
+
+/**
+ * @brief Static IP configuration used by `WIFI_API_IP_MODE_STATIC`.
+ */
+static wifi_api_ip_config_t s_static_ip = {0};
+
+/**
+ * @brief Whether the current address was applied from the cached lease and
+ * still has to be revalidated.
+ */
+static bool s_lease_from_cache = false;
+
+/**
+ * @brief Timer that hands the cached lease over to DHCP when it expires.
+ */
+static esp_timer_handle_t s_lease_timer = NULL;
+
+/**
+ * @brief Whether the DHCP address is kept as a static one across a roam.
+ */
+static bool s_ip_held = false;
+
+/**
+ * @brief Get the state event group, creating it on first use.
+ *
+ * @return The event group handle.
+ */
+static EventGroupHandle_t state_group()
+{
+  taskENTER_CRITICAL(&s_state_lock);
+  if (!s_state_group)
+    s_state_group = xEventGroupCreateStatic(&s_state_group_buffer);
+  taskEXIT_CRITICAL(&s_state_lock);
+  return s_state_group;
+}
+
+void wifi_api_state_set(uint32_t bits)
+{
+  xEventGroupSetBits(state_group(), bits);
+}
+
+void wifi_api_state_clear(uint32_t bits)
+{
+  xEventGroupClearBits(state_group(), bits);
+}
+
+/**
+ * @brief Record the duration of a phase started at `*start_us`.
+ *
+ * @param phase The connection phase.
+ * @param start_us Start time of the phase, cleared once recorded.
+ * @param now Current time in microseconds.
+ */
+static void phase_end(wifi_api_phase_t phase, int64_t *start_us, int64_t now)
+{
+  if (*start_us == 0)
+    return;
+  wifi_api_phase_record(phase, now - *start_us);
+  *start_us = 0;
+}
+
+/**
+ * @brief Schedule the next reconnection attempt on `s_retry_timer`.
+ */
+static void retry_schedule();
+
+/**
+ * @brief Handle a disconnection according to the retry policy table.
+ *
+ * @param reason The disconnect reason reported by the driver.
+ */
+static void retry_policy_handle(uint8_t reason);
+
+/**
+ * @brief Completion callback of the profile selection scan.
+ *
+ * Connects directly to the best ranked access point, or handles the attempt
+ * as `WIFI_REASON_NO_AP_FOUND` if no profile network is in range.
+ *
+ * @param ap_count Number of scanned access points.
+ * @param status Scan status.
+ * @param arg User-defined argument (not used).
+ */
+static void profile_scan_done(uint16_t ap_count, esp_err_t status, void *arg)
+{
+  // The station may have been disconnected during the scan
+  if (!s_connect_requested)
+    return;
+
+  wifi_config_t wc;
+  if (status != ESP_OK || esp_wifi_get_config(WIFI_IF_STA, &wc) != ESP_OK ||
+      !wifi_api_profile_best(&wc))
+  {
+    ESP_LOGW(TAG, "No profile network among %u APs", ap_count);
+    retry_policy_handle(WIFI_REASON_NO_AP_FOUND);
+    return;
+  }
+
+  esp_wifi_set_config(WIFI_IF_STA, &wc);
+  esp_wifi_connect();
+}
+
+/**
+ * @brief Connect the station, starting the connect phase measurement.
+ *
+ * In profile mode, without a directed connect to the cached AP, a scan first
+ * selects the network and access point.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t sta_connect()
+{
+  s_connect_us = esp_timer_get_time();
+  if (!s_profile_mode || s_fast_connect)
+    return esp_wifi_connect();
+
+  esp_err_t err = wifi_api_profile_scan(&profile_scan_done);
+  if (err != ESP_OK)
+  {
+    ESP_LOGW(TAG, "Failed to start the profile scan: %s",
+             esp_err_to_name(err));
+    retry_schedule();
+  }
+  return err;
+}
+
+/**
+ * @brief Load the access point cache from NVS into `s_ap_cache`.
+ *
+ * @return true if a complete record was loaded, false otherwise.
+ */
+static bool ap_cache_load()
+{
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+  size_t length = sizeof(s_ap_cache);
+  if (err == ESP_OK)
+  {
+    err = nvs_get_blob(handle, NVS_KEY_AP_CACHE, &s_ap_cache, &length);
+    nvs_close(handle);
+  }
+
+  // A record left from a previous load would stop the next one being stored
+  if (err != ESP_OK || length != sizeof(s_ap_cache))
+  {
+    memset(&s_ap_cache, 0, sizeof(s_ap_cache));
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Store the currently associated access point in the NVS cache.
+ *
+ * The flash is only written when the record differs from the cached one.
+ */
+static void ap_cache_store()
+{
+  wifi_ap_record_t ap_info;
+  wifi_config_t wc;
+  if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK ||
+      esp_wifi_get_config(WIFI_IF_STA, &wc) != ESP_OK)
+    return;
+
+  wifi_api_ap_cache_t record = {0};
+  memcpy(record.ssid, wc.sta.ssid, sizeof(record.ssid));
+  memcpy(record.bssid, ap_info.bssid, sizeof(record.bssid));
+  record.channel = ap_info.primary;
+  record.authmode = ap_info.authmode;
+
+  if (memcmp(&record, &s_ap_cache, sizeof(record)) == 0)
+    return;
+
+  nvs_handle_t handle;
+  if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+  {
+    ESP_LOGW(TAG, "Failed to open NVS to store the AP cache");
+    return;
+  }
+  if (nvs_set_blob(handle, NVS_KEY_AP_CACHE, &record, sizeof(record)) ==
+        ESP_OK &&
+      nvs_commit(handle) == ESP_OK)
+  {
+    s_ap_cache = record;
+    ESP_LOGI(TAG, "Cached AP " MACSTR " on channel %u", MAC2STR(record.bssid),
+             record.channel);
+  }
+  nvs_close(handle);
+}
+
+/**
+ * @brief Erase the access point cache from NVS and memory.
+ */
+static void ap_cache_erase()
+{
+  memset(&s_ap_cache, 0, sizeof(s_ap_cache));
+
+  nvs_handle_t handle;
+  if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+    return;
+  if (nvs_erase_key(handle, NVS_KEY_AP_CACHE) == ESP_OK)
+    nvs_commit(handle);
+  nvs_close(handle);
+}
+
+/**
+ * @brief Remove the BSSID and channel lock from the station configuration, so
+ * the next connection scans all channels.
  */
-static esp_event_handler_instance_t instance_got_ip = NULL;
+static void sta_clear_bssid()
+{
+  wifi_config_t wc;
+  if (esp_wifi_get_config(WIFI_IF_STA, &wc) != ESP_OK)
+    return;
+  wc.sta.bssid_set = false;
+  memset(wc.sta.bssid, 0, sizeof(wc.sta.bssid));
+  wc.sta.channel = 0;
+  wc.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
+  esp_wifi_set_config(WIFI_IF_STA, &wc);
+}
+
+/**
+ * @brief Fall back from a failed directed attempt to a full channel scan.
+ *
+ * Clears the cached BSSID and channel from the station configuration, erases
+ * the stale cache and reconnects.
+ */
+static void fast_connect_fallback()
+{
+  ESP_LOGW(TAG, "Directed connect failed, falling back to a full scan");
+  s_fast_connect = false;
+  ap_cache_erase();
+  sta_clear_bssid();
+  sta_connect();
+}
+
+/**
+ * @brief Complete the pending connection attempt.
+ *
+ * Reports the result through the completion callback. Only the first result
+ * of an attempt is reported, later calls are ignored.
+ *
+ * @param result The result of the connection attempt.
+ */
+static void connect_complete(wifi_api_result_t result)
+{
+  if (result == WIFI_API_RESULT_FAILED)
+    wifi_api_state_set(WIFI_API_STATE_FAILED);
+
+  if (!s_connect_pending)
+    return;
+  s_connect_pending = false;
 
-void wifi_api_scan()
+  if (s_connect_timer)
+    esp_timer_stop(s_connect_timer);
+
+  if (s_connect_cb)
+    s_connect_cb(result, s_connect_cb_arg);
+}
+
+/**
+ * @brief Queue a command without arguments from a timer or event context.
+ *
+ * The command is latched when the queue is full, a lost timer would leave
+ * the connection without a retry or a result.
+ *
+ * @param id The command.
+ * @param value Argument of the command.
+ */
+static void post_command(wifi_api_cmd_id_t id, uint32_t value)
 {
-  ESP_LOGI(TAG, "Starting Wi-Fi scan...");
+  wifi_api_cmd_t cmd = {.id = id, .value = value};
+  wifi_api_task_post_latched(&cmd, EVENT_POST_WAIT);
+}
 
-  uint16_t number = 10;
-  wifi_ap_record_t ap_info[10];
-  uint16_t ap_count = 0;
-  memset(ap_info, 0, sizeof(ap_info));
+/**
+ * @brief Connection timeout timer callback.
+ *
+ * @param arg User-defined argument (not used).
+ */
+static void connect_timeout(void *arg)
+{
+  post_command(WIFI_API_CMD_CONNECT_TIMEOUT, 0);
+}
 
-  wifi_scan_config_t scan_config = {
-    .ssid = NULL, .bssid = NULL, .channel = 0, .show_hidden = true};
-  ESP_ERROR_CHECK(esp_wifi_scan_start(&scan_config, true));
+/**
+ * @brief Reconnection timer callback.
+ *
+ * @param arg User-defined argument (not used).
+ */
+static void retry_connect(void *arg)
+{
+  post_command(WIFI_API_CMD_RETRY, 0);
+}
+
+/**
+ * @brief Compute the next reconnection delay.
+ *
+ * Uses decorrelated jitter: a random delay between the base delay and three
+ * times the previous delay, capped at the maximum delay. This spreads the
+ * reconnections of many stations after an access point reboot.
+ *
+ * @return The delay in milliseconds.
+ */
+static uint32_t retry_next_delay()
+{
+  uint32_t base = s_retry_config.base_delay_ms;
+  uint64_t upper = (uint64_t)(s_retry_delay_ms ? s_retry_delay_ms : base) * 3;
+  if (upper > s_retry_config.max_delay_ms)
+    upper = s_retry_config.max_delay_ms;
+
+  uint32_t delay = base;
+  if (upper > base)
+    delay = base + esp_random() % (uint32_t)(upper - base + 1);
+
+  s_retry_delay_ms = delay;
+  return delay;
+}
+
+/**
+ * @brief Schedule the next reconnection attempt on `s_retry_timer`.
+ */
+static void retry_schedule()
+{
+  uint32_t delay = retry_next_delay();
+  s_retry_num++;
+
+  esp_timer_stop(s_retry_timer);
+  if (esp_timer_start_once(s_retry_timer, delay * 1000ULL) != ESP_OK)
+  {
+    sta_connect();
+    return;
+  }
+  ESP_LOGI(TAG, "Retry %d to connect to the AP in %" PRIu32 " ms",
+           s_retry_num, delay);
+}
+
+/**
+ * @brief Reset the reconnection backoff after a successful connection.
+ */
+static void retry_reset()
+{
+  s_retry_num = 0;
+  s_retry_delay_ms = 0;
+  esp_timer_stop(s_retry_timer);
+  for (size_t i = 0; i < s_retry_policy_len; i++)
+    s_retry_policy[i].attempts = 0;
+}
+
+/**
+ * @brief Find the retry policy entry of a disconnect reason.
+ *
+ * @param reason The disconnect reason.
+ * @return The entry, or NULL if the reason is not in the table.
+ */
+static wifi_api_retry_policy_t *retry_policy_find(uint8_t reason)
+{
+  for (size_t i = 0; i < s_retry_policy_len; i++)
+  {
+    if (s_retry_policy[i].reason == reason)
+      return &s_retry_policy[i];
+  }
+  return NULL;
+}
+
+/**
+ * @brief Set the action of a disconnect reason, on the Wi-Fi manager task.
+ *
+ * @param reason The disconnect reason.
+ * @param action The action.
+ * @param limit Occurrences before giving up, 0 for no limit.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the table is full.
+ */
+static esp_err_t retry_policy_set(uint8_t reason,
+                                  wifi_api_retry_action_t action,
+                                  uint8_t limit)
+{
+  wifi_api_retry_policy_t *policy = retry_policy_find(reason);
+  if (!policy)
+  {
+    if (s_retry_policy_len >= RETRY_POLICY_SIZE)
+      return ESP_ERR_NO_MEM;
+    policy = &s_retry_policy[s_retry_policy_len++];
+    policy->reason = reason;
+  }
+  policy->action = action;
+  policy->limit = limit;
+  policy->attempts = 0;
+  return ESP_OK;
+}
+
+/**
+ * @brief Handle a disconnection according to the retry policy table.
+ *
+ * @param reason The disconnect reason reported by the driver.
+ */
+static void retry_policy_handle(uint8_t reason)
+{
+  taskENTER_CRITICAL(&s_reason_lock);
+  if (s_reason_count[reason] < UINT16_MAX)
+    s_reason_count[reason]++;
+  taskEXIT_CRITICAL(&s_reason_lock);
+
+  // A failed directed attempt does not consume a retry
+  if (s_fast_connect)
+  {
+    fast_connect_fallback();
+    return;
+  }
+
+  wifi_api_retry_action_t action = WIFI_API_RETRY_BACKOFF;
+  wifi_api_retry_policy_t *policy = retry_policy_find(reason);
+  if (policy)
+  {
+    action = policy->action;
+    if (policy->attempts < UINT8_MAX)
+      policy->attempts++;
+    if (policy->limit > 0 && policy->attempts > policy->limit)
+      action = WIFI_API_RETRY_GIVE_UP;
+  }
+  if (!s_connected_once && s_retry_num >= s_retry_config.max_retry)
+    action = WIFI_API_RETRY_GIVE_UP;
+  // Without another profile the credentials of the network are wrong
+  if (action == WIFI_API_RETRY_SWITCH_PROFILE &&
+      (!s_profile_mode || wifi_api_get_profile_count() < 2))
+    action = WIFI_API_RETRY_GIVE_UP;
+
+  switch (action)
+  {
+    case WIFI_API_RETRY_NOW:
+      s_retry_num++;
+      ESP_LOGI(TAG, "Retry %d to connect to the AP (reason %u)", s_retry_num,
+               reason);
+      sta_connect();
+      break;
+    case WIFI_API_RETRY_RESCAN:
+      sta_clear_bssid();
+      retry_schedule();
+      break;
+    case WIFI_API_RETRY_SWITCH_PROFILE:
+      if (s_profile_mode)
+        wifi_api_profile_exclude_current();
+      sta_clear_bssid();
+      retry_schedule();
+      break;
+    case WIFI_API_RETRY_GIVE_UP:
+      ESP_LOGI(TAG, "Connect to the AP fail (reason %u)", reason);
+      connect_complete(WIFI_API_RESULT_FAILED);
+      break;
+    default:
+      retry_schedule();
+      break;
+  }
+}
+
+/**
+ * @brief Apply an IP configuration to the station interface.
+ *
+ * Stops the DHCP client and sets the address, netmask, gateway and DNS
+ * servers. `IP_EVENT_STA_GOT_IP` is posted by the netif once associated.
+ *
+ * @param[in] ip The IP configuration to apply.
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t ip_config_apply(const wifi_api_ip_config_t *ip)
+{
+  esp_err_t err = esp_netif_dhcpc_stop(s_sta_netif);
+  if (err != ESP_OK && err != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED)
+    return err;
+
+  err = esp_netif_set_ip_info(s_sta_netif, &ip->ip_info);
+  if (err != ESP_OK)
+    return err;
+
+  esp_netif_dns_info_t dns = {0};
+  dns.ip.type = ESP_IPADDR_TYPE_V4;
+  if (ip->dns_main.addr != 0)
+  {
+    dns.ip.u_addr.ip4 = ip->dns_main;
+    esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns);
+  }
+  if (ip->dns_backup.addr != 0)
+  {
+    dns.ip.u_addr.ip4 = ip->dns_backup;
+    esp_netif_set_dns_info(s_sta_netif, ESP_NETIF_DNS_BACKUP, &dns);
+  }
+  return ESP_OK;
+}
+
+/**
+ * @brief Start the DHCP client of the station interface, if it is stopped.
+ */
+static void ip_dhcp_start()
+{
+  esp_err_t err = esp_netif_dhcpc_start(s_sta_netif);
+  if (err != ESP_OK && err != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED)
+    ESP_LOGE(TAG, "Failed to start DHCP client: %s", esp_err_to_name(err));
+}
+
+/**
+ * @brief Stop using the applied cached lease and acquire an address through
+ * DHCP, the stored lease is kept.
+ */
+static void ip_lease_release()
+{
+  s_lease_from_cache = false;
+  if (s_lease_timer)
+    esp_timer_stop(s_lease_timer);
+  ip_dhcp_start();
+}
+
+/**
+ * @brief Drop the cached lease and acquire a new one through DHCP.
+ */
+static void ip_lease_invalidate()
+{
+  memset(&s_ip_lease, 0, sizeof(s_ip_lease));
+
+  nvs_handle_t handle;
+  if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) == ESP_OK)
+  {
+    if (nvs_erase_key(handle, NVS_KEY_IP_LEASE) == ESP_OK)
+      nvs_commit(handle);
+    nvs_close(handle);
+  }
+  ip_lease_release();
+}
+
+/**
+ * @brief Lease expiry timer callback.
+ *
+ * @param arg User-defined argument (not used).
+ */
+static void ip_lease_expired(void *arg)
+{
+  post_command(WIFI_API_CMD_LEASE_EXPIRED, 0);
+}
+
+/**
+ * @brief Load the cached lease and apply it if it is still usable.
+ *
+ * A lease is usable when it belongs to `ssid` and has not expired. When the
+ * clock is not set the expiry cannot be checked and the lease is applied,
+ * relying on the gateway probe to reject it.
+ *
+ * @param[in] ssid SSID of the network being connected to.
+ * @return true if the cached lease was applied, false otherwise.
+ */
+static bool ip_lease_apply(const char *ssid)
+{
+  wifi_api_ip_lease_t lease;
+  size_t length = sizeof(lease);
+  nvs_handle_t handle;
+  esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle);
+  if (err == ESP_OK)
+  {
+    err = nvs_get_blob(handle, NVS_KEY_IP_LEASE, &lease, &length);
+    nvs_close(handle);
+  }
+
+  // A lease left from a previous load would stop the next one being stored
+  if (err != ESP_OK || length != sizeof(lease))
+  {
+    memset(&s_ip_lease, 0, sizeof(s_ip_lease));
+    return false;
+  }
+  s_ip_lease = lease;
+  if (strncmp((const char *)lease.ssid, ssid, sizeof(lease.ssid)) != 0)
+    return false;
+
+  // Remaining lease time, or half of the lease when the clock is not set
+  int64_t remaining = lease.lease_time / 2;
+  time_t now = time(NULL);
+  if (now >= VALID_EPOCH && lease.obtained_at >= VALID_EPOCH)
+  {
+    remaining = lease.obtained_at + lease.lease_time - now;
+    if (remaining <= 0)
+    {
+      ESP_LOGI(TAG, "Cached lease expired, using DHCP");
+      return false;
+    }
+  }
+
+  if (ip_config_apply(&lease.ip) != ESP_OK)
+    return false;
+
+  if (!s_lease_timer)
+  {
+    const esp_timer_create_args_t timer_args = {
+      .callback = &ip_lease_expired, .name = "wifi_lease"};
+    if (esp_timer_create(&timer_args, &s_lease_timer) != ESP_OK)
+      s_lease_timer = NULL;
+  }
+  if (s_lease_timer && lease.lease_time > 0)
+  {
+    esp_timer_stop(s_lease_timer);
+    esp_timer_start_once(s_lease_timer, remaining * 1000000LL);
+  }
+
+  s_lease_from_cache = true;
+  ESP_LOGI(TAG, "Using cached lease " IPSTR, IP2STR(&lease.ip.ip_info.ip));
+  return true;
+}
+
+/**
+ * @brief Apply the cached lease of a network, or acquire an address through
+ * DHCP when it has none.
+ *
+ * @param[in] ssid SSID of the network being connected to.
+ */
+static void ip_lease_select(const char *ssid)
+{
+  if (!ip_lease_apply(ssid))
+    ip_lease_release();
+}
+
+/**
+ * @brief Store the lease obtained through DHCP in NVS.
+ *
+ * The flash is only written when the lease differs from the stored one. A
+ * renewal of the same address in the first half of the lease keeps the
+ * stored acquisition time, which then still leaves half of the lease.
+ *
+ * @param[in] ip_info The address information received with the event.
+ */
+static void ip_lease_store(const esp_netif_ip_info_t *ip_info)
+{
+  wifi_api_ip_lease_t lease = {0};
+  wifi_config_t wc;
+  if (esp_wifi_get_config(WIFI_IF_STA, &wc) != ESP_OK)
+    return;
+  memcpy(lease.ssid, wc.sta.ssid, sizeof(lease.ssid));
+  lease.ip.ip_info = *ip_info;
+
+  esp_netif_dns_info_t dns;
+  if (esp_netif_get_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK)
+    lease.ip.dns_main = dns.ip.u_addr.ip4;
+  if (esp_netif_get_dns_info(s_sta_netif, ESP_NETIF_DNS_BACKUP, &dns) ==
+      ESP_OK)
+    lease.ip.dns_backup = dns.ip.u_addr.ip4;
+
+  struct netif *lwip_netif = esp_netif_get_netif_impl(s_sta_netif);
+  struct dhcp *dhcp = lwip_netif ? netif_dhcp_data(lwip_netif) : NULL;
+  lease.lease_time = dhcp ? dhcp->offered_t0_lease : 0;
+
+  time_t now = time(NULL);
+  lease.obtained_at = now >= VALID_EPOCH ? now : 0;
+
+  wifi_api_ip_lease_t renewed = lease;
+  renewed.obtained_at = s_ip_lease.obtained_at;
+  if (memcmp(&renewed, &s_ip_lease, sizeof(renewed)) == 0 &&
+      (lease.obtained_at == 0 ||
+       now < s_ip_lease.obtained_at + (int64_t)s_ip_lease.lease_time / 2))
+    return;
+
+  nvs_handle_t handle;
+  if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+    return;
+  if (nvs_set_blob(handle, NVS_KEY_IP_LEASE, &lease, sizeof(lease)) ==
+        ESP_OK &&
+      nvs_commit(handle) == ESP_OK)
+    s_ip_lease = lease;
+  nvs_close(handle);
+}
+
+/**
+ * @brief Gateway probe completion callback.
+ *
+ * @param hdl Ping session handle.
+ * @param args User-defined argument (not used).
+ */
+static void ip_lease_probe_end(esp_ping_handle_t hdl, void *args)
+{
+  uint32_t received = 0;
+  esp_ping_get_profile(hdl, ESP_PING_PROF_REPLY, &received, sizeof(received));
+  esp_ping_delete_session(hdl);
+  post_command(WIFI_API_CMD_LEASE_PROBED, received);
+}
+
+/**
+ * @brief Keep the cached lease when the gateway answered the probe, otherwise
+ * fall back to DHCP.
+ *
+ * @param received Number of probe replies.
+ */
+static void ip_lease_probed(uint32_t received)
+{
+  if (received > 0)
+  {
+    ESP_LOGI(TAG, "Cached lease revalidated");
+    return;
+  }
+  ESP_LOGW(TAG, "Gateway unreachable with cached lease, using DHCP");
+  ip_lease_invalidate();
+}
+
+/**
+ * @brief Revalidate the cached lease in the background by probing the
+ * gateway.
+ *
+ * @param[in] ip_info The address information applied from the cache.
+ */
+static void ip_lease_revalidate(const esp_netif_ip_info_t *ip_info)
+{
+  s_lease_from_cache = false;
+
+  esp_ping_config_t config = ESP_PING_DEFAULT_CONFIG();
+  ip_addr_set_ip4_u32(&config.target_addr, ip_info->gw.addr);
+  config.count = LEASE_PROBE_COUNT;
+  config.interval_ms = 200;
+  config.timeout_ms = 500;
+  config.interface = esp_netif_get_netif_impl_index(s_sta_netif);
+
+  esp_ping_callbacks_t callbacks = {.on_ping_end = &ip_lease_probe_end};
+  esp_ping_handle_t ping;
+  if (esp_ping_new_session(&config, &callbacks, &ping) != ESP_OK ||
+      esp_ping_start(ping) != ESP_OK)
+  {
+    ESP_LOGW(TAG, "Failed to probe the gateway, using DHCP");
+    ip_lease_invalidate();
+  }
+}
+
+void wifi_api_ip_hold(bool hold)
+{
+  if (!hold)
+  {
+    if (!s_ip_held)
+      return;
+    // DHCP takes over from a cached lease as well
+    s_ip_held = false;
+    ip_lease_release();
+    return;
+  }
+
+  // A static address is kept by the interface anyway
+  if (s_ip_held || s_ip_mode == WIFI_API_IP_MODE_STATIC ||
+      !(wifi_api_get_state() & WIFI_API_STATE_GOT_IP4))
+    return;
+
+  wifi_api_ip_config_t ip = {0};
+  esp_netif_dns_info_t dns;
+  if (esp_netif_get_ip_info(s_sta_netif, &ip.ip_info) != ESP_OK)
+    return;
+  if (esp_netif_get_dns_info(s_sta_netif, ESP_NETIF_DNS_MAIN, &dns) == ESP_OK)
+    ip.dns_main = dns.ip.u_addr.ip4;
+  if (esp_netif_get_dns_info(s_sta_netif, ESP_NETIF_DNS_BACKUP, &dns) ==
+      ESP_OK)
+    ip.dns_backup = dns.ip.u_addr.ip4;
+
+  esp_err_t err = ip_config_apply(&ip);
+  if (err != ESP_OK)
+  {
+    ESP_LOGW(TAG, "Failed to keep the address across the roam: %s",
+             esp_err_to_name(err));
+    ip_dhcp_start();
+    return;
+  }
+  s_ip_held = true;
+}
+
+/**
+ * @brief Get the highest of the RSSI low event and roaming thresholds.
+ *
+ * @return The threshold in dBm, 0 when both are disabled.
+ */
+static int8_t rssi_threshold_get()
+{
+  int8_t threshold = s_rssi_threshold;
+  int8_t roam = wifi_api_roam_threshold();
+  if (threshold == 0 || (roam != 0 && roam > threshold))
+    threshold = roam;
+  return threshold;
+}
+
+/**
+ * @brief Arm the driver RSSI threshold at the highest of the RSSI low event
+ * and roaming thresholds.
+ */
+static void rssi_threshold_arm()
+{
+  s_rssi_low = false;
+  int8_t threshold = rssi_threshold_get();
+  if (threshold != 0)
+    esp_wifi_set_rssi_threshold(threshold);
+}
+
+/**
+ * @brief Rearm the driver RSSI threshold after a crossing.
+ *
+ * The driver reports the crossing once. Armed again at the same threshold,
+ * it would report it on every beacon while the RSSI stays below, so only a
+ * further drop is reported until the RSSI recovers.
+ *
+ * @param rssi The RSSI reported by the crossing.
+ */
+static void rssi_threshold_lower(int8_t rssi)
+{
+  s_rssi_low = true;
+  if (rssi - RSSI_HYSTERESIS_DB >= RSSI_THRESHOLD_MIN)
+    esp_wifi_set_rssi_threshold(rssi - RSSI_HYSTERESIS_DB);
+}
+
+/**
+ * @brief Arm the threshold again once a link sample shows that the RSSI
+ * recovered above it.
+ */
+static void rssi_threshold_recover()
+{
+  wifi_api_link_quality_t quality;
+  if (!s_rssi_low || wifi_api_get_link_quality(&quality) != ESP_OK ||
+      !quality.connected || quality.samples == 0)
+    return;
+
+  int8_t threshold = rssi_threshold_get();
+  if (threshold == 0 || quality.rssi >= threshold + RSSI_HYSTERESIS_DB)
+    rssi_threshold_arm();
+}
+
+/**
+ * @brief Publish `WIFI_API_EVENT_LOST_IP` if an IPv4 address was held.
+ */
+static void ip_lost()
+{
+  uint32_t state = wifi_api_get_state();
+  wifi_api_state_clear(WIFI_API_STATE_GOT_IP4);
+  if (!(state & WIFI_API_STATE_GOT_IP4))
+    return;
+
+  wifi_api_event_data_t data = {.event = WIFI_API_EVENT_LOST_IP};
+  wifi_api_event_publish(&data);
+}
+
+/**
+ * @brief Whether the station joined another AP of the network than the last
+ * one.
+ *
+ * @param event The connected event data.
+ * @return true if the BSSID changed since the last connection.
+ */
+static bool sta_moved(const wifi_event_sta_connected_t *event)
+{
+  return s_connected_once &&
+         memcmp(s_last_bssid, event->bssid, sizeof(s_last_bssid)) != 0;
+}
+
+/**
+ * @brief Publish `WIFI_API_EVENT_ROAM` when the station reassociates with
+ * another AP of the network.
+ *
+ * @param event The connected event data.
+ * @param moved Whether the BSSID changed, from `sta_moved`.
+ */
+static void sta_associated(const wifi_event_sta_connected_t *event,
+                           bool moved)
+{
+  memcpy(s_last_bssid, event->bssid, sizeof(s_last_bssid));
+  if (!moved)
+    return;
+
+  wifi_api_event_data_t data = {.event = WIFI_API_EVENT_ROAM};
+  memcpy(data.roam.bssid, event->bssid, sizeof(data.roam.bssid));
+  data.roam.channel = event->channel;
+  wifi_ap_record_t ap;
+  if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK)
+    data.roam.rssi = ap.rssi;
+  wifi_api_event_publish(&data);
+}
+
+/**
+ * @brief Handle a Wi-Fi or IP event on the Wi-Fi manager task.
+ *
+ * This function handles various Wi-Fi and IP events such as station start,
+ * disconnection, and IP acquisition. It attempts to reconnect on
+ * disconnection and signals when an IP address is obtained.
+ *
+ * @param event_base Base ID of the event.
+ * @param event_id ID of the event.
+ * @param event_data Event-specific data.
+ */
+static void event_dispatch(esp_event_base_t event_base, int32_t event_id,
+                           const void *event_data)
+{
+  if (event_base == IP_EVENT)
+  {
+    if (event_id == IP_EVENT_GOT_IP6)
+    {
+      wifi_api_state_set(WIFI_API_STATE_GOT_IP6);
+      return;
+    }
+    if (event_id == IP_EVENT_STA_LOST_IP)
+    {
+      ip_lost();
+      return;
+    }
+    if (event_id != IP_EVENT_STA_GOT_IP)
+      return;
+    // The address held across a roam is announced when it is set and when
+    // the new AP is joined, it is reported once DHCP renewed it
+    if (s_ip_held)
+    {
+      if (!(wifi_api_get_state() & WIFI_API_STATE_ROAMING))
+        wifi_api_ip_hold(false);
+      return;
+    }
+
+    wifi_api_state_clear(WIFI_API_STATE_FAILED);
+    wifi_api_state_set(WIFI_API_STATE_GOT_IP4);
+    int64_t now = esp_timer_get_time();
+    phase_end(WIFI_API_PHASE_DHCP, &s_associated_us, now);
+    phase_end(WIFI_API_PHASE_TOTAL, &s_configure_us, now);
+    retry_reset();
+    s_connected_once = true;
+    s_fast_connect = false;
+    if (s_profile_mode)
+      wifi_api_profile_reset_exclusions();
+    const ip_event_got_ip_t *event = (const ip_event_got_ip_t *)event_data;
+    ESP_LOGI(TAG, "Got ip:" IPSTR, IP2STR(&event->ip_info.ip));
+    ap_cache_store();
+    if (s_lease_from_cache)
+      ip_lease_revalidate(&event->ip_info);
+    else if (s_ip_mode == WIFI_API_IP_MODE_CACHED_LEASE)
+      ip_lease_store(&event->ip_info);
+    connect_complete(WIFI_API_RESULT_CONNECTED);
+
+    wifi_api_event_data_t data = {.event = WIFI_API_EVENT_CONNECTED};
+    data.connected.ip_info = event->ip_info;
+    wifi_api_event_publish(&data);
+    return;
+  }
+
+  switch (event_id)
+  {
+    case WIFI_EVENT_STA_START:
+    {
+      wifi_api_state_set(WIFI_API_STATE_STARTED);
+      phase_end(WIFI_API_PHASE_START, &s_start_us, esp_timer_get_time());
+      wifi_api_power_started();
+      if (s_connect_requested)
+        sta_connect();
+      break;
+    }
+    case WIFI_EVENT_STA_STOP:
+    {
+      wifi_api_state_clear(WIFI_API_STATE_STARTED | WIFI_API_STATE_ASSOCIATED |
+                           WIFI_API_STATE_GOT_IP4 | WIFI_API_STATE_GOT_IP6);
+      break;
+    }
+    case WIFI_EVENT_STA_CONNECTED:
+    {
+      const wifi_event_sta_connected_t *event =
+        (const wifi_event_sta_connected_t *)event_data;
+      bool moved = sta_moved(event);
+      wifi_api_state_set(WIFI_API_STATE_ASSOCIATED);
+      s_associated_us = esp_timer_get_time();
+      phase_end(WIFI_API_PHASE_CONNECT, &s_connect_us, s_associated_us);
+#if CONFIG_LWIP_IPV6
+      esp_netif_create_ip6_linklocal(s_sta_netif);
+#endif
+      rssi_threshold_arm();
+      wifi_api_power_attach(s_sta_netif);
+      wifi_api_roam_associated(moved);
+      wifi_api_link_associated(event, s_retry_num + 1);
+      sta_associated(event, moved);
+      break;
+    }
+    case WIFI_EVENT_STA_BSS_RSSI_LOW:
+    {
+      const wifi_event_bss_rssi_low_t *event =
+        (const wifi_event_bss_rssi_low_t *)event_data;
+      int8_t rssi = (int8_t)event->rssi;
+      if (s_rssi_threshold != 0 && rssi <= s_rssi_threshold)
+      {
+        wifi_api_event_data_t data = {.event = WIFI_API_EVENT_RSSI_LOW};
+        data.rssi_low.rssi = rssi;
+        wifi_api_event_publish(&data);
+      }
+      wifi_api_roam_rssi_low(rssi);
+      rssi_threshold_lower(rssi);
+      break;
+    }
+    case WIFI_EVENT_STA_DISCONNECTED:
+    {
+      const wifi_event_sta_disconnected_t *event =
+        (const wifi_event_sta_disconnected_t *)event_data;
+      wifi_api_state_clear(WIFI_API_STATE_ASSOCIATED);
+      wifi_api_link_disconnected();
+
+      // The address held while leaving the old AP of a roam is kept, it is
+      // restored by the interface on the new AP
+      bool roaming = wifi_api_get_state() & WIFI_API_STATE_ROAMING;
+      bool roam_leave = wifi_api_roam_disconnected(event->reason);
+      if (!roam_leave || !s_ip_held)
+      {
+        wifi_api_ip_hold(false);
+        ip_lost();
+      }
+      wifi_api_state_clear(WIFI_API_STATE_GOT_IP6);
+      if (roam_leave || !s_connect_requested)
+        break;
+      if (roaming)
+        sta_clear_bssid();
+      retry_policy_handle(event->reason);
+      break;
+    }
+    case WIFI_EVENT_STA_BEACON_TIMEOUT:
+    {
+      wifi_api_link_beacon_timeout();
+      break;
+    }
+    case WIFI_EVENT_SCAN_DONE:
+    {
+      wifi_api_scan_handle_done((const wifi_event_sta_scan_done_t *)event_data);
+      break;
+    }
+    case WIFI_EVENT_STA_NEIGHBOR_REP:
+    {
+      const wifi_api_neighbors_t *neighbors =
+        (const wifi_api_neighbors_t *)event_data;
+      wifi_api_roam_neighbors(neighbors->channels, neighbors->count);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Event handler for Wi-Fi and IP events.
+ *
+ * Copies the event into a command and forwards it to the Wi-Fi manager task,
+ * which owns the state of the component.
+ *
+ * @param arg User-defined argument (not used).
+ * @param event_base Base ID of the event.
+ * @param event_id ID of the event.
+ * @param event_data Event-specific data.
+ */
+static void wifi_api_event_handler(void *arg, esp_event_base_t event_base,
+                                   int32_t event_id, void *event_data)
+{
+  // Forwarded by the handler of the scan module, which outlives this one
+  if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE)
+    return;
+
+  wifi_api_trace_record(event_base, event_id, event_data);
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_EVENT};
+  cmd.event.base = event_base;
+  cmd.event.id = event_id;
+
+  size_t size = 0;
+  if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
+    size = sizeof(cmd.event.data.got_ip);
+  else if (event_base == IP_EVENT && event_id == IP_EVENT_GOT_IP6)
+    size = sizeof(cmd.event.data.got_ip6);
+  else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    size = sizeof(cmd.event.data.connected);
+  else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+    size = sizeof(cmd.event.data.disconnected);
+  else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_BSS_RSSI_LOW)
+    size = sizeof(cmd.event.data.rssi_low);
+  else if (event_base == WIFI_EVENT &&
+           event_id == WIFI_EVENT_STA_NEIGHBOR_REP && event_data)
+  {
+    // Too large to be queued, only the neighbor channels are kept
+    const wifi_event_neighbor_report_t *report = event_data;
+    cmd.event.data.neighbors.count = wifi_api_roam_parse_neighbors(
+      report->report, report->report_len, cmd.event.data.neighbors.channels,
+      sizeof(cmd.event.data.neighbors.channels));
+  }
+  if (size > 0 && event_data)
+    memcpy(&cmd.event.data, event_data, size);
+
+  // A lost state change would stop the reconnection or leave a stale state,
+  // so events are latched when the queue is full, every event so none is
+  // handled ahead of an earlier latched one
+  wifi_api_task_post_latched(&cmd, EVENT_POST_WAIT);
+}
+
+/**
+ * @brief Unregister the event handlers and release the driver and the
+ * station interface.
+ */
+static void driver_deinit()
+{
+  if (instance_any_id)
+    esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID,
+                                          instance_any_id);
+  if (instance_ip)
+    esp_event_handler_instance_unregister(IP_EVENT, ESP_EVENT_ANY_ID,
+                                          instance_ip);
+  instance_any_id = NULL;
+  instance_ip = NULL;
+
+  esp_wifi_deinit();
+  if (s_sta_netif)
+  {
+    esp_wifi_clear_default_wifi_driver_and_handlers(s_sta_netif);
+    esp_netif_destroy(s_sta_netif);
+    s_sta_netif = NULL;
+  }
+}
+
+/**
+ * @brief Shut down Wi-Fi and release all resources.
+ *
+ * Registered as a shutdown handler while the driver is initialized, so it
+ * runs on `esp_restart` whatever references are held.
+ */
+static void wifi_api_shutdown()
+{
+  ESP_LOGI(TAG, "Shutting down Wi-Fi...");
+  if (s_start_refs > 0)
+    esp_wifi_stop();
+  driver_deinit();
+  s_start_refs = 0;
+  s_init_refs = 0;
+}
+
+/**
+ * @brief Initialize the Non-Volatile Storage (NVS) flash.
+ *
+ * This function initializes the NVS flash, which is required for storing
+ * persistent data such as Wi-Fi credentials.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t initialize_nvs()
+{
+  return nvs_flash_init();
+}
+
+/**
+ * @brief Take a reference on the initialized driver, initializing it with
+ * the first one.
+ *
+ * NVS, the TCP/IP stack and the default event loop are shared with the
+ * application and never released, so they are only initialized once. The
+ * event handlers stay registered until the driver is deinitialized.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t init_acquire()
+{
+  if (s_init_refs > 0)
+  {
+    s_init_refs++;
+    return ESP_OK;
+  }
+
+  esp_err_t err = initialize_nvs();
+  if (err == ESP_OK)
+    err = esp_netif_init();
+  if (err == ESP_OK)
+  {
+    // The application may have created the default loop already
+    err = esp_event_loop_create_default();
+    if (err == ESP_ERR_INVALID_STATE)
+      err = ESP_OK;
+  }
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Failed to initialize the network stack: %s",
+             esp_err_to_name(err));
+    return err;
+  }
+
+  wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+  wifi_api_driver_config(&cfg);
+  size_t free_before = wifi_api_driver_free_ram();
+  err = esp_wifi_init(&cfg);
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Failed to initialize the driver: %s", esp_err_to_name(err));
+    return err;
+  }
+  wifi_api_driver_initialized(free_before);
+  esp_netif_inherent_config_t nif_cfg = ESP_NETIF_INHERENT_DEFAULT_WIFI_STA();
+  nif_cfg.if_desc = NETIF_DESC_STA;
+  s_sta_netif = esp_netif_create_wifi(WIFI_IF_STA, &nif_cfg);
+  if (!s_sta_netif)
+  {
+    ESP_LOGE(TAG, "Failed to create the station interface");
+    driver_deinit();
+    return ESP_ERR_NO_MEM;
+  }
+  esp_wifi_set_default_wifi_sta_handlers();
+
+  err = esp_event_handler_instance_register(
+    WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_api_event_handler, NULL,
+    &instance_any_id);
+  if (err == ESP_OK)
+    err = esp_event_handler_instance_register(
+      IP_EVENT, ESP_EVENT_ANY_ID, &wifi_api_event_handler, NULL, &instance_ip);
+  if (err == ESP_OK)
+    err = wifi_api_scan_attach();
+  if (err == ESP_OK)
+    err = esp_wifi_set_storage(WIFI_STORAGE_RAM);
+  if (err == ESP_OK)
+    err = esp_wifi_set_mode(WIFI_MODE_STA);
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Failed to set up the station: %s", esp_err_to_name(err));
+    driver_deinit();
+    return err;
+  }
+
+  err = esp_register_shutdown_handler(&wifi_api_shutdown);
+  if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    ESP_LOGW(TAG, "Failed to register shutdown handler");
+
+  s_init_refs = 1;
+  ESP_LOGI(TAG, "Wi-Fi driver initialized");
+  return ESP_OK;
+}
+
+/**
+ * @brief Release a reference on the initialized driver, deinitializing it
+ * with the last one.
+ */
+static void init_release()
+{
+  if (--s_init_refs > 0)
+    return;
 
-  ESP_LOGI(TAG, "Max AP number ap_info can hold = %u", number);
+  esp_unregister_shutdown_handler(&wifi_api_shutdown);
+  driver_deinit();
+  ESP_LOGI(TAG, "Wi-Fi driver deinitialized");
+}
 
-  ESP_ERROR_CHECK(esp_wifi_scan_get_ap_num(&ap_count));
-  ESP_ERROR_CHECK(esp_wifi_scan_get_ap_records(&number, ap_info));
+/**
+ * @brief Take a reference on the started driver, starting it with the first
+ * one. The caller holds a reference on the initialized driver.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t start_acquire()
+{
+  if (s_start_refs > 0)
+  {
+    s_start_refs++;
+    return ESP_OK;
+  }
 
-  ESP_LOGI(TAG, "Total APs scanned = %u, actual AP number ap_info holds = %u",
-           ap_count, number);
-  for (int i = 0; i < number; i++)
+  s_start_us = esp_timer_get_time();
+  esp_err_t err = esp_wifi_start();
+  if (err != ESP_OK)
   {
-    ESP_LOGI(TAG, "SSID \t\t%s", ap_info[i].ssid);
-    ESP_LOGI(TAG, "RSSI \t\t%d", ap_info[i].rssi);
-    ESP_LOGI(TAG, "Authmode \t%s",
-             ap_info[i].authmode == WIFI_AUTH_OPEN
-               ? "WIFI_AUTH_OPEN"
-               : (ap_info[i].authmode == WIFI_AUTH_WEP
-                    ? "WIFI_AUTH_WEP"
-                    : (ap_info[i].authmode == WIFI_AUTH_WPA_PSK
-                         ? "WIFI_AUTH_WPA_PSK"
-                         : (ap_info[i].authmode == WIFI_AUTH_WPA2_PSK
-                              ? "WIFI_AUTH_WPA2_PSK"
-                              : (ap_info[i].authmode == WIFI_AUTH_WPA_WPA2_PSK
-                                   ? "WIFI_AUTH_WPA_WPA2_PSK"
-                                   : "WIFI_AUTH_UNKNOWN")))));
-    ESP_LOGI(TAG, "Channel \t\t%d", ap_info[i].primary);
+    ESP_LOGE(TAG, "Failed to start the driver: %s", esp_err_to_name(err));
+    return err;
   }
+  s_start_refs = 1;
+  return ESP_OK;
 }
 
 /**
- * @brief Event handler for Wi-Fi and IP events.
+ * @brief Stop the driver and clear the connection state.
+ */
+static void driver_stop()
+{
+  esp_wifi_stop();
+  wifi_api_power_stopped();
+  wifi_api_link_disconnected();
+  ip_lost();
+  wifi_api_state_clear(WIFI_API_STATE_STARTED | WIFI_API_STATE_ASSOCIATED |
+                       WIFI_API_STATE_GOT_IP6);
+}
+
+/**
+ * @brief Start a recovery action of the connectivity watchdog.
  *
- * This function handles various Wi-Fi and IP events such as station start,
- * disconnection, and IP acquisition. It attempts to reconnect on
- * disconnection and signals when an IP address is obtained.
+ * The connection is requested, so the retry policy reconnects after a
+ * reassociation and the start event after a driver restart.
  *
- * @param arg User-defined argument (not used).
- * @param event_base Base ID of the event.
- * @param event_id ID of the event.
- * @param event_data Event-specific data.
+ * @param action The recovery action.
  */
-static void wifi_api_event_handler(void *arg, esp_event_base_t event_base,
-                                   int32_t event_id, void *event_data)
+static void watchdog_recover(wifi_api_watchdog_action_t action)
 {
-  switch (event_id)
+  switch (action)
   {
-    case WIFI_EVENT_STA_START:
-    {
-      esp_wifi_connect();
-      break;
-    }
-    case WIFI_EVENT_STA_DISCONNECTED:
-    {
-      if (s_retry_num < MAX_RETRY)
-      {
-        esp_wifi_connect();
-        s_retry_num++;
-        ESP_LOGI(TAG, "Retry to connect to the AP");
-      }
-      else
+    case WIFI_API_WATCHDOG_RENEW_DHCP:
+      if (s_ip_mode != WIFI_API_IP_MODE_STATIC)
       {
-        // Making available to `xSemaphoreTake` in `wifi_api_configure`, i.e.,
-        // allows the application to continue execution below the
-        // `xSemaphoreTake()` call
-        xSemaphoreGive(s_ip_semaphore);
-        ESP_LOGI(TAG, "Connect to the AP fail");
+        // Also drops a cached lease, the next one comes from the server
+        esp_netif_dhcpc_stop(s_sta_netif);
+        ip_lease_invalidate();
+        break;
       }
+      // A static address has no lease, reassociate instead
+      // fall through
+    case WIFI_API_WATCHDOG_REASSOCIATE:
+      esp_wifi_disconnect();
       break;
-    }
-    case IP_EVENT_STA_GOT_IP:
+    case WIFI_API_WATCHDOG_RESTART:
     {
-      s_retry_num = 0;
-      ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
-      ESP_LOGI(TAG, "Got ip:" IPSTR, IP2STR(&event->ip_info.ip));
-      xSemaphoreGive(s_ip_semaphore);
+      driver_stop();
+      s_start_us = esp_timer_get_time();
+      esp_err_t err = esp_wifi_start();
+      if (err != ESP_OK)
+        ESP_LOGE(TAG, "Failed to restart the driver: %s", esp_err_to_name(err));
       break;
     }
     default:
@@ -156,69 +1623,141 @@ static void wifi_api_event_handler(void *arg, esp_event_base_t event_base,
 }
 
 /**
- * @brief Shut down Wi-Fi and release all resources.
+ * @brief Release a reference on the started driver, stopping it with the
+ * last one.
  *
- * Deinitializes the Wi-Fi interface, destroys semaphores, and clears Wi-Fi
- * drivers.
+ * The state is cleared here, as the stop event is lost if the handlers are
+ * unregistered right after.
+ */
+static void start_release()
+{
+  if (--s_start_refs > 0)
+    return;
+
+  driver_stop();
+}
+
+/**
+ * @brief Release a reference taken by `wifi_api_deinit`, on the Wi-Fi
+ * manager task.
  *
- * @return ESP_OK on success, ESP_FAIL on failure.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if only the started driver
+ * and the connection hold references.
  */
-static void wifi_api_shutdown()
+static esp_err_t deinit_execute()
 {
-  ESP_LOGI(TAG, "Shutting down Wi-Fi...");
-  ESP_ERROR_CHECK(esp_wifi_stop());
-  ESP_ERROR_CHECK(esp_wifi_deinit());
-  ESP_ERROR_CHECK(esp_wifi_clear_default_wifi_driver_and_handlers(s_sta_netif));
-  esp_netif_destroy(s_sta_netif);
-  s_sta_netif = NULL;
+  if (s_init_refs <= s_start_refs)
+    return ESP_ERR_INVALID_STATE;
+
+  init_release();
+  return ESP_OK;
 }
 
 /**
- * @brief Initialize the Non-Volatile Storage (NVS) flash.
+ * @brief Take a reference on the started driver, on the Wi-Fi manager task.
  *
- * This function initializes the NVS flash, which is required for storing
- * persistent data such as Wi-Fi credentials. It checks for errors during
- * initialization and handles them appropriately.
+ * @return ESP_OK on success, an error code otherwise.
  */
-static void initialize_nvs()
+static esp_err_t start_execute()
 {
-  ESP_ERROR_CHECK(nvs_flash_init());
+  esp_err_t err = init_acquire();
+  if (err != ESP_OK)
+    return err;
+
+  err = start_acquire();
+  if (err != ESP_OK)
+    init_release();
+  return err;
 }
 
-// TODO: Implement error handling for all ESP_ERROR_CHECK calls
-// TODO: Improve the wifi callback functions in
-// `esp_event_handler_instance_register`
-esp_err_t wifi_api_configure(const char *ssid, const char *password)
+/**
+ * @brief Release a reference taken by `wifi_api_start`, on the Wi-Fi manager
+ * task.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if only the connection
+ * holds a reference.
+ */
+static esp_err_t stop_execute()
+{
+  if (s_start_refs <= (s_connect_requested ? 1U : 0U))
+    return ESP_ERR_INVALID_STATE;
+
+  start_release();
+  init_release();
+  return ESP_OK;
+}
+
+/**
+ * @brief Initialize the station and start connecting, on the Wi-Fi manager
+ * task.
+ *
+ * @param ssid The SSID of the Wi-Fi network.
+ * @param password The password for the Wi-Fi network.
+ * @param timeout_ms Connection timeout in milliseconds, 0 for none.
+ * @param callback Connection result callback, may be NULL.
+ * @param arg User argument passed to `callback`.
+ * @return ESP_OK if the connection was started, an error code otherwise.
+ */
+static esp_err_t configure_execute(const char *ssid, const char *password,
+                                   uint32_t timeout_ms,
+                                   wifi_api_connect_cb_t callback, void *arg)
 {
-  initialize_nvs();
+  s_configure_us = esp_timer_get_time();
+  int64_t driver_init_us = s_configure_us;
 
   ESP_LOGI(TAG, "Configuring Wi-Fi...");
-  s_ip_semaphore = xSemaphoreCreateBinary();
-  if (!s_ip_semaphore)
+
+  esp_err_t err = ESP_OK;
+  if (!s_connect_timer)
   {
-    ESP_LOGE(TAG, "Failed to create semaphore");
-    return ESP_FAIL;
+    const esp_timer_create_args_t timer_args = {
+      .callback = &connect_timeout, .name = "wifi_connect"};
+    err = esp_timer_create(&timer_args, &s_connect_timer);
+  }
+  if (err == ESP_OK && !s_retry_timer)
+  {
+    const esp_timer_create_args_t timer_args = {
+      .callback = &retry_connect, .name = "wifi_retry"};
+    err = esp_timer_create(&timer_args, &s_retry_timer);
+  }
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Failed to create the timers: %s", esp_err_to_name(err));
+    return err;
   }
 
-  // --------------------------------------------------------------------
-
-  ESP_ERROR_CHECK(esp_netif_init());
-  ESP_ERROR_CHECK(esp_event_loop_create_default());
-
-  // --------------------------------------------------------------------
+  // The attempt being replaced still gets a result, before its callback and
+  // deadline are dropped
+  if (s_connect_pending)
+  {
+    ESP_LOGW(TAG, "Connection attempt superseded");
+    connect_complete(WIFI_API_RESULT_TIMEOUT);
+  }
+  esp_timer_stop(s_connect_timer);
+  retry_reset();
+  s_connected_once = false;
 
-  wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
-  ESP_ERROR_CHECK(esp_wifi_init(&cfg));
-  esp_netif_inherent_config_t nif_cfg = ESP_NETIF_INHERENT_DEFAULT_WIFI_STA();
-  nif_cfg.if_desc = NETIF_DESC_STA;
-  s_sta_netif = esp_netif_create_wifi(WIFI_IF_STA, &nif_cfg);
-  esp_wifi_set_default_wifi_sta_handlers();
+  // Drop the state left by a previous attempt
+  wifi_api_state_clear(WIFI_API_STATE_ASSOCIATED | WIFI_API_STATE_GOT_IP4 |
+                       WIFI_API_STATE_GOT_IP6 | WIFI_API_STATE_FAILED);
+  s_connect_cb = callback;
+  s_connect_cb_arg = arg;
+  s_connect_pending = true;
 
   // --------------------------------------------------------------------
 
-  ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
-  ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-  ESP_ERROR_CHECK(esp_wifi_start());
+  // A reconfiguration keeps the references taken by the first configuration,
+  // an initialized driver is reused
+  bool reconfigure = s_connect_requested;
+  if (!reconfigure)
+  {
+    err = init_acquire();
+    if (err != ESP_OK)
+    {
+      connect_complete(WIFI_API_RESULT_FAILED);
+      return err;
+    }
+  }
 
   // --------------------------------------------------------------------
 
@@ -232,63 +1771,644 @@ esp_err_t wifi_api_configure(const char *ssid, const char *password)
   };
   strncpy((char *)wc.sta.ssid, ssid, sizeof(wc.sta.ssid));
   strncpy((char *)wc.sta.password, password, sizeof(wc.sta.password));
+  wc.sta.listen_interval = wifi_api_power_listen_interval();
+#if CONFIG_WIFI_API_11K
+  wc.sta.rm_enabled = 1;
+#endif
+#if CONFIG_WIFI_API_11V
+  wc.sta.btm_enabled = 1;
+#endif
+#if CONFIG_WIFI_API_11R
+  wc.sta.ft_enabled = 1;
+#endif
 
-  // --------------------------------------------------------------------
-
-  ESP_ERROR_CHECK(esp_event_handler_instance_register(
-    WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_api_event_handler, NULL,
-    &instance_any_id));
-  ESP_ERROR_CHECK(esp_event_handler_instance_register(
-    IP_EVENT, IP_EVENT_STA_GOT_IP, &wifi_api_event_handler, NULL,
-    &instance_got_ip));
+  // Without an SSID the network is selected among the profiles
+  s_profile_mode = ssid[0] == '\0';
+  // Among profiles, a preferred network in range would be missed, so the
+  // cached AP is only joined if its profile has the highest priority
+  bool cached = ap_cache_load();
+  if (cached && s_profile_mode)
+    cached = wifi_api_profile_is_top((const char *)s_ap_cache.ssid) &&
+             wifi_api_profile_lookup((const char *)s_ap_cache.ssid, &wc);
+  else if (cached)
+    cached = strncmp((const char *)s_ap_cache.ssid, ssid,
+                     sizeof(s_ap_cache.ssid)) == 0;
 
-  // --------------------------------------------------------------------
+  // Connect directly to the last known AP, skipping the all-channel scan
+  s_fast_connect = cached;
+  if (cached)
+  {
+    wc.sta.bssid_set = true;
+    memcpy(wc.sta.bssid, s_ap_cache.bssid, sizeof(wc.sta.bssid));
+    wc.sta.channel = s_ap_cache.channel;
+    if (s_ap_cache.authmode > wc.sta.threshold.authmode)
+      wc.sta.threshold.authmode = s_ap_cache.authmode;
+    ESP_LOGI(TAG, "Using cached AP " MACSTR " on channel %u",
+             MAC2STR(wc.sta.bssid), wc.sta.channel);
+  }
 
-  ESP_LOGI(TAG, "Connecting to %s...", wc.sta.ssid);
-  ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wc));
-  ESP_ERROR_CHECK(esp_wifi_connect());
+  s_ip_held = false;
+  if (s_ip_mode == WIFI_API_IP_MODE_STATIC)
+    err = ip_config_apply(&s_static_ip);
+  else if (s_ip_mode == WIFI_API_IP_MODE_CACHED_LEASE)
+    ip_lease_select((const char *)wc.sta.ssid);
+  else
+    ip_lease_release();
 
   // --------------------------------------------------------------------
 
-  // Wait for IP acquisition until success or timeout
-  xSemaphoreTake(s_ip_semaphore, portMAX_DELAY);
-
-  if (s_retry_num > MAX_RETRY)
-    return ESP_FAIL;
+  // The configuration is set before starting, so the connection is started by
+  // the `WIFI_EVENT_STA_START` handler
+  ESP_LOGI(TAG, "Connecting to %s...",
+           wc.sta.ssid[0] ? (const char *)wc.sta.ssid : "the best profile");
+  if (err == ESP_OK && reconfigure)
+    esp_wifi_disconnect();
+  if (err == ESP_OK)
+    err = esp_wifi_set_config(WIFI_IF_STA, &wc);
+  if (err == ESP_OK && timeout_ms > 0)
+    err = esp_timer_start_once(s_connect_timer, timeout_ms * 1000ULL);
+  if (err != ESP_OK)
+  {
+    ESP_LOGE(TAG, "Failed to configure the station: %s", esp_err_to_name(err));
+    if (!reconfigure)
+      init_release();
+    connect_complete(WIFI_API_RESULT_FAILED);
+    return err;
+  }
 
-  // --------------------------------------------------------------------
-  ESP_ERROR_CHECK(esp_register_shutdown_handler(&wifi_api_shutdown));
+  phase_end(WIFI_API_PHASE_DRIVER_INIT, &driver_init_us, esp_timer_get_time());
+  s_connect_requested = true;
+  if (!reconfigure)
+  {
+    err = start_acquire();
+    if (err != ESP_OK)
+    {
+      s_connect_requested = false;
+      init_release();
+      connect_complete(WIFI_API_RESULT_FAILED);
+      return err;
+    }
+  }
 
+  // Already started, by a reconfiguration or `wifi_api_start`, so no start
+  // event will come
+  if (wifi_api_get_state() & WIFI_API_STATE_STARTED)
+    return sta_connect();
   return ESP_OK;
 }
 
-esp_err_t wifi_api_disconnect()
+/**
+ * @brief Disconnect and release the references taken by the configuration,
+ * on the Wi-Fi manager task.
+ *
+ * The driver is stopped and deinitialized unless the application holds
+ * references through `wifi_api_start` or `wifi_api_init`.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t disconnect_execute()
 {
+  if (!s_connect_requested)
+    return ESP_OK;
+
   ESP_LOGI(TAG, "Disconnecting Wi-Fi...");
-  ESP_ERROR_CHECK(esp_event_handler_instance_unregister(
-    WIFI_EVENT, ESP_EVENT_ANY_ID, instance_any_id));
-  ESP_ERROR_CHECK(esp_event_handler_instance_unregister(
-    IP_EVENT, IP_EVENT_STA_GOT_IP, instance_got_ip));
+  s_connect_requested = false;
+  if (s_connect_timer)
+    esp_timer_stop(s_connect_timer);
+  if (s_retry_timer)
+    esp_timer_stop(s_retry_timer);
+  s_connect_pending = false;
+  // An interrupted directed attempt must not carry over to the next one
+  s_fast_connect = false;
 
-  if (s_ip_semaphore)
-    vSemaphoreDelete(s_ip_semaphore);
+  // The disconnection event may no longer be observed
+  wifi_api_ip_hold(false);
+  ip_lost();
+  wifi_api_state_clear(WIFI_API_STATE_ASSOCIATED | WIFI_API_STATE_GOT_IP6);
+  esp_err_t err = esp_wifi_disconnect();
 
-  return esp_wifi_disconnect();
+  start_release();
+  init_release();
+  return err;
 }
 
-esp_err_t wifi_api_alter_sta(const char *new_ssid, const char *new_password)
+/**
+ * @brief Change the station credentials and reconnect, on the Wi-Fi manager
+ * task.
+ *
+ * @param new_ssid The new SSID for the Wi-Fi network.
+ * @param new_password The new password for the Wi-Fi network.
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t alter_sta_execute(const char *new_ssid,
+                                   const char *new_password)
 {
   ESP_LOGI(TAG, "Updating STA configuration...");
+  s_profile_mode = false;
 
   wifi_config_t wc;
   esp_wifi_get_config(ESP_IF_WIFI_STA, &wc);
 
+  // The applied lease belongs to the previous network
+  if (s_ip_mode == WIFI_API_IP_MODE_CACHED_LEASE &&
+      strncmp((const char *)wc.sta.ssid, new_ssid, sizeof(wc.sta.ssid)) != 0)
+    ip_lease_select(new_ssid);
+
   strncpy((char *)wc.sta.ssid, new_ssid, sizeof(wc.sta.ssid) - 1);
   strncpy((char *)wc.sta.password, new_password, sizeof(wc.sta.password) - 1);
 
+  // The cached AP belongs to the previous network
+  s_fast_connect = false;
+  wc.sta.bssid_set = false;
+  wc.sta.channel = 0;
+
   esp_wifi_set_config(ESP_IF_WIFI_STA, &wc);
   esp_wifi_disconnect();
-  esp_wifi_connect();
+  sta_connect();
+
+  return ESP_OK;
+}
+
+esp_err_t wifi_api_execute(const wifi_api_cmd_t *cmd)
+{
+  switch (cmd->id)
+  {
+    case WIFI_API_CMD_CONFIGURE:
+      return configure_execute(cmd->configure.ssid, cmd->configure.password,
+                               cmd->configure.timeout_ms,
+                               cmd->configure.callback, cmd->configure.arg);
+    case WIFI_API_CMD_DISCONNECT:
+      return disconnect_execute();
+    case WIFI_API_CMD_INIT:
+      return init_acquire();
+    case WIFI_API_CMD_DEINIT:
+      return deinit_execute();
+    case WIFI_API_CMD_START:
+      return start_execute();
+    case WIFI_API_CMD_STOP:
+      return stop_execute();
+    case WIFI_API_CMD_ALTER_STA:
+      return alter_sta_execute(cmd->configure.ssid, cmd->configure.password);
+    case WIFI_API_CMD_SCAN_START:
+    {
+      wifi_api_scan_config_t config = cmd->scan.config;
+      config.channels = cmd->scan.channels;
+      esp_err_t err = wifi_api_scan_execute_start(
+        &config, cmd->scan.record_cb, cmd->scan.done_cb, cmd->scan.arg);
+      if (err != ESP_OK && cmd->scan.done_cb)
+        cmd->scan.done_cb(0, err, cmd->scan.arg);
+      return err;
+    }
+    case WIFI_API_CMD_SCAN_STOP:
+      return wifi_api_scan_execute_stop();
+    case WIFI_API_CMD_SCAN_RESULTS:
+      return wifi_api_scan_execute_results(cmd->scan_results.records,
+                                           cmd->scan_results.count);
+    case WIFI_API_CMD_SCAN_CACHED:
+    {
+      wifi_api_scan_config_t config = cmd->scan.config;
+      config.channels = cmd->scan.channels;
+      return wifi_api_scan_execute_cached(&config, cmd->scan.entry_cb,
+                                          cmd->scan.done_cb, cmd->scan.arg);
+    }
+    case WIFI_API_CMD_SET_ROAMING:
+    {
+      wifi_api_roam_config_t config = cmd->roam.config;
+      config.channels = cmd->roam.channels;
+      esp_err_t err =
+        wifi_api_roam_configure(cmd->roam.enable ? &config : NULL);
+      if (err == ESP_OK && (wifi_api_get_state() & WIFI_API_STATE_ASSOCIATED))
+        rssi_threshold_arm();
+      return err;
+    }
+    case WIFI_API_CMD_ROAM_TIMEOUT:
+      wifi_api_roam_timeout();
+      return ESP_OK;
+    case WIFI_API_CMD_SET_DRIVER_PROFILE:
+      // Buffers are allocated by `esp_wifi_init`, only a new driver uses it
+      if (s_init_refs > 0)
+        return ESP_ERR_INVALID_STATE;
+      return wifi_api_driver_set_profile(
+        (wifi_api_driver_profile_t)cmd->value);
+    case WIFI_API_CMD_SET_POWER:
+      return wifi_api_power_set(cmd->power.profile, cmd->power.listen_interval);
+    case WIFI_API_CMD_SET_GOVERNOR:
+      return wifi_api_power_governor(cmd->power.enable ? &cmd->power.governor
+                                                       : NULL);
+    case WIFI_API_CMD_POWER_SAMPLE:
+      wifi_api_power_sample();
+      return ESP_OK;
+    case WIFI_API_CMD_SET_LINK:
+      return wifi_api_link_configure(cmd->link.enable ? &cmd->link.config
+                                                      : NULL);
+    case WIFI_API_CMD_LINK_SAMPLE:
+      wifi_api_link_sample();
+      rssi_threshold_recover();
+      return ESP_OK;
+    case WIFI_API_CMD_SET_WATCHDOG:
+    {
+      wifi_api_watchdog_config_t config = cmd->watchdog.config;
+      config.host = cmd->watchdog.host[0] ? cmd->watchdog.host : NULL;
+      return wifi_api_watchdog_configure(cmd->watchdog.enable ? &config
+                                                              : NULL);
+    }
+    case WIFI_API_CMD_WATCHDOG_PROBED:
+    {
+      wifi_api_watchdog_action_t action;
+      if (s_connect_requested && wifi_api_watchdog_probed(cmd->value, &action))
+        watchdog_recover(action);
+      return ESP_OK;
+    }
+    case WIFI_API_CMD_EVENT:
+      event_dispatch(cmd->event.base, cmd->event.id, &cmd->event.data);
+      return ESP_OK;
+    case WIFI_API_CMD_CONNECT_TIMEOUT:
+      if (s_connect_pending)
+        ESP_LOGW(TAG, "Connection attempt timed out");
+      connect_complete(WIFI_API_RESULT_TIMEOUT);
+      return ESP_OK;
+    case WIFI_API_CMD_RETRY:
+      return s_connect_requested ? sta_connect() : ESP_OK;
+    case WIFI_API_CMD_LEASE_EXPIRED:
+      ESP_LOGI(TAG, "Cached lease expired, renewing through DHCP");
+      ip_lease_invalidate();
+      return ESP_OK;
+    case WIFI_API_CMD_LEASE_PROBED:
+      ip_lease_probed(cmd->value);
+      return ESP_OK;
+    case WIFI_API_CMD_SET_RETRY_POLICY:
+      return retry_policy_set(cmd->retry_policy.reason,
+                              cmd->retry_policy.action,
+                              cmd->retry_policy.limit);
+    case WIFI_API_CMD_SET_RETRY_CONFIG:
+      s_retry_config = cmd->retry;
+      return ESP_OK;
+    case WIFI_API_CMD_SET_IP_MODE:
+      s_ip_mode = cmd->ip.mode;
+      if (cmd->ip.has_static_ip)
+        s_static_ip = cmd->ip.static_ip;
+      return ESP_OK;
+    case WIFI_API_CMD_RESET_DISCONNECT_COUNTS:
+      taskENTER_CRITICAL(&s_reason_lock);
+      memset(s_reason_count, 0, sizeof(s_reason_count));
+      taskEXIT_CRITICAL(&s_reason_lock);
+      return ESP_OK;
+    case WIFI_API_CMD_REMOVE_PROFILE:
+      return wifi_api_profile_execute_remove(cmd->ssid);
+    case WIFI_API_CMD_SET_RSSI_THRESHOLD:
+      s_rssi_threshold = cmd->rssi;
+      if (wifi_api_get_state() & WIFI_API_STATE_ASSOCIATED)
+        rssi_threshold_arm();
+      return ESP_OK;
+    default:
+      return ESP_ERR_INVALID_ARG;
+  }
+}
+
+/**
+ * @brief Fill the credentials of a configure or alter command.
+ *
+ * @param cmd The command.
+ * @param ssid The SSID of the Wi-Fi network.
+ * @param password The password for the Wi-Fi network.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if a credential is missing
+ * or too long.
+ */
+static esp_err_t cmd_set_credentials(wifi_api_cmd_t *cmd, const char *ssid,
+                                     const char *password)
+{
+  if (!ssid || !password || ssid[0] == '\0' ||
+      strlen(ssid) >= sizeof(cmd->configure.ssid) ||
+      strlen(password) >= sizeof(cmd->configure.password))
+    return ESP_ERR_INVALID_ARG;
 
+  strcpy(cmd->configure.ssid, ssid);
+  strcpy(cmd->configure.password, password);
   return ESP_OK;
 }
+
+esp_err_t wifi_api_configure_async(const char *ssid, const char *password,
+                                   uint32_t timeout_ms,
+                                   wifi_api_connect_cb_t callback, void *arg)
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_CONFIGURE};
+  esp_err_t err = cmd_set_credentials(&cmd, ssid, password);
+  if (err != ESP_OK)
+    return err;
+
+  cmd.configure.timeout_ms = timeout_ms;
+  cmd.configure.callback = callback;
+  cmd.configure.arg = arg;
+  return wifi_api_task_post(&cmd, 0);
+}
+
+/**
+ * @brief Execute a configure command and wait for the connection.
+ *
+ * @param cmd The configure command.
+ * @param timeout_ms Maximum time to wait in milliseconds, 0 for no limit.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT on timeout, ESP_FAIL on failure,
+ * ESP_ERR_INVALID_STATE if called from the Wi-Fi manager task.
+ */
+static esp_err_t configure_call(wifi_api_cmd_t *cmd, uint32_t timeout_ms)
+{
+  // The result is signaled by the manager task, which must not wait for it
+  if (wifi_api_task_is_current())
+    return ESP_ERR_INVALID_STATE;
+
+  // The command clears the state of the previous attempt before returning,
+  // the timeout is applied by the wait below
+  esp_err_t err = wifi_api_task_call(cmd);
+  if (err != ESP_OK)
+    return err;
+
+  uint32_t state = wifi_api_wait_state(
+    WIFI_API_STATE_GOT_IP4 | WIFI_API_STATE_FAILED, false, timeout_ms);
+  if (state & WIFI_API_STATE_GOT_IP4)
+    return ESP_OK;
+  if (state & WIFI_API_STATE_FAILED)
+    return ESP_FAIL;
+
+  ESP_LOGW(TAG, "Connection attempt timed out");
+  return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t wifi_api_configure_timeout(const char *ssid, const char *password,
+                                     uint32_t timeout_ms)
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_CONFIGURE};
+  esp_err_t err = cmd_set_credentials(&cmd, ssid, password);
+  if (err != ESP_OK)
+    return err;
+
+  return configure_call(&cmd, timeout_ms);
+}
+
+/**
+ * @brief Check that there is a profile, loading the stored ones if needed.
+ *
+ * @return true if there is at least one profile.
+ */
+static bool profiles_available()
+{
+  if (wifi_api_get_profile_count() == 0)
+    wifi_api_load_profiles(NULL);
+  return wifi_api_get_profile_count() > 0;
+}
+
+esp_err_t wifi_api_configure_profiles(uint32_t timeout_ms)
+{
+  if (!profiles_available())
+    return ESP_ERR_INVALID_STATE;
+
+  // An empty SSID selects the profile mode
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_CONFIGURE};
+  return configure_call(&cmd, timeout_ms);
+}
+
+esp_err_t wifi_api_configure_profiles_async(uint32_t timeout_ms,
+                                            wifi_api_connect_cb_t callback,
+                                            void *arg)
+{
+  if (!profiles_available())
+    return ESP_ERR_INVALID_STATE;
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_CONFIGURE};
+  cmd.configure.timeout_ms = timeout_ms;
+  cmd.configure.callback = callback;
+  cmd.configure.arg = arg;
+  return wifi_api_task_post(&cmd, 0);
+}
+
+esp_err_t wifi_api_configure(const char *ssid, const char *password)
+{
+  return wifi_api_configure_timeout(ssid, password, 0);
+}
+
+esp_err_t wifi_api_init()
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_INIT};
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_deinit()
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_DEINIT};
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_start()
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_START};
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_stop()
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_STOP};
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_disconnect()
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_DISCONNECT};
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_disconnect_async(wifi_api_done_cb_t callback, void *arg)
+{
+  wifi_api_cmd_t cmd = {
+    .id = WIFI_API_CMD_DISCONNECT, .done = callback, .done_arg = arg};
+  return wifi_api_task_post(&cmd, 0);
+}
+
+esp_err_t wifi_api_alter_sta(const char *new_ssid, const char *new_password)
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_ALTER_STA};
+  esp_err_t err = cmd_set_credentials(&cmd, new_ssid, new_password);
+  if (err != ESP_OK)
+    return err;
+
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_alter_sta_async(const char *new_ssid,
+                                   const char *new_password,
+                                   wifi_api_done_cb_t callback, void *arg)
+{
+  wifi_api_cmd_t cmd = {
+    .id = WIFI_API_CMD_ALTER_STA, .done = callback, .done_arg = arg};
+  esp_err_t err = cmd_set_credentials(&cmd, new_ssid, new_password);
+  if (err != ESP_OK)
+    return err;
+
+  return wifi_api_task_post(&cmd, 0);
+}
+
+esp_err_t wifi_api_set_rssi_threshold(int8_t rssi)
+{
+  if (rssi > 0)
+    return ESP_ERR_INVALID_ARG;
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_RSSI_THRESHOLD, .rssi = rssi};
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_set_roaming(const wifi_api_roam_config_t *config)
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_ROAMING};
+  if (config)
+  {
+    if (config->rssi_threshold >= 0 ||
+        config->channel_count > WIFI_API_SCAN_MAX_CHANNELS ||
+        (config->channel_count > 0 && !config->channels))
+      return ESP_ERR_INVALID_ARG;
+
+    cmd.roam.enable = true;
+    cmd.roam.config = *config;
+    if (config->channel_count > 0)
+      memcpy(cmd.roam.channels, config->channels, config->channel_count);
+  }
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_set_driver_profile(wifi_api_driver_profile_t profile)
+{
+  if ((unsigned)profile >= WIFI_API_DRIVER_PROFILE_MAX)
+    return ESP_ERR_INVALID_ARG;
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_DRIVER_PROFILE,
+                        .value = profile};
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_set_power_profile(wifi_api_power_profile_t profile,
+                                     uint8_t listen_interval)
+{
+  if ((unsigned)profile >= WIFI_API_POWER_PROFILE_MAX)
+    return ESP_ERR_INVALID_ARG;
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_POWER};
+  cmd.power.profile = profile;
+  cmd.power.listen_interval = listen_interval;
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_set_power_governor(const wifi_api_power_governor_t *config)
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_GOVERNOR};
+  if (config)
+  {
+    if ((unsigned)config->active_profile >= WIFI_API_POWER_PROFILE_MAX ||
+        (unsigned)config->idle_profile >= WIFI_API_POWER_PROFILE_MAX ||
+        config->sample_ms == 0)
+      return ESP_ERR_INVALID_ARG;
+
+    cmd.power.enable = true;
+    cmd.power.governor = *config;
+  }
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_set_link_sampling(const wifi_api_link_config_t *config)
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_LINK};
+  if (config)
+  {
+    if (config->sample_ms == 0 || config->weight == 0 || config->weight > 100)
+      return ESP_ERR_INVALID_ARG;
+
+    cmd.link.enable = true;
+    cmd.link.config = *config;
+  }
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_set_watchdog(const wifi_api_watchdog_config_t *config)
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_WATCHDOG};
+  if (config)
+  {
+    esp_ip4_addr_t ip;
+    if ((unsigned)config->probe > WIFI_API_WATCHDOG_TCP ||
+        config->interval_ms == 0 || config->timeout_ms == 0 ||
+        config->failures == 0 ||
+        (config->probe == WIFI_API_WATCHDOG_TCP &&
+         (!config->host || config->port == 0)) ||
+        (config->host &&
+         (strlen(config->host) >= sizeof(cmd.watchdog.host) ||
+          esp_netif_str_to_ip4(config->host, &ip) != ESP_OK)))
+      return ESP_ERR_INVALID_ARG;
+
+    cmd.watchdog.enable = true;
+    cmd.watchdog.config = *config;
+    if (config->host)
+      strcpy(cmd.watchdog.host, config->host);
+  }
+  return wifi_api_task_call(&cmd);
+}
+
+uint32_t wifi_api_get_state()
+{
+  return xEventGroupGetBits(state_group());
+}
+
+uint32_t wifi_api_wait_state(uint32_t bits, bool wait_all, uint32_t timeout_ms)
+{
+  TickType_t ticks = timeout_ms ? pdMS_TO_TICKS(timeout_ms) : portMAX_DELAY;
+  return xEventGroupWaitBits(state_group(), bits, pdFALSE,
+                             wait_all ? pdTRUE : pdFALSE, ticks);
+}
+
+esp_err_t wifi_api_set_ip_mode(wifi_api_ip_mode_t mode,
+                               const wifi_api_ip_config_t *static_ip)
+{
+  if (mode == WIFI_API_IP_MODE_STATIC && !static_ip)
+    return ESP_ERR_INVALID_ARG;
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_IP_MODE};
+  cmd.ip.mode = mode;
+  cmd.ip.has_static_ip = static_ip != NULL;
+  if (static_ip)
+    cmd.ip.static_ip = *static_ip;
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_set_retry_config(const wifi_api_retry_config_t *config)
+{
+  if (!config || config->base_delay_ms == 0 ||
+      config->max_delay_ms < config->base_delay_ms)
+    return ESP_ERR_INVALID_ARG;
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_RETRY_CONFIG};
+  cmd.retry = *config;
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_set_retry_policy(uint8_t reason,
+                                    wifi_api_retry_action_t action,
+                                    uint8_t limit)
+{
+  if ((unsigned)action >= WIFI_API_RETRY_ACTION_MAX)
+    return ESP_ERR_INVALID_ARG;
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SET_RETRY_POLICY};
+  cmd.retry_policy.reason = reason;
+  cmd.retry_policy.action = action;
+  cmd.retry_policy.limit = limit;
+  return wifi_api_task_call(&cmd);
+}
+
+uint16_t wifi_api_get_disconnect_count(uint8_t reason)
+{
+  taskENTER_CRITICAL(&s_reason_lock);
+  uint16_t count = s_reason_count[reason];
+  taskEXIT_CRITICAL(&s_reason_lock);
+  return count;
+}
+
+void wifi_api_reset_disconnect_counts()
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_RESET_DISCONNECT_COUNTS};
+  wifi_api_task_call(&cmd);
+}
@@ -0,0 +1,167 @@
+/**
+ * @file wifi_api_driver.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API driver buffer and AMPDU profiles
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_DRIVER";
+
+/**
+ * @brief Approximate internal RAM taken by one driver RX or TX buffer.
+ */
+#define DRIVER_BUFFER_BYTES 1600
+
+/**
+ * @brief Names of the driver profiles, indexed by `wifi_api_driver_profile_t`.
+ */
+static const char *const PROFILE_NAMES[WIFI_API_DRIVER_PROFILE_MAX] = {
+  [WIFI_API_DRIVER_THROUGHPUT] = "throughput",
+  [WIFI_API_DRIVER_BALANCED] = "balanced",
+  [WIFI_API_DRIVER_LOW_MEMORY] = "low-memory",
+};
+
+/**
+ * @brief Driver profile selected in Kconfig.
+ */
+#if CONFIG_WIFI_API_DRIVER_PROFILE_THROUGHPUT
+#define DRIVER_PROFILE_DEFAULT WIFI_API_DRIVER_THROUGHPUT
+#elif CONFIG_WIFI_API_DRIVER_PROFILE_LOW_MEMORY
+#define DRIVER_PROFILE_DEFAULT WIFI_API_DRIVER_LOW_MEMORY
+#else
+#define DRIVER_PROFILE_DEFAULT WIFI_API_DRIVER_BALANCED
+#endif
+
+/**
+ * @brief Driver profile used by the next driver initialization.
+ */
+static wifi_api_driver_profile_t s_profile = DRIVER_PROFILE_DEFAULT;
+
+/**
+ * @brief Memory cost of the last driver initialization.
+ */
+static wifi_api_driver_memory_t s_memory = {0};
+
+/**
+ * @brief Lock protecting `s_memory`.
+ */
+static portMUX_TYPE s_memory_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Apply a nonzero Kconfig override to a configuration field.
+ */
+#define DRIVER_OVERRIDE(field, value)                                          \
+  do                                                                           \
+  {                                                                            \
+    if ((value) > 0)                                                           \
+      (field) = (value);                                                       \
+  } while (0)
+
+void wifi_api_driver_config(wifi_init_config_t *cfg)
+{
+  switch (s_profile)
+  {
+    case WIFI_API_DRIVER_THROUGHPUT:
+      // Enough buffers to keep a 32 frame block ack window full both ways
+      cfg->static_rx_buf_num = 16;
+      cfg->dynamic_rx_buf_num = 64;
+      cfg->tx_buf_type = 1;
+      cfg->dynamic_tx_buf_num = 64;
+      cfg->rx_ba_win = 32;
+      break;
+    case WIFI_API_DRIVER_LOW_MEMORY:
+      // Aggregation needs a buffer per frame of the window, it is disabled
+      cfg->static_rx_buf_num = 4;
+      cfg->dynamic_rx_buf_num = 8;
+      cfg->tx_buf_type = 1;
+      cfg->dynamic_tx_buf_num = 16;
+      cfg->ampdu_rx_enable = 0;
+      cfg->ampdu_tx_enable = 0;
+      cfg->rx_ba_win = 4;
+      break;
+    default:
+      break;
+  }
+
+  DRIVER_OVERRIDE(cfg->static_rx_buf_num, CONFIG_WIFI_API_STATIC_RX_BUF_NUM);
+  DRIVER_OVERRIDE(cfg->dynamic_rx_buf_num, CONFIG_WIFI_API_DYNAMIC_RX_BUF_NUM);
+  DRIVER_OVERRIDE(cfg->dynamic_tx_buf_num, CONFIG_WIFI_API_DYNAMIC_TX_BUF_NUM);
+  DRIVER_OVERRIDE(cfg->cache_tx_buf_num, CONFIG_WIFI_API_CACHE_TX_BUF_NUM);
+  DRIVER_OVERRIDE(cfg->rx_ba_win, CONFIG_WIFI_API_RX_BA_WIN);
+
+  // The driver rejects a window larger than the RX buffers can hold
+  int max_ba_win = cfg->static_rx_buf_num * 2;
+  if (cfg->dynamic_rx_buf_num > 0 && cfg->dynamic_rx_buf_num < max_ba_win)
+    max_ba_win = cfg->dynamic_rx_buf_num;
+  if (cfg->rx_ba_win > max_ba_win)
+  {
+    ESP_LOGW(TAG, "Block ack window %d limited to %d by the RX buffers",
+             cfg->rx_ba_win, max_ba_win);
+    cfg->rx_ba_win = max_ba_win;
+  }
+
+  // Static TX buffers are only allocated with the static TX buffer type
+  int static_tx = cfg->tx_buf_type == 0 ? cfg->static_tx_buf_num : 0;
+  int dynamic_tx = cfg->tx_buf_type == 0 ? 0 : cfg->dynamic_tx_buf_num;
+  taskENTER_CRITICAL(&s_memory_lock);
+  s_memory.profile = s_profile;
+  s_memory.init_bytes = 0;
+  s_memory.static_bytes =
+    (cfg->static_rx_buf_num + static_tx) * DRIVER_BUFFER_BYTES;
+  s_memory.dynamic_bytes =
+    (cfg->dynamic_rx_buf_num + dynamic_tx) * DRIVER_BUFFER_BYTES;
+  taskEXIT_CRITICAL(&s_memory_lock);
+}
+
+size_t wifi_api_driver_free_ram()
+{
+  return heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+}
+
+void wifi_api_driver_initialized(size_t free_before)
+{
+  // Other tasks may allocate meanwhile, so the cost is approximate
+  size_t free_after = wifi_api_driver_free_ram();
+  taskENTER_CRITICAL(&s_memory_lock);
+  s_memory.init_bytes = free_before > free_after ? free_before - free_after : 0;
+  taskEXIT_CRITICAL(&s_memory_lock);
+
+  ESP_LOGI(TAG,
+           "Driver profile %s: %u bytes of internal RAM at init, %u in static "
+           "buffers, up to %u in dynamic buffers",
+           PROFILE_NAMES[s_memory.profile], (unsigned)s_memory.init_bytes,
+           (unsigned)s_memory.static_bytes, (unsigned)s_memory.dynamic_bytes);
+}
+
+esp_err_t wifi_api_driver_set_profile(wifi_api_driver_profile_t profile)
+{
+  if ((unsigned)profile >= WIFI_API_DRIVER_PROFILE_MAX)
+    return ESP_ERR_INVALID_ARG;
+
+  s_profile = profile;
+  return ESP_OK;
+}
+
+esp_err_t wifi_api_get_driver_memory(wifi_api_driver_memory_t *memory)
+{
+  if (!memory)
+    return ESP_ERR_INVALID_ARG;
+  taskENTER_CRITICAL(&s_memory_lock);
+  *memory = s_memory;
+  taskEXIT_CRITICAL(&s_memory_lock);
+  return memory->static_bytes > 0 ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file wifi_api_events.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API component event subscriptions
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_log.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <string.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_EVENTS";
+
+/**
+ * @brief Subscription of a callback to an event.
+ */
+typedef struct
+{
+  wifi_api_event_cb_t callback; /**< Callback, NULL if the slot is free. */
+  void *arg;                    /**< User argument of `callback`. */
+  bool deferred;                /**< Whether it runs on the delivery task. */
+} wifi_api_subscriber_t;
+
+/**
+ * @brief Subscribers indexed by event.
+ */
+static wifi_api_subscriber_t
+  s_subscribers[WIFI_API_EVENT_MAX][CONFIG_WIFI_API_MAX_SUBSCRIBERS] = {0};
+
+/**
+ * @brief Number of deferred subscribers of each event, so the delivery queue
+ * is skipped when there are none.
+ */
+static uint8_t s_deferred_count[WIFI_API_EVENT_MAX] = {0};
+
+/**
+ * @brief Lock protecting the subscriber table.
+ */
+static portMUX_TYPE s_subscribers_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Queue of the events waiting for the deferred subscribers.
+ */
+static QueueHandle_t s_delivery_queue = NULL;
+
+/**
+ * @brief Call the subscribers of an event.
+ *
+ * The subscribers are copied under the lock, so callbacks may subscribe or
+ * unsubscribe.
+ *
+ * @param data The event data.
+ * @param deferred Whether to call the deferred or the immediate subscribers.
+ */
+static void deliver(const wifi_api_event_data_t *data, bool deferred)
+{
+  wifi_api_subscriber_t subscribers[CONFIG_WIFI_API_MAX_SUBSCRIBERS];
+
+  taskENTER_CRITICAL(&s_subscribers_lock);
+  memcpy(subscribers, s_subscribers[data->event], sizeof(subscribers));
+  taskEXIT_CRITICAL(&s_subscribers_lock);
+
+  for (size_t i = 0; i < CONFIG_WIFI_API_MAX_SUBSCRIBERS; i++)
+  {
+    if (subscribers[i].callback && subscribers[i].deferred == deferred)
+      subscribers[i].callback(data, subscribers[i].arg);
+  }
+}
+
+/**
+ * @brief Delivery task of the deferred subscribers.
+ *
+ * @param arg The delivery queue, created before the task.
+ */
+static void delivery_task(void *arg)
+{
+  QueueHandle_t queue = arg;
+  wifi_api_event_data_t data;
+  for (;;)
+  {
+    if (xQueueReceive(queue, &data, portMAX_DELAY) == pdTRUE)
+      deliver(&data, true);
+  }
+}
+
+/**
+ * @brief Create the delivery task and its queue once.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM otherwise.
+ */
+static esp_err_t delivery_init()
+{
+  if (s_delivery_queue)
+    return ESP_OK;
+
+  QueueHandle_t queue = xQueueCreate(CONFIG_WIFI_API_EVENT_QUEUE_LENGTH,
+                                     sizeof(wifi_api_event_data_t));
+  if (!queue)
+    return ESP_ERR_NO_MEM;
+
+  // Below the manager task, so slow subscribers never delay it. The task is
+  // created before the queue is published, so no event is queued to a task
+  // that does not exist
+  UBaseType_t priority = CONFIG_WIFI_API_TASK_PRIORITY > 1
+                           ? CONFIG_WIFI_API_TASK_PRIORITY - 1
+                           : 1;
+  TaskHandle_t task;
+  if (xTaskCreate(&delivery_task, "wifi_api_evt",
+                  CONFIG_WIFI_API_TASK_STACK_SIZE, queue, priority,
+                  &task) != pdPASS)
+  {
+    ESP_LOGE(TAG, "Failed to create the event delivery task");
+    vQueueDelete(queue);
+    return ESP_ERR_NO_MEM;
+  }
+
+  taskENTER_CRITICAL(&s_subscribers_lock);
+  bool owner = !s_delivery_queue;
+  if (owner)
+    s_delivery_queue = queue;
+  taskEXIT_CRITICAL(&s_subscribers_lock);
+
+  // Another task created the queue first, the unused task only waits on its
+  // own empty queue
+  if (!owner)
+  {
+    vTaskDelete(task);
+    vQueueDelete(queue);
+  }
+  return ESP_OK;
+}
+
+void wifi_api_event_publish(const wifi_api_event_data_t *data)
+{
+  if ((unsigned)data->event >= WIFI_API_EVENT_MAX)
+    return;
+
+  deliver(data, false);
+
+  if (s_deferred_count[data->event] > 0 && s_delivery_queue &&
+      xQueueSend(s_delivery_queue, data, 0) != pdTRUE)
+    ESP_LOGW(TAG, "Delivery queue full, dropping event %d", data->event);
+}
+
+esp_err_t wifi_api_subscribe(wifi_api_event_t event,
+                             wifi_api_event_cb_t callback, void *arg,
+                             bool deferred)
+{
+  if ((unsigned)event >= WIFI_API_EVENT_MAX || !callback)
+    return ESP_ERR_INVALID_ARG;
+
+  if (deferred)
+  {
+    esp_err_t err = delivery_init();
+    if (err != ESP_OK)
+      return err;
+  }
+
+  esp_err_t err = ESP_ERR_NO_MEM;
+  taskENTER_CRITICAL(&s_subscribers_lock);
+  for (size_t i = 0; i < CONFIG_WIFI_API_MAX_SUBSCRIBERS; i++)
+  {
+    wifi_api_subscriber_t *subscriber = &s_subscribers[event][i];
+    if (subscriber->callback)
+      continue;
+
+    subscriber->callback = callback;
+    subscriber->arg = arg;
+    subscriber->deferred = deferred;
+    if (deferred)
+      s_deferred_count[event]++;
+    err = ESP_OK;
+    break;
+  }
+  taskEXIT_CRITICAL(&s_subscribers_lock);
+
+  return err;
+}
+
+esp_err_t wifi_api_unsubscribe(wifi_api_event_t event,
+                               wifi_api_event_cb_t callback, void *arg)
+{
+  if ((unsigned)event >= WIFI_API_EVENT_MAX || !callback)
+    return ESP_ERR_INVALID_ARG;
+
+  esp_err_t err = ESP_ERR_NOT_FOUND;
+  taskENTER_CRITICAL(&s_subscribers_lock);
+  for (size_t i = 0; i < CONFIG_WIFI_API_MAX_SUBSCRIBERS; i++)
+  {
+    wifi_api_subscriber_t *subscriber = &s_subscribers[event][i];
+    if (subscriber->callback != callback || subscriber->arg != arg)
+      continue;
+
+    if (subscriber->deferred)
+      s_deferred_count[event]--;
+    subscriber->callback = NULL;
+    subscriber->arg = NULL;
+    err = ESP_OK;
+    break;
+  }
+  taskEXIT_CRITICAL(&s_subscribers_lock);
+
+  return err;
+}
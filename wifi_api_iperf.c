@@ -0,0 +1,697 @@
+/**
+ * @file wifi_api_iperf.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief iperf2 compatible TCP/UDP throughput benchmark
+ *
+ * Only the BSD socket API is used, so the same code runs on the device
+ * through lwIP and in the Linux host build.
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_iperf.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "wifi_api.h"
+#endif
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_IPERF";
+
+/**
+ * @brief Number of times the final UDP datagram is sent while waiting for
+ * the report of the server, as iperf2 does.
+ */
+#define IPERF_FIN_RETRIES 10
+
+/**
+ * @brief Time the UDP client waits for the report after each final datagram.
+ */
+#define IPERF_FIN_WAIT_MS 250
+
+/**
+ * @brief Receive timeout of the server sockets, so a stop request is seen.
+ */
+#define IPERF_POLL_MS 1000
+
+/**
+ * @brief Flag of `iperf_server_hdr_t` marking a version 1 report.
+ */
+#define IPERF_HEADER_VERSION1 0x80000000UL
+
+/**
+ * @brief Header of every iperf2 UDP datagram, in network byte order.
+ */
+typedef struct
+{
+  int32_t id;       /**< Sequence number, negated in the final datagram. */
+  uint32_t tv_sec;  /**< Send time, seconds. */
+  uint32_t tv_usec; /**< Send time, microseconds. */
+} iperf_datagram_t;
+
+/**
+ * @brief Report of an iperf2 UDP server, sent after the datagram header in
+ * reply to the final datagram, in network byte order.
+ */
+typedef struct
+{
+  int32_t flags;        /**< `IPERF_HEADER_VERSION1`. */
+  int32_t total_len1;   /**< Received bytes, high word. */
+  int32_t total_len2;   /**< Received bytes, low word. */
+  int32_t stop_sec;     /**< Test duration, seconds. */
+  int32_t stop_usec;    /**< Test duration, microseconds. */
+  int32_t error_cnt;    /**< Datagrams lost. */
+  int32_t outorder_cnt; /**< Datagrams out of order. */
+  int32_t datagrams;    /**< Highest sequence number received. */
+  int32_t jitter1;      /**< Jitter, seconds. */
+  int32_t jitter2;      /**< Jitter, microseconds. */
+} iperf_server_hdr_t;
+
+/**
+ * @brief Smallest UDP datagram, which must hold the report of the server.
+ */
+#define IPERF_UDP_MIN_LENGTH                                                   \
+  (sizeof(iperf_datagram_t) + sizeof(iperf_server_hdr_t))
+
+/**
+ * @brief State of a running benchmark.
+ */
+typedef struct
+{
+  const wifi_api_iperf_config_t *config; /**< Configuration. */
+  wifi_api_iperf_result_t *result;       /**< Result being filled. */
+  uint8_t *buffer;                       /**< Send or receive buffer. */
+  int64_t start_us;                      /**< Start of the transfer. */
+  int64_t report_us;                     /**< Time of the next progress log. */
+  uint64_t report_bytes; /**< Bytes at the last progress log. */
+} iperf_ctx_t;
+
+/**
+ * @brief Run time counters sampled to compute the CPU load.
+ */
+typedef struct
+{
+  uint64_t total;                           /**< Run time counter. */
+  uint64_t idle[WIFI_API_IPERF_MAX_CORES]; /**< Idle task run time. */
+} iperf_cpu_sample_t;
+
+/**
+ * @brief Whether `wifi_api_iperf_stop` was called.
+ */
+static bool s_stop = false;
+
+/**
+ * @brief Get a monotonic time.
+ *
+ * @return The time in microseconds.
+ */
+static int64_t iperf_now_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief Whether the benchmark must stop.
+ *
+ * @return true once `wifi_api_iperf_stop` was called.
+ */
+static bool iperf_stopped()
+{
+  return __atomic_load_n(&s_stop, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Sample the run time counters of the idle tasks.
+ *
+ * @param sample The sample.
+ */
+static void cpu_sample(iperf_cpu_sample_t *sample)
+{
+  memset(sample, 0, sizeof(*sample));
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && !CONFIG_IDF_TARGET_LINUX
+  sample->total = portGET_RUN_TIME_COUNTER_VALUE();
+  for (int i = 0; i < portNUM_PROCESSORS && i < WIFI_API_IPERF_MAX_CORES; i++)
+    sample->idle[i] = ulTaskGetIdleRunTimeCounterForCore(i);
+#endif
+}
+
+/**
+ * @brief Compute the load of each core since a sample.
+ *
+ * @param start The sample taken at the start of the transfer.
+ * @param result The result receiving the load.
+ */
+static void cpu_load(const iperf_cpu_sample_t *start,
+                     wifi_api_iperf_result_t *result)
+{
+  for (int i = 0; i < WIFI_API_IPERF_MAX_CORES; i++)
+    result->cpu_load[i] = -1;
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && !CONFIG_IDF_TARGET_LINUX
+  iperf_cpu_sample_t end;
+  cpu_sample(&end);
+  configRUN_TIME_COUNTER_TYPE elapsed =
+    (configRUN_TIME_COUNTER_TYPE)(end.total - start->total);
+  if (elapsed == 0)
+    return;
+
+  for (int i = 0; i < portNUM_PROCESSORS && i < WIFI_API_IPERF_MAX_CORES; i++)
+  {
+    configRUN_TIME_COUNTER_TYPE idle =
+      (configRUN_TIME_COUNTER_TYPE)(end.idle[i] - start->idle[i]);
+    uint64_t busy = idle < elapsed ? elapsed - idle : 0;
+    result->cpu_load[i] = (int8_t)(busy * 100 / elapsed);
+  }
+#endif
+}
+
+/**
+ * @brief Start the transfer measurement.
+ *
+ * @param ctx The benchmark state.
+ */
+static void iperf_begin(iperf_ctx_t *ctx)
+{
+  ctx->start_us = iperf_now_us();
+  ctx->report_us = ctx->start_us + ctx->config->interval_s * 1000000LL;
+  ctx->report_bytes = 0;
+}
+
+/**
+ * @brief Log the throughput of the last interval when it is over.
+ *
+ * @param ctx The benchmark state.
+ * @param now The current time.
+ */
+static void iperf_progress(iperf_ctx_t *ctx, int64_t now)
+{
+  if (ctx->config->interval_s == 0 || now < ctx->report_us)
+    return;
+
+  uint64_t bytes = ctx->result->bytes - ctx->report_bytes;
+  int64_t from_ms = (ctx->report_us - ctx->start_us) / 1000 -
+                    ctx->config->interval_s * 1000;
+  ESP_LOGI(TAG, "%6.1f-%6.1f s %10llu bytes %8llu kbit/s",
+           from_ms / 1000.0, (now - ctx->start_us) / 1000000.0,
+           (unsigned long long)bytes,
+           (unsigned long long)(bytes * 8 / (ctx->config->interval_s * 1000)));
+
+  ctx->report_bytes = ctx->result->bytes;
+  ctx->report_us += ctx->config->interval_s * 1000000LL;
+}
+
+/**
+ * @brief Finish the transfer measurement.
+ *
+ * @param ctx The benchmark state.
+ * @param end_us End of the transfer.
+ */
+static void iperf_end(iperf_ctx_t *ctx, int64_t end_us)
+{
+  wifi_api_iperf_result_t *result = ctx->result;
+  result->duration_ms = (uint32_t)((end_us - ctx->start_us) / 1000);
+  if (result->duration_ms > 0)
+    result->throughput_kbps =
+      (uint32_t)(result->bytes * 8 / result->duration_ms);
+}
+
+/**
+ * @brief Set the receive timeout of a socket.
+ *
+ * @param sock The socket.
+ * @param timeout_ms The timeout.
+ */
+static void socket_set_timeout(int sock, uint32_t timeout_ms)
+{
+  struct timeval tv = {
+    .tv_sec = timeout_ms / 1000,
+    .tv_usec = (timeout_ms % 1000) * 1000,
+  };
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+/**
+ * @brief Whether a socket call failed only because of the receive timeout.
+ *
+ * @return true on a timeout.
+ */
+static bool socket_timed_out()
+{
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+/**
+ * @brief Run a TCP client, sending for the configured duration.
+ *
+ * @param ctx The benchmark state.
+ * @param addr Address of the server.
+ * @return ESP_OK on success, ESP_FAIL on a socket error.
+ */
+static esp_err_t tcp_client(iperf_ctx_t *ctx, const struct sockaddr_in *addr)
+{
+  int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (sock < 0)
+    return ESP_FAIL;
+  if (connect(sock, (const struct sockaddr *)addr, sizeof(*addr)) != 0)
+  {
+    ESP_LOGE(TAG, "Failed to connect: errno %d", errno);
+    close(sock);
+    return ESP_FAIL;
+  }
+
+  // Same payload as iperf2, the server ignores it
+  for (size_t i = 0; i < ctx->config->length; i++)
+    ctx->buffer[i] = '0' + i % 10;
+
+  esp_err_t err = ESP_OK;
+  iperf_begin(ctx);
+  int64_t end_us = ctx->start_us + ctx->config->duration_s * 1000000LL;
+  int64_t now = ctx->start_us;
+  while (now < end_us && !iperf_stopped())
+  {
+    ssize_t sent = send(sock, ctx->buffer, ctx->config->length, 0);
+    if (sent < 0)
+    {
+      ESP_LOGE(TAG, "Failed to send: errno %d", errno);
+      err = ESP_FAIL;
+      break;
+    }
+    ctx->result->bytes += sent;
+    now = iperf_now_us();
+    iperf_progress(ctx, now);
+  }
+
+  iperf_end(ctx, now);
+  close(sock);
+  return err;
+}
+
+/**
+ * @brief Run a TCP server, receiving one stream until the client closes it.
+ *
+ * @param ctx The benchmark state.
+ * @param addr Local address to listen on.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if no client came, ESP_FAIL on
+ * a socket error.
+ */
+static esp_err_t tcp_server(iperf_ctx_t *ctx, const struct sockaddr_in *addr)
+{
+  int listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (listener < 0)
+    return ESP_FAIL;
+
+  int reuse = 1;
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  if (bind(listener, (const struct sockaddr *)addr, sizeof(*addr)) != 0 ||
+      listen(listener, 1) != 0)
+  {
+    ESP_LOGE(TAG, "Failed to listen: errno %d", errno);
+    close(listener);
+    return ESP_FAIL;
+  }
+  socket_set_timeout(listener, IPERF_POLL_MS);
+
+  ESP_LOGI(TAG, "TCP server listening on port %u", ctx->config->port);
+  int64_t deadline = ctx->config->duration_s
+                       ? iperf_now_us() + ctx->config->duration_s * 1000000LL
+                       : INT64_MAX;
+  int sock = -1;
+  while (sock < 0 && !iperf_stopped() && iperf_now_us() < deadline)
+  {
+    sock = accept(listener, NULL, NULL);
+    if (sock < 0 && !socket_timed_out())
+      break;
+  }
+  close(listener);
+  if (sock < 0)
+    return iperf_stopped() || socket_timed_out() ? ESP_ERR_TIMEOUT : ESP_FAIL;
+
+  socket_set_timeout(sock, IPERF_POLL_MS);
+  esp_err_t err = ESP_OK;
+  iperf_begin(ctx);
+  int64_t now = ctx->start_us;
+  while (!iperf_stopped())
+  {
+    ssize_t received = recv(sock, ctx->buffer, ctx->config->length, 0);
+    if (received == 0)
+      break;
+    if (received < 0 && !socket_timed_out())
+    {
+      ESP_LOGE(TAG, "Failed to receive: errno %d", errno);
+      err = ESP_FAIL;
+      break;
+    }
+    if (received > 0)
+    {
+      ctx->result->bytes += received;
+      now = iperf_now_us();
+    }
+    iperf_progress(ctx, iperf_now_us());
+  }
+
+  iperf_end(ctx, now);
+  close(sock);
+  return err;
+}
+
+/**
+ * @brief Fill the header of a UDP datagram.
+ *
+ * @param buffer The datagram.
+ * @param id The sequence number.
+ */
+static void udp_stamp(uint8_t *buffer, int32_t id)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  iperf_datagram_t header = {
+    .id = (int32_t)htonl((uint32_t)id),
+    .tv_sec = htonl((uint32_t)tv.tv_sec),
+    .tv_usec = htonl((uint32_t)tv.tv_usec),
+  };
+  memcpy(buffer, &header, sizeof(header));
+}
+
+/**
+ * @brief Send the final datagram until the server reports its statistics.
+ *
+ * @param ctx The benchmark state.
+ * @param sock The connected socket.
+ * @param id The sequence number of the final datagram.
+ */
+static void udp_client_finish(iperf_ctx_t *ctx, int sock, int32_t id)
+{
+  socket_set_timeout(sock, IPERF_FIN_WAIT_MS);
+  for (int i = 0; i < IPERF_FIN_RETRIES; i++)
+  {
+    udp_stamp(ctx->buffer, -id);
+    send(sock, ctx->buffer, ctx->config->length, 0);
+
+    ssize_t received = recv(sock, ctx->buffer, ctx->config->length, 0);
+    if (received < (ssize_t)IPERF_UDP_MIN_LENGTH)
+      continue;
+
+    iperf_server_hdr_t report;
+    memcpy(&report, ctx->buffer + sizeof(iperf_datagram_t), sizeof(report));
+    if (!(ntohl(report.flags) & IPERF_HEADER_VERSION1))
+      continue;
+
+    ctx->result->lost = ntohl(report.error_cnt);
+    ctx->result->out_of_order = ntohl(report.outorder_cnt);
+    ctx->result->jitter_us =
+      ntohl(report.jitter1) * 1000000 + ntohl(report.jitter2);
+    return;
+  }
+  ESP_LOGW(TAG, "No report from the server");
+}
+
+/**
+ * @brief Run a UDP client, sending datagrams at the configured rate.
+ *
+ * @param ctx The benchmark state.
+ * @param addr Address of the server.
+ * @return ESP_OK on success, ESP_FAIL on a socket error.
+ */
+static esp_err_t udp_client(iperf_ctx_t *ctx, const struct sockaddr_in *addr)
+{
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (sock < 0)
+    return ESP_FAIL;
+  if (connect(sock, (const struct sockaddr *)addr, sizeof(*addr)) != 0)
+  {
+    close(sock);
+    return ESP_FAIL;
+  }
+  memset(ctx->buffer, 0, ctx->config->length);
+
+  // Time between two datagrams at the target rate
+  int64_t period_us =
+    ctx->config->bandwidth_kbps
+      ? ctx->config->length * 8000LL / ctx->config->bandwidth_kbps
+      : 0;
+
+  esp_err_t err = ESP_OK;
+  int32_t id = 0;
+  iperf_begin(ctx);
+  int64_t end_us = ctx->start_us + ctx->config->duration_s * 1000000LL;
+  int64_t next_us = ctx->start_us;
+  int64_t now = ctx->start_us;
+  while (now < end_us && !iperf_stopped())
+  {
+    // Sleep only when at least a tick ahead, short gaps are spun
+    if (next_us - now >= portTICK_PERIOD_MS * 1000)
+      usleep(next_us - now);
+
+    udp_stamp(ctx->buffer, id);
+    ssize_t sent = send(sock, ctx->buffer, ctx->config->length, 0);
+    if (sent < 0 && errno != ENOMEM && errno != ENOBUFS)
+    {
+      ESP_LOGE(TAG, "Failed to send: errno %d", errno);
+      err = ESP_FAIL;
+      break;
+    }
+    if (sent > 0)
+    {
+      ctx->result->bytes += sent;
+      ctx->result->datagrams++;
+      id++;
+    }
+    next_us += period_us;
+    now = iperf_now_us();
+    iperf_progress(ctx, now);
+  }
+
+  iperf_end(ctx, now);
+  if (err == ESP_OK)
+    udp_client_finish(ctx, sock, id);
+  close(sock);
+  return err;
+}
+
+/**
+ * @brief Reply to the final datagram of the client with the statistics.
+ *
+ * @param ctx The benchmark state.
+ * @param sock The server socket.
+ * @param peer Address of the client.
+ * @param peer_len Length of `peer`.
+ * @param max_id Highest sequence number received.
+ */
+static void udp_server_report(iperf_ctx_t *ctx, int sock,
+                              const struct sockaddr *peer, socklen_t peer_len,
+                              int32_t max_id)
+{
+  const wifi_api_iperf_result_t *result = ctx->result;
+  iperf_server_hdr_t report = {
+    .flags = (int32_t)htonl(IPERF_HEADER_VERSION1),
+    .total_len1 = (int32_t)htonl((uint32_t)(result->bytes >> 32)),
+    .total_len2 = (int32_t)htonl((uint32_t)result->bytes),
+    .stop_sec = (int32_t)htonl(result->duration_ms / 1000),
+    .stop_usec = (int32_t)htonl((result->duration_ms % 1000) * 1000),
+    .error_cnt = (int32_t)htonl(result->lost),
+    .outorder_cnt = (int32_t)htonl(result->out_of_order),
+    .datagrams = (int32_t)htonl((uint32_t)max_id),
+    .jitter1 = (int32_t)htonl(result->jitter_us / 1000000),
+    .jitter2 = (int32_t)htonl(result->jitter_us % 1000000),
+  };
+
+  // The datagram header of the final datagram is echoed before the report
+  memcpy(ctx->buffer + sizeof(iperf_datagram_t), &report, sizeof(report));
+  sendto(sock, ctx->buffer, IPERF_UDP_MIN_LENGTH, 0, peer, peer_len);
+}
+
+/**
+ * @brief Run a UDP server, receiving datagrams until the final one.
+ *
+ * Jitter is the RFC 3550 interarrival jitter of the transit times, loss
+ * counts the sequence numbers never received.
+ *
+ * @param ctx The benchmark state.
+ * @param addr Local address to bind.
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if no datagram came, ESP_FAIL
+ * on a socket error.
+ */
+static esp_err_t udp_server(iperf_ctx_t *ctx, const struct sockaddr_in *addr)
+{
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (sock < 0)
+    return ESP_FAIL;
+  if (bind(sock, (const struct sockaddr *)addr, sizeof(*addr)) != 0)
+  {
+    ESP_LOGE(TAG, "Failed to bind: errno %d", errno);
+    close(sock);
+    return ESP_FAIL;
+  }
+  socket_set_timeout(sock, IPERF_POLL_MS);
+  ESP_LOGI(TAG, "UDP server listening on port %u", ctx->config->port);
+
+  wifi_api_iperf_result_t *result = ctx->result;
+  int64_t deadline = ctx->config->duration_s
+                       ? iperf_now_us() + ctx->config->duration_s * 1000000LL
+                       : INT64_MAX;
+  bool started = false;
+  int32_t expected = 0;
+  int32_t max_id = -1;
+  int64_t last_transit = 0;
+  int64_t jitter = 0;
+  int64_t now = 0;
+  esp_err_t err = ESP_ERR_TIMEOUT;
+
+  while (!iperf_stopped() && (started || iperf_now_us() < deadline))
+  {
+    struct sockaddr_storage peer;
+    socklen_t peer_len = sizeof(peer);
+    ssize_t received = recvfrom(sock, ctx->buffer, ctx->config->length, 0,
+                                (struct sockaddr *)&peer, &peer_len);
+    if (received < 0 && socket_timed_out())
+    {
+      iperf_progress(ctx, iperf_now_us());
+      continue;
+    }
+    if (received < 0)
+    {
+      ESP_LOGE(TAG, "Failed to receive: errno %d", errno);
+      err = ESP_FAIL;
+      break;
+    }
+    if (received < (ssize_t)sizeof(iperf_datagram_t))
+      continue;
+
+    iperf_datagram_t header;
+    memcpy(&header, ctx->buffer, sizeof(header));
+    int32_t id = (int32_t)ntohl((uint32_t)header.id);
+    now = iperf_now_us();
+    if (!started)
+    {
+      started = true;
+      iperf_begin(ctx);
+    }
+
+    if (id < 0)
+    {
+      iperf_end(ctx, now);
+      result->lost = max_id + 1 > (int32_t)result->datagrams
+                       ? max_id + 1 - result->datagrams
+                       : 0;
+      result->jitter_us = (uint32_t)(jitter / 16);
+      udp_server_report(ctx, sock, (struct sockaddr *)&peer, peer_len,
+                        max_id);
+      err = ESP_OK;
+      break;
+    }
+
+    result->bytes += received;
+    result->datagrams++;
+    if (id < expected)
+      result->out_of_order++;
+    else
+      expected = id + 1;
+    if (id > max_id)
+      max_id = id;
+
+    // Clocks are not synchronized, only the variation of the transit matters
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    int64_t transit =
+      ((int64_t)tv.tv_sec * 1000000 + tv.tv_usec) -
+      ((int64_t)ntohl(header.tv_sec) * 1000000 + ntohl(header.tv_usec));
+    if (result->datagrams > 1)
+    {
+      int64_t d = transit - last_transit;
+      if (d < 0)
+        d = -d;
+      // Kept scaled by 16, J += (|D| - J) / 16
+      jitter += d - (jitter + 8) / 16;
+    }
+    last_transit = transit;
+    iperf_progress(ctx, now);
+  }
+
+  if (err != ESP_OK && started)
+    iperf_end(ctx, now);
+  close(sock);
+  return err;
+}
+
+esp_err_t wifi_api_iperf_run(const wifi_api_iperf_config_t *config,
+                             wifi_api_iperf_result_t *result)
+{
+  if (!config || !result || config->length == 0 ||
+      (config->role == WIFI_API_IPERF_CLIENT &&
+       (!config->host || config->duration_s == 0)) ||
+      (config->proto == WIFI_API_IPERF_UDP &&
+       config->length < IPERF_UDP_MIN_LENGTH))
+    return ESP_ERR_INVALID_ARG;
+
+#if !CONFIG_IDF_TARGET_LINUX
+  if (!(wifi_api_get_state() & WIFI_API_STATE_GOT_IP4))
+    return ESP_ERR_INVALID_STATE;
+#endif
+
+  struct sockaddr_in addr = {
+    .sin_family = AF_INET,
+    .sin_port = htons(config->port),
+    .sin_addr.s_addr = htonl(INADDR_ANY),
+  };
+  if (config->role == WIFI_API_IPERF_CLIENT &&
+      inet_pton(AF_INET, config->host, &addr.sin_addr) != 1)
+    return ESP_ERR_INVALID_ARG;
+
+  memset(result, 0, sizeof(*result));
+  iperf_ctx_t ctx = {.config = config, .result = result};
+  ctx.buffer = malloc(config->length);
+  if (!ctx.buffer)
+    return ESP_ERR_NO_MEM;
+  __atomic_store_n(&s_stop, false, __ATOMIC_RELAXED);
+
+  iperf_cpu_sample_t cpu;
+  cpu_sample(&cpu);
+
+  esp_err_t err;
+  bool client = config->role == WIFI_API_IPERF_CLIENT;
+  if (config->proto == WIFI_API_IPERF_TCP)
+    err = client ? tcp_client(&ctx, &addr) : tcp_server(&ctx, &addr);
+  else
+    err = client ? udp_client(&ctx, &addr) : udp_server(&ctx, &addr);
+
+  cpu_load(&cpu, result);
+  free(ctx.buffer);
+
+  ESP_LOGI(TAG,
+           "%s %s: %llu bytes in %" PRIu32 " ms, %" PRIu32 " kbit/s, jitter "
+           "%" PRIu32 " us, %" PRIu32 "/%" PRIu32 " lost, CPU %d%% %d%%",
+           config->proto == WIFI_API_IPERF_TCP ? "TCP" : "UDP",
+           client ? "client" : "server", (unsigned long long)result->bytes,
+           result->duration_ms, result->throughput_kbps, result->jitter_us,
+           result->lost, result->datagrams + result->lost, result->cpu_load[0],
+           result->cpu_load[1]);
+  return err;
+}
+
+void wifi_api_iperf_stop()
+{
+  __atomic_store_n(&s_stop, true, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,245 @@
+/**
+ * @file wifi_api_link.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API link quality estimator
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <string.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_LINK";
+
+/**
+ * @brief Published link quality.
+ */
+typedef struct
+{
+  wifi_api_link_quality_t quality; /**< Link quality, `age_ms` unset. */
+  int64_t sampled_us;              /**< Time of the last sample. */
+} link_snapshot_t;
+
+/**
+ * @brief Whether the sampler is enabled.
+ */
+static bool s_enabled = true;
+
+/**
+ * @brief Sampler configuration.
+ */
+static wifi_api_link_config_t s_config = WIFI_API_LINK_CONFIG_DEFAULT();
+
+/**
+ * @brief Periodic timer sampling the RSSI.
+ */
+static esp_timer_handle_t s_sample_timer = NULL;
+
+/**
+ * @brief Link quality updated by the Wi-Fi manager task.
+ */
+static link_snapshot_t s_work = {0};
+
+/**
+ * @brief Time of the association.
+ */
+static int64_t s_associated_us = 0;
+
+/**
+ * @brief Snapshots read by `wifi_api_get_link_quality`, the manager task
+ * writes the one not published.
+ */
+static link_snapshot_t s_snapshots[2] = {0};
+
+/**
+ * @brief Number of publications, its low bit selects the published snapshot.
+ */
+static uint32_t s_sequence = 0;
+
+/**
+ * @brief Publish `s_work`, called by the Wi-Fi manager task only.
+ */
+static void link_publish()
+{
+  uint32_t sequence = s_sequence;
+
+  // Readers of the other snapshot must see the sequence change before it is
+  // overwritten
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  s_snapshots[(sequence + 1) & 1] = s_work;
+  __atomic_store_n(&s_sequence, sequence + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Sample timer callback, the sample is taken on the manager task.
+ *
+ * @param arg User-defined argument (not used).
+ */
+static void link_sample_timer(void *arg)
+{
+  // A sample dropped on a full queue is covered by the next one
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_LINK_SAMPLE};
+  wifi_api_task_post(&cmd, 0);
+}
+
+/**
+ * @brief Start or stop the sample timer from the configuration and the
+ * connection.
+ */
+static void link_timer_restart()
+{
+  if (!s_sample_timer)
+    return;
+
+  esp_timer_stop(s_sample_timer);
+  if (s_enabled && s_work.quality.connected)
+    esp_timer_start_periodic(s_sample_timer, s_config.sample_ms * 1000ULL);
+}
+
+/**
+ * @brief Add an RSSI sample to the statistics.
+ *
+ * The average and variance are exponentially weighted, the trend is the
+ * change of the average per second smoothed with the same weight.
+ *
+ * @param rssi The RSSI in dBm.
+ * @param now The time of the sample.
+ */
+static void link_update(int8_t rssi, int64_t now)
+{
+  wifi_api_link_quality_t *q = &s_work.quality;
+  float alpha = s_config.weight / 100.0f;
+
+  if (q->samples == 0)
+  {
+    q->rssi_avg = rssi;
+    q->rssi_var = 0;
+    q->trend = 0;
+  }
+  else
+  {
+    float previous = q->rssi_avg;
+    float diff = rssi - q->rssi_avg;
+    float increment = alpha * diff;
+    q->rssi_avg += increment;
+    q->rssi_var = (1 - alpha) * (q->rssi_var + diff * increment);
+
+    float elapsed_s = (now - s_work.sampled_us) / 1000000.0f;
+    if (elapsed_s > 0)
+      q->trend += alpha * ((q->rssi_avg - previous) / elapsed_s - q->trend);
+  }
+
+  q->rssi = rssi;
+  q->samples++;
+  q->connected_ms = (uint32_t)((now - s_associated_us) / 1000);
+  s_work.sampled_us = now;
+}
+
+void wifi_api_link_associated(const wifi_event_sta_connected_t *event,
+                              uint32_t attempts)
+{
+  if (!s_sample_timer)
+  {
+    const esp_timer_create_args_t timer_args = {
+      .callback = &link_sample_timer, .name = "wifi_link"};
+    if (esp_timer_create(&timer_args, &s_sample_timer) != ESP_OK)
+      ESP_LOGW(TAG, "Failed to create the link sample timer");
+  }
+
+  memset(&s_work, 0, sizeof(s_work));
+  wifi_api_link_quality_t *q = &s_work.quality;
+  q->connected = true;
+  memcpy(q->bssid, event->bssid, sizeof(q->bssid));
+  q->channel = event->channel;
+  q->connect_attempts = attempts;
+  s_associated_us = esp_timer_get_time();
+
+  // The AP record holds the RSSI of the association, the first sample
+  wifi_ap_record_t ap;
+  if (s_enabled && esp_wifi_sta_get_ap_info(&ap) == ESP_OK)
+    link_update(ap.rssi, s_associated_us);
+
+  link_publish();
+  link_timer_restart();
+}
+
+void wifi_api_link_disconnected()
+{
+  if (!s_work.quality.connected)
+    return;
+
+  s_work.quality.connected = false;
+  link_publish();
+  link_timer_restart();
+}
+
+void wifi_api_link_beacon_timeout()
+{
+  if (!s_work.quality.connected)
+    return;
+
+  s_work.quality.beacon_timeouts++;
+  link_publish();
+}
+
+esp_err_t wifi_api_link_configure(const wifi_api_link_config_t *config)
+{
+  s_enabled = config != NULL;
+  if (config)
+    s_config = *config;
+  link_timer_restart();
+  return ESP_OK;
+}
+
+void wifi_api_link_sample()
+{
+  if (!s_enabled || !s_work.quality.connected)
+    return;
+
+  int rssi;
+  esp_err_t err = esp_wifi_sta_get_rssi(&rssi);
+  if (err != ESP_OK)
+  {
+    ESP_LOGD(TAG, "Failed to read the RSSI: %s", esp_err_to_name(err));
+    s_work.quality.sample_errors++;
+  }
+  else
+    link_update((int8_t)rssi, esp_timer_get_time());
+  link_publish();
+}
+
+esp_err_t wifi_api_get_link_quality(wifi_api_link_quality_t *quality)
+{
+  if (!quality)
+    return ESP_ERR_INVALID_ARG;
+
+  // Retried if the manager task published while copying, which at most
+  // one sample period apart is rare
+  link_snapshot_t snapshot;
+  uint32_t sequence;
+  do
+  {
+    sequence = __atomic_load_n(&s_sequence, __ATOMIC_ACQUIRE);
+    snapshot = s_snapshots[sequence & 1];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while (__atomic_load_n(&s_sequence, __ATOMIC_RELAXED) != sequence);
+
+  *quality = snapshot.quality;
+  if (quality->samples == 0)
+    return ESP_ERR_INVALID_STATE;
+
+  quality->age_ms =
+    (uint32_t)((esp_timer_get_time() - snapshot.sampled_us) / 1000);
+  return ESP_OK;
+}
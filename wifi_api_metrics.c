@@ -0,0 +1,159 @@
+/**
+ * @file wifi_api_metrics.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API connection phase latency histograms
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <inttypes.h>
+#include <string.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_METRICS";
+
+/**
+ * @brief Number of histogram buckets.
+ *
+ * Bucket 0 holds durations below 1 ms and bucket `i` durations in
+ * [2^(i-1), 2^i) ms, the last bucket holds everything above.
+ */
+#define PHASE_BUCKETS 18
+
+/**
+ * @brief Names of the connection phases, indexed by `wifi_api_phase_t`.
+ */
+static const char *const PHASE_NAMES[WIFI_API_PHASE_MAX] = {
+  [WIFI_API_PHASE_DRIVER_INIT] = "driver init",
+  [WIFI_API_PHASE_START] = "start",
+  [WIFI_API_PHASE_CONNECT] = "connect",
+  [WIFI_API_PHASE_DHCP] = "got ip",
+  [WIFI_API_PHASE_TOTAL] = "total",
+  [WIFI_API_PHASE_ROAM] = "roam",
+  [WIFI_API_PHASE_PROBE] = "probe",
+};
+
+/**
+ * @brief Latency histogram of a connection phase.
+ */
+typedef struct
+{
+  uint32_t count;                   /**< Number of samples. */
+  uint32_t min_us;                  /**< Shortest sample. */
+  uint32_t max_us;                  /**< Longest sample. */
+  uint64_t sum_us;                  /**< Sum of the samples. */
+  uint32_t buckets[PHASE_BUCKETS]; /**< Samples per bucket. */
+} phase_histogram_t;
+
+/**
+ * @brief Histograms of the connection phases.
+ */
+static phase_histogram_t s_histograms[WIFI_API_PHASE_MAX] = {0};
+
+/**
+ * @brief Lock protecting `s_histograms`.
+ */
+static portMUX_TYPE s_histograms_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Get the bucket of a duration.
+ *
+ * @param duration_us The duration in microseconds.
+ * @return The bucket index.
+ */
+static size_t phase_bucket(uint32_t duration_us)
+{
+  uint32_t ms = duration_us / 1000;
+  if (ms == 0)
+    return 0;
+
+  size_t bucket = 32 - __builtin_clz(ms);
+  return bucket < PHASE_BUCKETS ? bucket : PHASE_BUCKETS - 1;
+}
+
+void wifi_api_phase_record(wifi_api_phase_t phase, int64_t duration_us)
+{
+  if (phase >= WIFI_API_PHASE_MAX || duration_us < 0)
+    return;
+
+  uint32_t duration = duration_us > UINT32_MAX ? UINT32_MAX : duration_us;
+  phase_histogram_t *h = &s_histograms[phase];
+
+  taskENTER_CRITICAL(&s_histograms_lock);
+  if (h->count == 0 || duration < h->min_us)
+    h->min_us = duration;
+  if (duration > h->max_us)
+    h->max_us = duration;
+  h->sum_us += duration;
+  h->count++;
+  h->buckets[phase_bucket(duration)]++;
+  taskEXIT_CRITICAL(&s_histograms_lock);
+}
+
+esp_err_t wifi_api_get_phase_stats(wifi_api_phase_t phase,
+                                   wifi_api_phase_stats_t *stats)
+{
+  if (phase >= WIFI_API_PHASE_MAX || !stats)
+    return ESP_ERR_INVALID_ARG;
+
+  phase_histogram_t h;
+  taskENTER_CRITICAL(&s_histograms_lock);
+  h = s_histograms[phase];
+  taskEXIT_CRITICAL(&s_histograms_lock);
+
+  memset(stats, 0, sizeof(*stats));
+  stats->count = h.count;
+  if (h.count == 0)
+    return ESP_OK;
+
+  stats->min_us = h.min_us;
+  stats->max_us = h.max_us;
+  stats->avg_us = h.sum_us / h.count;
+
+  // Upper bound of the bucket holding the 95th percentile
+  uint32_t rank = (h.count * 95 + 99) / 100;
+  uint32_t seen = 0;
+  for (size_t i = 0; i < PHASE_BUCKETS; i++)
+  {
+    seen += h.buckets[i];
+    if (seen >= rank)
+    {
+      uint64_t upper_us = (1ULL << i) * 1000;
+      stats->p95_us = upper_us < h.max_us ? upper_us : h.max_us;
+      break;
+    }
+  }
+  return ESP_OK;
+}
+
+void wifi_api_reset_phase_stats()
+{
+  taskENTER_CRITICAL(&s_histograms_lock);
+  memset(s_histograms, 0, sizeof(s_histograms));
+  taskEXIT_CRITICAL(&s_histograms_lock);
+}
+
+void wifi_api_dump_phase_stats()
+{
+  for (wifi_api_phase_t phase = 0; phase < WIFI_API_PHASE_MAX; phase++)
+  {
+    wifi_api_phase_stats_t stats;
+    wifi_api_get_phase_stats(phase, &stats);
+    ESP_LOGI(TAG,
+             "%-11s n=%" PRIu32 " min=%" PRIu32 " avg=%" PRIu32
+             " max=%" PRIu32 " p95<=%" PRIu32 " us",
+             PHASE_NAMES[phase], stats.count, stats.min_us, stats.avg_us,
+             stats.max_us, stats.p95_us);
+  }
+}
@@ -0,0 +1,355 @@
+/**
+ * @file wifi_api_power.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API modem power-save profiles and activity governor
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_log.h>
+#include <esp_netif_net_stack.h>
+#include <esp_timer.h>
+#include <lwip/netif.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_POWER";
+
+/**
+ * @brief Driver power-save mode of each profile.
+ */
+static const wifi_ps_type_t PS_TYPES[WIFI_API_POWER_PROFILE_MAX] = {
+  WIFI_PS_NONE,
+  WIFI_PS_MIN_MODEM,
+  WIFI_PS_MAX_MODEM,
+};
+
+/**
+ * @brief Name of each profile, for logging.
+ */
+static const char *PROFILE_NAMES[WIFI_API_POWER_PROFILE_MAX] = {
+  "none",
+  "min-modem",
+  "max-modem",
+};
+
+/**
+ * @brief Profile in use, the driver default until changed.
+ */
+static wifi_api_power_profile_t s_profile = WIFI_API_POWER_MIN_MODEM;
+
+/**
+ * @brief Listen interval in beacon intervals used by the max-modem profile.
+ */
+static uint8_t s_listen_interval = 3;
+
+/**
+ * @brief Whether the governor selects the profile.
+ */
+static bool s_governor_enabled = false;
+
+/**
+ * @brief Governor configuration.
+ */
+static wifi_api_power_governor_t s_governor = {0};
+
+/**
+ * @brief Periodic timer sampling the traffic for the governor.
+ */
+static esp_timer_handle_t s_sample_timer = NULL;
+
+/**
+ * @brief Packets received and sent by the station interface.
+ */
+static uint32_t s_packets = 0;
+
+/**
+ * @brief Value of `s_packets` at the last sample.
+ */
+static uint32_t s_sampled_packets = 0;
+
+/**
+ * @brief Time of the last sample with activity.
+ */
+static int64_t s_active_us = 0;
+
+/**
+ * @brief Input function of the station interface, wrapped to count packets.
+ */
+static netif_input_fn s_input = NULL;
+
+/**
+ * @brief Output function of the station interface, wrapped to count packets.
+ */
+static netif_linkoutput_fn s_linkoutput = NULL;
+
+/**
+ * @brief Whether the driver is started, only then is time accounted.
+ */
+static bool s_running = false;
+
+/**
+ * @brief Time the accounting of the current profile last advanced.
+ */
+static int64_t s_since_us = 0;
+
+/**
+ * @brief Time spent in each profile while started.
+ */
+static uint64_t s_time_us[WIFI_API_POWER_PROFILE_MAX] = {0};
+
+/**
+ * @brief Number of profile changes.
+ */
+static uint32_t s_switches = 0;
+
+/**
+ * @brief Lock protecting the accounting read by `wifi_api_get_power_stats`.
+ */
+static portMUX_TYPE s_power_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Count a received packet and pass it to the stack.
+ *
+ * @param p The packet.
+ * @param netif The lwIP interface.
+ * @return The result of the wrapped input function.
+ */
+static err_t power_input(struct pbuf *p, struct netif *netif)
+{
+  __atomic_fetch_add(&s_packets, 1, __ATOMIC_RELAXED);
+  return s_input(p, netif);
+}
+
+/**
+ * @brief Count a sent packet and pass it to the driver.
+ *
+ * @param netif The lwIP interface.
+ * @param p The packet.
+ * @return The result of the wrapped output function.
+ */
+static err_t power_linkoutput(struct netif *netif, struct pbuf *p)
+{
+  __atomic_fetch_add(&s_packets, 1, __ATOMIC_RELAXED);
+  return s_linkoutput(netif, p);
+}
+
+/**
+ * @brief Advance the time of the current profile, called with the lock
+ * held.
+ *
+ * @param now The current time.
+ */
+static void power_account(int64_t now)
+{
+  if (s_running)
+    s_time_us[s_profile] += now - s_since_us;
+  s_since_us = now;
+}
+
+/**
+ * @brief Select a profile, applied to the driver if it is started.
+ *
+ * @param profile The profile.
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t power_switch(wifi_api_power_profile_t profile)
+{
+  if (s_running)
+  {
+    esp_err_t err = esp_wifi_set_ps(PS_TYPES[profile]);
+    if (err != ESP_OK)
+    {
+      ESP_LOGW(TAG, "Failed to apply power profile %s: %s",
+               PROFILE_NAMES[profile], esp_err_to_name(err));
+      return err;
+    }
+  }
+  if (profile == s_profile)
+    return ESP_OK;
+
+  taskENTER_CRITICAL(&s_power_lock);
+  power_account(esp_timer_get_time());
+  s_profile = profile;
+  s_switches++;
+  taskEXIT_CRITICAL(&s_power_lock);
+
+  ESP_LOGI(TAG, "Power profile %s", PROFILE_NAMES[profile]);
+  return ESP_OK;
+}
+
+/**
+ * @brief Sample timer callback, the sample is taken on the manager task.
+ *
+ * @param arg User-defined argument (not used).
+ */
+static void power_sample_timer(void *arg)
+{
+  // A sample dropped on a full queue is covered by the next one
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_POWER_SAMPLE};
+  wifi_api_task_post(&cmd, 0);
+}
+
+/**
+ * @brief Restart the governor sampling from the current traffic.
+ */
+static void governor_restart()
+{
+  s_sampled_packets = __atomic_load_n(&s_packets, __ATOMIC_RELAXED);
+  s_active_us = esp_timer_get_time();
+
+  esp_timer_stop(s_sample_timer);
+  if (s_governor_enabled && s_running)
+    esp_timer_start_periodic(s_sample_timer, s_governor.sample_ms * 1000ULL);
+}
+
+/**
+ * @brief Wrap the input and output functions of the lwIP interface, run on
+ * the TCP/IP thread so no packet is in flight.
+ *
+ * @param ctx The station interface.
+ * @return ESP_OK.
+ */
+static esp_err_t power_wrap(void *ctx)
+{
+  struct netif *lwip_netif = esp_netif_get_netif_impl(ctx);
+  if (!lwip_netif || lwip_netif->input == &power_input)
+    return ESP_OK;
+
+  s_input = lwip_netif->input;
+  s_linkoutput = lwip_netif->linkoutput;
+  lwip_netif->input = &power_input;
+  lwip_netif->linkoutput = &power_linkoutput;
+  return ESP_OK;
+}
+
+void wifi_api_power_attach(esp_netif_t *netif)
+{
+  // Every STA_START adds the interface to lwIP again, which restores its
+  // functions, so they are wrapped again on each association
+  esp_err_t err = esp_netif_tcpip_exec(&power_wrap, netif);
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "Failed to count the station traffic: %s",
+             esp_err_to_name(err));
+}
+
+void wifi_api_power_started()
+{
+  taskENTER_CRITICAL(&s_power_lock);
+  s_running = true;
+  s_since_us = esp_timer_get_time();
+  taskEXIT_CRITICAL(&s_power_lock);
+
+  esp_err_t err = esp_wifi_set_ps(PS_TYPES[s_profile]);
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "Failed to apply power profile %s: %s",
+             PROFILE_NAMES[s_profile], esp_err_to_name(err));
+  if (s_sample_timer)
+    governor_restart();
+}
+
+void wifi_api_power_stopped()
+{
+  taskENTER_CRITICAL(&s_power_lock);
+  power_account(esp_timer_get_time());
+  s_running = false;
+  taskEXIT_CRITICAL(&s_power_lock);
+
+  if (s_sample_timer)
+    esp_timer_stop(s_sample_timer);
+}
+
+uint8_t wifi_api_power_listen_interval()
+{
+  return s_listen_interval;
+}
+
+esp_err_t wifi_api_power_set(wifi_api_power_profile_t profile,
+                             uint8_t listen_interval)
+{
+  if (s_governor_enabled)
+    return ESP_ERR_INVALID_STATE;
+
+  if (listen_interval > 0)
+    s_listen_interval = listen_interval;
+  return power_switch(profile);
+}
+
+esp_err_t wifi_api_power_governor(const wifi_api_power_governor_t *config)
+{
+  if (!s_sample_timer)
+  {
+    const esp_timer_create_args_t timer_args = {
+      .callback = &power_sample_timer, .name = "wifi_power"};
+    esp_err_t err = esp_timer_create(&timer_args, &s_sample_timer);
+    if (err != ESP_OK)
+      return err;
+  }
+
+  s_governor_enabled = config != NULL;
+  if (config)
+    s_governor = *config;
+  governor_restart();
+  return ESP_OK;
+}
+
+void wifi_api_power_sample()
+{
+  if (!s_governor_enabled || !s_running)
+    return;
+
+  uint32_t packets = __atomic_load_n(&s_packets, __ATOMIC_RELAXED);
+  uint32_t delta = packets - s_sampled_packets;
+  s_sampled_packets = packets;
+
+  // Traffic switches to the active profile at once, idling takes a while
+  int64_t now = esp_timer_get_time();
+  wifi_api_power_profile_t profile = s_profile;
+  if (delta >= s_governor.active_packets)
+  {
+    s_active_us = now;
+    profile = s_governor.active_profile;
+  }
+  else if (now - s_active_us >= s_governor.idle_ms * 1000LL)
+    profile = s_governor.idle_profile;
+
+  if (profile != s_profile)
+    power_switch(profile);
+}
+
+wifi_api_power_profile_t wifi_api_get_power_profile()
+{
+  return s_profile;
+}
+
+esp_err_t wifi_api_get_power_stats(wifi_api_power_stats_t *stats)
+{
+  if (!stats)
+    return ESP_ERR_INVALID_ARG;
+
+  taskENTER_CRITICAL(&s_power_lock);
+  power_account(esp_timer_get_time());
+  for (size_t i = 0; i < WIFI_API_POWER_PROFILE_MAX; i++)
+    stats->time_ms[i] = s_time_us[i] / 1000;
+  stats->switches = s_switches;
+  taskEXIT_CRITICAL(&s_power_lock);
+  return ESP_OK;
+}
+
+void wifi_api_reset_power_stats()
+{
+  taskENTER_CRITICAL(&s_power_lock);
+  power_account(esp_timer_get_time());
+  for (size_t i = 0; i < WIFI_API_POWER_PROFILE_MAX; i++)
+    s_time_us[i] = 0;
+  s_switches = 0;
+  taskEXIT_CRITICAL(&s_power_lock);
+}
@@ -0,0 +1,599 @@
+/**
+ * @file wifi_api_priv.h
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API internal functions shared between the component sources
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef WIFI_API_PRIV_H
+#define WIFI_API_PRIV_H
+
+#include "wifi_api.h"
+
+#include <esp_event.h>
+#include <esp_wifi.h>
+#include <freertos/FreeRTOS.h>
+
+/**
+ * @brief Maximum number of channels in a scan channel set.
+ */
+#define WIFI_API_SCAN_MAX_CHANNELS 14
+
+/**
+ * @brief Channels of the APs listed in an 802.11k neighbor report.
+ */
+typedef struct
+{
+  uint8_t channels[WIFI_API_SCAN_MAX_CHANNELS]; /**< Distinct channels. */
+  uint8_t count;                                /**< Number of channels. */
+} wifi_api_neighbors_t;
+
+/**
+ * @brief Commands executed by the Wi-Fi manager task.
+ */
+typedef enum
+{
+  WIFI_API_CMD_CONFIGURE = 0,    /**< Initialize and connect the station. */
+  WIFI_API_CMD_DISCONNECT,       /**< Disconnect and release the driver. */
+  WIFI_API_CMD_INIT,             /**< Take a reference on the driver. */
+  WIFI_API_CMD_DEINIT,           /**< Release a reference on the driver. */
+  WIFI_API_CMD_START,            /**< Take a reference on the radio. */
+  WIFI_API_CMD_STOP,             /**< Release a reference on the radio. */
+  WIFI_API_CMD_ALTER_STA,        /**< Change the station credentials. */
+  WIFI_API_CMD_SCAN_START,       /**< Start a non-blocking scan. */
+  WIFI_API_CMD_SCAN_STOP,        /**< Stop the running scan. */
+  WIFI_API_CMD_SCAN_CACHED,      /**< Query the scan cache. */
+  WIFI_API_CMD_SCAN_RESULTS,     /**< Get the records of the last scan. */
+  WIFI_API_CMD_SET_ROAMING,      /**< Change the roaming configuration. */
+  WIFI_API_CMD_ROAM_TIMEOUT,     /**< Roaming deadline timer expired. */
+  WIFI_API_CMD_SET_DRIVER_PROFILE, /**< Change the driver buffer profile. */
+  WIFI_API_CMD_SET_POWER,        /**< Change the power-save profile. */
+  WIFI_API_CMD_SET_GOVERNOR,     /**< Change the power governor. */
+  WIFI_API_CMD_POWER_SAMPLE,     /**< Power governor sample timer expired. */
+  WIFI_API_CMD_SET_LINK,         /**< Change the link quality sampler. */
+  WIFI_API_CMD_LINK_SAMPLE,      /**< Link quality sample timer expired. */
+  WIFI_API_CMD_SET_WATCHDOG,     /**< Change the connectivity watchdog. */
+  WIFI_API_CMD_WATCHDOG_PROBED,  /**< Connectivity watchdog probe finished. */
+  WIFI_API_CMD_EVENT,            /**< Wi-Fi or IP event from the event loop. */
+  WIFI_API_CMD_CONNECT_TIMEOUT,  /**< Connection timeout timer expired. */
+  WIFI_API_CMD_RETRY,            /**< Reconnection timer expired. */
+  WIFI_API_CMD_LEASE_EXPIRED,    /**< Cached lease expiry timer expired. */
+  WIFI_API_CMD_LEASE_PROBED,     /**< Cached lease gateway probe finished. */
+  WIFI_API_CMD_SET_RETRY_POLICY, /**< Change the retry policy of a reason. */
+  WIFI_API_CMD_SET_RETRY_CONFIG, /**< Change the reconnection backoff. */
+  WIFI_API_CMD_SET_IP_MODE,      /**< Change the IP configuration mode. */
+  WIFI_API_CMD_RESET_DISCONNECT_COUNTS, /**< Clear the reason counters. */
+  WIFI_API_CMD_SET_RSSI_THRESHOLD, /**< Change the RSSI low threshold. */
+  WIFI_API_CMD_REMOVE_PROFILE,   /**< Remove a credential profile. */
+  WIFI_API_CMD_DRAIN,            /**< Wake the task to run latched commands. */
+} wifi_api_cmd_id_t;
+
+/**
+ * @brief Command queued to the Wi-Fi manager task.
+ *
+ * Every argument is copied into the command, so the caller buffers do not
+ * need to outlive the call.
+ */
+typedef struct
+{
+  wifi_api_cmd_id_t id;      /**< Command to execute. */
+  wifi_api_done_cb_t done;   /**< Completion callback, may be NULL. */
+  void *done_arg;            /**< User argument passed to `done`. */
+  union
+  {
+    struct
+    {
+      char ssid[33];                 /**< SSID of the network. */
+      char password[65];             /**< Password of the network. */
+      uint32_t timeout_ms;           /**< Connection timeout, 0 for none. */
+      wifi_api_connect_cb_t callback; /**< Connection result callback. */
+      void *arg;                     /**< User argument of `callback`. */
+    } configure; /**< `WIFI_API_CMD_CONFIGURE` and `WIFI_API_CMD_ALTER_STA`. */
+    struct
+    {
+      wifi_api_scan_config_t config; /**< Scan configuration. */
+      uint8_t channels[WIFI_API_SCAN_MAX_CHANNELS]; /**< Channel set copy. */
+      wifi_api_scan_record_cb_t record_cb; /**< Per-record callback. */
+      wifi_api_scan_entry_cb_t entry_cb;   /**< Per-entry callback. */
+      wifi_api_scan_done_cb_t done_cb;     /**< Completion callback. */
+      void *arg;                           /**< User argument. */
+    } scan; /**< `WIFI_API_CMD_SCAN_START` and `WIFI_API_CMD_SCAN_CACHED`. */
+    struct
+    {
+      const wifi_ap_record_t **records; /**< Where the records are returned. */
+      uint16_t *count;                  /**< Where their number is returned. */
+    } scan_results; /**< `WIFI_API_CMD_SCAN_RESULTS`. */
+    struct
+    {
+      bool enable;                   /**< Whether roaming is enabled. */
+      wifi_api_roam_config_t config; /**< Roaming configuration. */
+      uint8_t channels[WIFI_API_SCAN_MAX_CHANNELS]; /**< Channel set copy. */
+    } roam; /**< `WIFI_API_CMD_SET_ROAMING`. */
+    struct
+    {
+      wifi_api_power_profile_t profile; /**< Power-save profile. */
+      uint8_t listen_interval;          /**< Listen interval, 0 to keep. */
+      bool enable;                      /**< Whether to enable the governor. */
+      wifi_api_power_governor_t governor; /**< Governor configuration. */
+    } power; /**< `WIFI_API_CMD_SET_POWER` and `WIFI_API_CMD_SET_GOVERNOR`. */
+    struct
+    {
+      bool enable;                   /**< Whether to enable the sampler. */
+      wifi_api_link_config_t config; /**< Sampler configuration. */
+    } link; /**< `WIFI_API_CMD_SET_LINK`. */
+    struct
+    {
+      bool enable;                       /**< Whether to enable it. */
+      wifi_api_watchdog_config_t config; /**< Watchdog configuration. */
+      char host[16];                     /**< Copy of the probed address. */
+    } watchdog; /**< `WIFI_API_CMD_SET_WATCHDOG`. */
+    struct
+    {
+      uint8_t reason;                 /**< Disconnect reason. */
+      wifi_api_retry_action_t action; /**< Action for the reason. */
+      uint8_t limit;                  /**< Occurrences before giving up. */
+    } retry_policy; /**< `WIFI_API_CMD_SET_RETRY_POLICY`. */
+    wifi_api_retry_config_t retry; /**< `WIFI_API_CMD_SET_RETRY_CONFIG`. */
+    struct
+    {
+      wifi_api_ip_mode_t mode;        /**< IP configuration mode. */
+      bool has_static_ip;             /**< Whether `static_ip` is set. */
+      wifi_api_ip_config_t static_ip; /**< Static IP configuration. */
+    } ip; /**< `WIFI_API_CMD_SET_IP_MODE`. */
+    struct
+    {
+      esp_event_base_t base; /**< Event base. */
+      int32_t id;            /**< Event ID. */
+      union
+      {
+        wifi_event_sta_connected_t connected;
+        wifi_event_sta_disconnected_t disconnected;
+        wifi_event_bss_rssi_low_t rssi_low;
+        wifi_event_sta_scan_done_t scan_done;
+        ip_event_got_ip_t got_ip;
+        ip_event_got_ip6_t got_ip6;
+        wifi_api_neighbors_t neighbors;
+      } data; /**< Copy of the event data of the handled events. */
+    } event; /**< `WIFI_API_CMD_EVENT`. */
+    int8_t rssi;    /**< `WIFI_API_CMD_SET_RSSI_THRESHOLD`. */
+    char ssid[33];  /**< `WIFI_API_CMD_REMOVE_PROFILE`. */
+    uint32_t value; /**< Argument of the timer and probe commands. */
+  };
+} wifi_api_cmd_t;
+
+/**
+ * @brief Queue a command to the Wi-Fi manager task.
+ *
+ * Creates the task and its queue on first use.
+ *
+ * @param[in] cmd The command, copied into the queue.
+ * @param[in] wait Ticks to wait for a free slot when the queue is full.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task could not be created
+ * or the queue is full.
+ */
+esp_err_t wifi_api_task_post(const wifi_api_cmd_t *cmd, TickType_t wait);
+
+/**
+ * @brief Queue a command that must not be dropped to the Wi-Fi manager task.
+ *
+ * When the queue stays full for `wait`, the command is latched and runs in
+ * the place of a wake-up queued behind it, or once the queue is empty. The
+ * commands posted while some are latched are latched behind them, so events
+ * keep their order. A latched timer command replaces the one latched before
+ * it, so only the latest of each is kept.
+ *
+ * @param[in] cmd The command, copied.
+ * @param[in] wait Ticks to wait for a free slot before latching.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task could not be
+ * created or the latch is full.
+ */
+esp_err_t wifi_api_task_post_latched(const wifi_api_cmd_t *cmd,
+                                     TickType_t wait);
+
+/**
+ * @brief Execute a command on the Wi-Fi manager task and wait for its result.
+ *
+ * When called from the manager task itself the command runs directly.
+ *
+ * @param[in] cmd The command, its completion callback is replaced.
+ * @return The result of the command.
+ */
+esp_err_t wifi_api_task_call(wifi_api_cmd_t *cmd);
+
+/**
+ * @brief Whether the caller runs on the Wi-Fi manager task.
+ *
+ * @return true if called from the manager task.
+ */
+bool wifi_api_task_is_current();
+
+/**
+ * @brief Execute a command, called by the Wi-Fi manager task.
+ *
+ * @param[in] cmd The command.
+ * @return The result of the command.
+ */
+esp_err_t wifi_api_execute(const wifi_api_cmd_t *cmd);
+
+/**
+ * @brief Start a scan, called by the Wi-Fi manager task.
+ *
+ * @param[in] config The scan configuration.
+ * @param[in] record_cb Callback for each access point found, may be NULL.
+ * @param[in] done_cb Completion callback, may be NULL.
+ * @param[in] arg User argument passed to the callbacks.
+ * @return ESP_OK if the scan was started, an error code otherwise.
+ */
+esp_err_t wifi_api_scan_execute_start(const wifi_api_scan_config_t *config,
+                                      wifi_api_scan_record_cb_t record_cb,
+                                      wifi_api_scan_done_cb_t done_cb,
+                                      void *arg);
+
+/**
+ * @brief Stop the running scan, called by the Wi-Fi manager task.
+ *
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if no scan is running.
+ */
+esp_err_t wifi_api_scan_execute_stop();
+
+/**
+ * @brief Get the records of the last scan, called by the Wi-Fi manager task.
+ *
+ * @param[out] records The stored records.
+ * @param[out] count Number of stored records.
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if the buffer could not hold
+ * every record found, ESP_ERR_INVALID_STATE if a scan is running.
+ */
+esp_err_t wifi_api_scan_execute_results(const wifi_ap_record_t **records,
+                                        uint16_t *count);
+
+/**
+ * @brief Query the scan cache, called by the Wi-Fi manager task.
+ *
+ * @param[in] config The scan configuration.
+ * @param[in] entry_cb Callback for each fresh access point, may be NULL.
+ * @param[in] done_cb Completion callback, may be NULL.
+ * @param[in] arg User argument passed to the callbacks.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a query is pending or a
+ * scan is needed while another one is running.
+ */
+esp_err_t wifi_api_scan_execute_cached(const wifi_api_scan_config_t *config,
+                                       wifi_api_scan_entry_cb_t entry_cb,
+                                       wifi_api_scan_done_cb_t done_cb,
+                                       void *arg);
+
+/**
+ * @brief Register the handler forwarding `WIFI_EVENT_SCAN_DONE` to the Wi-Fi
+ * manager task, called by the Wi-Fi manager task.
+ *
+ * The handler stays registered across driver restarts, so it is registered
+ * once.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+esp_err_t wifi_api_scan_attach();
+
+/**
+ * @brief Handle `WIFI_EVENT_SCAN_DONE`, called by the Wi-Fi manager task.
+ *
+ * @param[in] event The scan done event data.
+ */
+void wifi_api_scan_handle_done(const wifi_event_sta_scan_done_t *event);
+
+/**
+ * @brief Set `WIFI_API_STATE_*` bits of the published state.
+ *
+ * @param[in] bits The bits to set.
+ */
+void wifi_api_state_set(uint32_t bits);
+
+/**
+ * @brief Clear `WIFI_API_STATE_*` bits of the published state.
+ *
+ * @param[in] bits The bits to clear.
+ */
+void wifi_api_state_clear(uint32_t bits);
+
+/**
+ * @brief Publish a component event to its subscribers, called by the Wi-Fi
+ * manager task.
+ *
+ * @param[in] data The event data.
+ */
+void wifi_api_event_publish(const wifi_api_event_data_t *data);
+
+/**
+ * @brief Start the scan selecting the best profile access point, called by
+ * the Wi-Fi manager task.
+ *
+ * @param[in] done_cb Completion callback of the scan.
+ * @return ESP_OK if the scan was started, an error code otherwise.
+ */
+esp_err_t wifi_api_profile_scan(wifi_api_scan_done_cb_t done_cb);
+
+/**
+ * @brief Apply the best access point of the last selection scan.
+ *
+ * @param[in,out] wc The station configuration, its credentials, BSSID and
+ * channel are set.
+ * @return true if a profile access point was found.
+ */
+bool wifi_api_profile_best(wifi_config_t *wc);
+
+/**
+ * @brief Apply the credentials of the profile of an SSID.
+ *
+ * @param[in] ssid The SSID.
+ * @param[in,out] wc The station configuration, its credentials are set.
+ * @return true if a profile has this SSID.
+ */
+bool wifi_api_profile_lookup(const char *ssid, wifi_config_t *wc);
+
+/**
+ * @brief Whether no profile has a higher priority than the one of an SSID.
+ *
+ * @param[in] ssid The SSID.
+ * @return true if a profile has this SSID and none is preferred to it.
+ */
+bool wifi_api_profile_is_top(const char *ssid);
+
+/**
+ * @brief Remove a credential profile, on the Wi-Fi manager task.
+ *
+ * @param[in] ssid The SSID of the profile.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such profile.
+ */
+esp_err_t wifi_api_profile_execute_remove(const char *ssid);
+
+/**
+ * @brief Skip the profile in use in the next selections.
+ */
+void wifi_api_profile_exclude_current();
+
+/**
+ * @brief Allow every profile in the next selections.
+ */
+void wifi_api_profile_reset_exclusions();
+
+/**
+ * @brief Apply a roaming configuration, called by the Wi-Fi manager task.
+ *
+ * @param[in] config The configuration, NULL disables roaming.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE while roaming.
+ */
+esp_err_t wifi_api_roam_configure(const wifi_api_roam_config_t *config);
+
+/**
+ * @brief Get the RSSI threshold that triggers roaming.
+ *
+ * @return The threshold in dBm, 0 if roaming is disabled.
+ */
+int8_t wifi_api_roam_threshold();
+
+/**
+ * @brief Handle an RSSI low event, starts the roaming scan below the
+ * threshold.
+ *
+ * @param[in] rssi The reported RSSI.
+ */
+void wifi_api_roam_rssi_low(int8_t rssi);
+
+/**
+ * @brief Abandon the roaming attempt once its deadline expired.
+ */
+void wifi_api_roam_timeout();
+
+/**
+ * @brief Handle an association, records the roam latency of our roams and of
+ * those initiated by the supplicant.
+ *
+ * @param[in] moved Whether the station joined another AP than the last one.
+ * @return true if the association finished a roam.
+ */
+bool wifi_api_roam_associated(bool moved);
+
+/**
+ * @brief Handle a disconnection while roaming, or the supplicant leaving the
+ * current AP to roam by itself.
+ *
+ * @param[in] reason The disconnect reason.
+ * @return true if the disconnection is part of a roam, which reconnects by
+ * itself, so the retry policy must not run.
+ */
+bool wifi_api_roam_disconnected(uint8_t reason);
+
+/**
+ * @brief Keep the current DHCP address as a static one across a
+ * reassociation, or hand it back to DHCP.
+ *
+ * Nothing is held without an IPv4 address or in the static mode. A held
+ * address survives the disconnection from the old AP, and the interface
+ * posts `IP_EVENT_STA_GOT_IP` with it once associated with the new one.
+ *
+ * @param[in] hold true to keep the address, false to restart DHCP.
+ */
+void wifi_api_ip_hold(bool hold);
+
+/**
+ * @brief Apply the driver profile and the Kconfig overrides to a driver
+ * configuration, and estimate its buffer memory.
+ *
+ * @param[in,out] cfg The configuration, initialized with the SDK defaults.
+ */
+void wifi_api_driver_config(wifi_init_config_t *cfg);
+
+/**
+ * @brief Get the free internal RAM, sampled around the driver initialization.
+ *
+ * @return The free internal RAM in bytes.
+ */
+size_t wifi_api_driver_free_ram();
+
+/**
+ * @brief Record and log the memory cost of the driver initialization.
+ *
+ * @param[in] free_before Free internal RAM before `esp_wifi_init`.
+ */
+void wifi_api_driver_initialized(size_t free_before);
+
+/**
+ * @brief Select the profile of the next driver initialization.
+ *
+ * @param[in] profile The profile.
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG if the profile is invalid.
+ */
+esp_err_t wifi_api_driver_set_profile(wifi_api_driver_profile_t profile);
+
+/**
+ * @brief Count the packets of the station interface for the power governor.
+ *
+ * Called on every association, once the interface was added to lwIP by the
+ * default `WIFI_EVENT_STA_START` handler.
+ *
+ * @param[in] netif The station interface.
+ */
+void wifi_api_power_attach(esp_netif_t *netif);
+
+/**
+ * @brief Apply the power-save profile once the driver is started.
+ */
+void wifi_api_power_started();
+
+/**
+ * @brief Pause the power accounting and the governor once the driver is
+ * stopped.
+ */
+void wifi_api_power_stopped();
+
+/**
+ * @brief Get the listen interval of the max-modem profile.
+ *
+ * @return The listen interval in beacon intervals.
+ */
+uint8_t wifi_api_power_listen_interval();
+
+/**
+ * @brief Select the power-save profile, on the Wi-Fi manager task.
+ *
+ * @param[in] profile The profile.
+ * @param[in] listen_interval Listen interval of the max-modem profile, 0 to
+ * keep the current one.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE while the governor is
+ * enabled, an error code otherwise.
+ */
+esp_err_t wifi_api_power_set(wifi_api_power_profile_t profile,
+                             uint8_t listen_interval);
+
+/**
+ * @brief Change the power governor, on the Wi-Fi manager task.
+ *
+ * @param[in] config The governor configuration, NULL disables it.
+ * @return ESP_OK on success, an error code otherwise.
+ */
+esp_err_t wifi_api_power_governor(const wifi_api_power_governor_t *config);
+
+/**
+ * @brief Sample the traffic and let the governor select the profile, on the
+ * Wi-Fi manager task.
+ */
+void wifi_api_power_sample();
+
+/**
+ * @brief Restart the link statistics and the sampler on an association.
+ *
+ * @param[in] event The connected event data.
+ * @param[in] attempts Attempts it took to associate.
+ */
+void wifi_api_link_associated(const wifi_event_sta_connected_t *event,
+                              uint32_t attempts);
+
+/**
+ * @brief Stop the sampler once the station is no longer associated.
+ */
+void wifi_api_link_disconnected();
+
+/**
+ * @brief Count a beacon timeout of the current connection.
+ */
+void wifi_api_link_beacon_timeout();
+
+/**
+ * @brief Change the link quality sampler, on the Wi-Fi manager task.
+ *
+ * @param[in] config The sampler configuration, NULL disables it.
+ * @return ESP_OK on success, an error code otherwise.
+ */
+esp_err_t wifi_api_link_configure(const wifi_api_link_config_t *config);
+
+/**
+ * @brief Sample the RSSI and update the link statistics, on the Wi-Fi
+ * manager task.
+ */
+void wifi_api_link_sample();
+
+/**
+ * @brief Change the connectivity watchdog, on the Wi-Fi manager task.
+ *
+ * @param[in] config The watchdog configuration, NULL disables it.
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the probe task could not be
+ * created.
+ */
+esp_err_t wifi_api_watchdog_configure(const wifi_api_watchdog_config_t *config);
+
+/**
+ * @brief Handle the result of a watchdog probe, on the Wi-Fi manager task.
+ *
+ * @param[in] result Round trip in microseconds, `UINT32_MAX` if the probe
+ * failed.
+ * @param[out] action The recovery action to start.
+ * @return true if a recovery action must be started.
+ */
+bool wifi_api_watchdog_probed(uint32_t result,
+                              wifi_api_watchdog_action_t *action);
+
+/**
+ * @brief Extract the channels of the APs of an 802.11k neighbor report.
+ *
+ * @param[in] report The neighbor report elements.
+ * @param[in] length Length of `report` in bytes.
+ * @param[out] channels The distinct 2.4 GHz channels found.
+ * @param[in] max Capacity of `channels`.
+ * @return Number of channels stored.
+ */
+size_t wifi_api_roam_parse_neighbors(const uint8_t *report, size_t length,
+                                     uint8_t *channels, size_t max);
+
+/**
+ * @brief Handle a neighbor report, scans the neighbor channels if the
+ * roaming attempt requested it.
+ *
+ * @param[in] channels The neighbor channels.
+ * @param[in] channel_count Number of channels, 0 scans the configured ones.
+ */
+void wifi_api_roam_neighbors(const uint8_t *channels, size_t channel_count);
+
+/**
+ * @brief Record an event in the event trace, called by the event handlers.
+ *
+ * @param[in] event_base Base ID of the event.
+ * @param[in] event_id ID of the event.
+ * @param[in] event_data Event-specific data.
+ */
+void wifi_api_trace_record(esp_event_base_t event_base, int32_t event_id,
+                           const void *event_data);
+
+/**
+ * @brief Record the duration of a connection phase in its histogram.
+ *
+ * @param[in] phase The connection phase.
+ * @param[in] duration_us The duration in microseconds.
+ */
+void wifi_api_phase_record(wifi_api_phase_t phase, int64_t duration_us);
+
+#endif // WIFI_API_PRIV_H
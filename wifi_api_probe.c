@@ -0,0 +1,86 @@
+/**
+ * @file wifi_api_probe.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief TCP reachability probe of the connectivity watchdog
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_probe.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Get a monotonic time.
+ *
+ * @return The time in microseconds.
+ */
+static int64_t probe_now_us()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+esp_err_t wifi_api_probe_tcp(const char *host, uint16_t port,
+                             uint32_t timeout_ms, uint32_t *latency_us)
+{
+  struct sockaddr_in addr = {
+    .sin_family = AF_INET,
+    .sin_port = htons(port),
+  };
+  if (!host || inet_pton(AF_INET, host, &addr.sin_addr) != 1)
+    return ESP_ERR_INVALID_ARG;
+
+  int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (sock < 0)
+    return ESP_FAIL;
+
+  // Non-blocking, so the connection attempt is bounded by the timeout
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+  esp_err_t err = ESP_OK;
+  int64_t start = probe_now_us();
+  if (connect(sock, (const struct sockaddr *)&addr, sizeof(addr)) != 0)
+  {
+    if (errno != EINPROGRESS)
+      err = ESP_FAIL;
+    else
+    {
+      fd_set writable;
+      FD_ZERO(&writable);
+      FD_SET(sock, &writable);
+      struct timeval tv = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+      };
+
+      int error = 0;
+      socklen_t length = sizeof(error);
+      int ready = select(sock + 1, NULL, &writable, NULL, &tv);
+      if (ready == 0)
+        err = ESP_ERR_TIMEOUT;
+      else if (ready < 0 ||
+               getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &length) != 0 ||
+               error != 0)
+        err = ESP_FAIL;
+    }
+  }
+
+  if (err == ESP_OK && latency_us)
+    *latency_us = (uint32_t)(probe_now_us() - start);
+  close(sock);
+  return err;
+}
@@ -0,0 +1,318 @@
+/**
+ * @file wifi_api_profiles.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API credential profiles and access point selection
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_log.h>
+#include <esp_mac.h>
+#include <string.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_PROFILES";
+
+/**
+ * @brief RSSI credit in dB per security tier when ranking access points of
+ * the same priority.
+ */
+#define SECURITY_TIER_DB 3
+
+/**
+ * @brief Credential profiles.
+ */
+static wifi_api_profile_t s_profiles[CONFIG_WIFI_API_MAX_PROFILES] = {0};
+
+/**
+ * @brief Number of used entries in `s_profiles`.
+ */
+static size_t s_profile_count = 0;
+
+/**
+ * @brief Lock protecting the profile table.
+ */
+static portMUX_TYPE s_profiles_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Profiles skipped by the selection, one bit per `s_profiles` entry.
+ */
+static uint32_t s_excluded = 0;
+
+/**
+ * @brief Index in `s_profiles` of the profile in use, -1 if none.
+ */
+static int s_current = -1;
+
+/**
+ * @brief Best access point seen by the running selection scan.
+ */
+static struct
+{
+  int profile;              /**< Index in `s_profiles`, -1 if none. */
+  int score;                /**< Rank of the access point. */
+  uint8_t bssid[6];         /**< MAC address. */
+  uint8_t channel;          /**< Primary channel. */
+  wifi_auth_mode_t authmode; /**< Authentication mode. */
+} s_best = {.profile = -1};
+
+/**
+ * @brief Security tier of an authentication mode, higher is stronger.
+ *
+ * @param authmode The authentication mode.
+ * @return The tier, from 0 (open or WEP) to 3 (WPA3).
+ */
+static int security_tier(wifi_auth_mode_t authmode)
+{
+  switch (authmode)
+  {
+    case WIFI_AUTH_WPA3_PSK:
+    case WIFI_AUTH_WPA3_EXT_PSK:
+    case WIFI_AUTH_WPA3_ENT_192:
+      return 3;
+    case WIFI_AUTH_WPA2_PSK:
+    case WIFI_AUTH_WPA2_WPA3_PSK:
+    case WIFI_AUTH_WPA3_EXT_PSK_MIXED_MODE:
+    case WIFI_AUTH_ENTERPRISE:
+      return 2;
+    case WIFI_AUTH_WPA_PSK:
+    case WIFI_AUTH_WPA_WPA2_PSK:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Find a profile by SSID.
+ *
+ * @param ssid The SSID, not necessarily NUL-terminated.
+ * @param length Maximum length of `ssid`.
+ * @return The index in `s_profiles`, -1 if not found.
+ */
+static int profile_find(const uint8_t *ssid, size_t length)
+{
+  for (size_t i = 0; i < s_profile_count; i++)
+  {
+    if (strncmp(s_profiles[i].ssid, (const char *)ssid, length) == 0)
+      return (int)i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Weakest authentication mode accepted for a profile.
+ *
+ * @param profile The profile.
+ * @return The threshold set in the station configuration.
+ */
+static wifi_auth_mode_t profile_threshold(const wifi_api_profile_t *profile)
+{
+  return profile->password[0] ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+}
+
+/**
+ * @brief Fill the credentials of a profile into a station configuration.
+ *
+ * @param index Index in `s_profiles`.
+ * @param wc The station configuration.
+ */
+static void profile_apply(int index, wifi_config_t *wc)
+{
+  const wifi_api_profile_t *profile = &s_profiles[index];
+  strncpy((char *)wc->sta.ssid, profile->ssid, sizeof(wc->sta.ssid));
+  strncpy((char *)wc->sta.password, profile->password,
+          sizeof(wc->sta.password));
+  wc->sta.threshold.authmode = profile_threshold(profile);
+  s_current = index;
+}
+
+/**
+ * @brief Record callback of the selection scan, keeps the best candidate.
+ *
+ * Candidates are ranked by profile priority, then by RSSI with a credit of
+ * `SECURITY_TIER_DB` per security tier. An access point below the
+ * authentication threshold of its profile is never a candidate, since the
+ * driver would refuse it.
+ *
+ * @param record The scanned access point.
+ * @param arg User-defined argument (not used).
+ */
+static void profile_rank_record(const wifi_ap_record_t *record, void *arg)
+{
+  taskENTER_CRITICAL(&s_profiles_lock);
+  int index = profile_find(record->ssid, sizeof(record->ssid));
+  bool candidate = index >= 0 && !(s_excluded & (1UL << index)) &&
+                   record->authmode >= profile_threshold(&s_profiles[index]);
+  int priority = candidate ? s_profiles[index].priority : 0;
+  taskEXIT_CRITICAL(&s_profiles_lock);
+
+  if (!candidate)
+    return;
+
+  int score = priority * 1000 + record->rssi +
+              SECURITY_TIER_DB * security_tier(record->authmode);
+  if (s_best.profile >= 0 && score <= s_best.score)
+    return;
+
+  s_best.profile = index;
+  s_best.score = score;
+  memcpy(s_best.bssid, record->bssid, sizeof(s_best.bssid));
+  s_best.channel = record->primary;
+  s_best.authmode = record->authmode;
+}
+
+esp_err_t wifi_api_profile_scan(wifi_api_scan_done_cb_t done_cb)
+{
+  s_best.profile = -1;
+
+  // Start over once every profile was excluded
+  taskENTER_CRITICAL(&s_profiles_lock);
+  uint32_t all = (1UL << s_profile_count) - 1;
+  if ((s_excluded & all) == all)
+    s_excluded = 0;
+  taskEXIT_CRITICAL(&s_profiles_lock);
+
+  wifi_api_scan_config_t config = WIFI_API_SCAN_CONFIG_DEFAULT();
+  return wifi_api_scan_execute_start(&config, &profile_rank_record, done_cb,
+                                     NULL);
+}
+
+bool wifi_api_profile_best(wifi_config_t *wc)
+{
+  if (s_best.profile < 0)
+    return false;
+
+  taskENTER_CRITICAL(&s_profiles_lock);
+  bool valid = (size_t)s_best.profile < s_profile_count;
+  if (valid)
+    profile_apply(s_best.profile, wc);
+  taskEXIT_CRITICAL(&s_profiles_lock);
+  if (!valid)
+    return false;
+
+  wc->sta.bssid_set = true;
+  memcpy(wc->sta.bssid, s_best.bssid, sizeof(wc->sta.bssid));
+  wc->sta.channel = s_best.channel;
+  if (s_best.authmode > wc->sta.threshold.authmode)
+    wc->sta.threshold.authmode = s_best.authmode;
+
+  ESP_LOGI(TAG, "Selected %s on " MACSTR " channel %u", wc->sta.ssid,
+           MAC2STR(s_best.bssid), s_best.channel);
+  return true;
+}
+
+bool wifi_api_profile_lookup(const char *ssid, wifi_config_t *wc)
+{
+  taskENTER_CRITICAL(&s_profiles_lock);
+  int index = profile_find((const uint8_t *)ssid, sizeof(wc->sta.ssid));
+  if (index >= 0)
+    profile_apply(index, wc);
+  taskEXIT_CRITICAL(&s_profiles_lock);
+
+  return index >= 0;
+}
+
+bool wifi_api_profile_is_top(const char *ssid)
+{
+  taskENTER_CRITICAL(&s_profiles_lock);
+  int index = profile_find((const uint8_t *)ssid, sizeof(s_profiles[0].ssid));
+  bool top = index >= 0;
+  for (size_t i = 0; top && i < s_profile_count; i++)
+    top = s_profiles[i].priority <= s_profiles[index].priority;
+  taskEXIT_CRITICAL(&s_profiles_lock);
+
+  return top;
+}
+
+void wifi_api_profile_exclude_current()
+{
+  if (s_current < 0)
+    return;
+
+  taskENTER_CRITICAL(&s_profiles_lock);
+  s_excluded |= 1UL << s_current;
+  taskEXIT_CRITICAL(&s_profiles_lock);
+  ESP_LOGI(TAG, "Switching away from profile %s", s_profiles[s_current].ssid);
+}
+
+void wifi_api_profile_reset_exclusions()
+{
+  taskENTER_CRITICAL(&s_profiles_lock);
+  s_excluded = 0;
+  taskEXIT_CRITICAL(&s_profiles_lock);
+}
+
+esp_err_t wifi_api_add_profile(const wifi_api_profile_t *profile)
+{
+  if (!profile || profile->ssid[0] == '\0' ||
+      strnlen(profile->ssid, sizeof(profile->ssid)) >= sizeof(profile->ssid) ||
+      strnlen(profile->password, sizeof(profile->password)) >=
+        sizeof(profile->password))
+    return ESP_ERR_INVALID_ARG;
+
+  esp_err_t err = ESP_OK;
+  taskENTER_CRITICAL(&s_profiles_lock);
+  int index = profile_find((const uint8_t *)profile->ssid,
+                           sizeof(profile->ssid));
+  if (index >= 0)
+    s_profiles[index] = *profile;
+  else if (s_profile_count < CONFIG_WIFI_API_MAX_PROFILES)
+    s_profiles[s_profile_count++] = *profile;
+  else
+    err = ESP_ERR_NO_MEM;
+  taskEXIT_CRITICAL(&s_profiles_lock);
+
+  return err;
+}
+
+esp_err_t wifi_api_profile_execute_remove(const char *ssid)
+{
+  esp_err_t err = ESP_ERR_NOT_FOUND;
+  taskENTER_CRITICAL(&s_profiles_lock);
+  int index = profile_find((const uint8_t *)ssid, sizeof(s_profiles[0].ssid));
+  if (index >= 0)
+  {
+    // Keep the table packed, the exclusions and the selection are reset
+    memmove(&s_profiles[index], &s_profiles[index + 1],
+            (s_profile_count - index - 1) * sizeof(s_profiles[0]));
+    s_profile_count--;
+    s_excluded = 0;
+    s_best.profile = -1;
+    s_current = -1;
+    err = ESP_OK;
+  }
+  taskEXIT_CRITICAL(&s_profiles_lock);
+
+  return err;
+}
+
+esp_err_t wifi_api_remove_profile(const char *ssid)
+{
+  if (!ssid)
+    return ESP_ERR_INVALID_ARG;
+
+  // The selection state it resets is used by the manager task
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_REMOVE_PROFILE};
+  if (strnlen(ssid, sizeof(cmd.ssid)) >= sizeof(cmd.ssid))
+    return ESP_ERR_NOT_FOUND;
+  strcpy(cmd.ssid, ssid);
+  return wifi_api_task_call(&cmd);
+}
+
+size_t wifi_api_get_profile_count()
+{
+  taskENTER_CRITICAL(&s_profiles_lock);
+  size_t count = s_profile_count;
+  taskEXIT_CRITICAL(&s_profiles_lock);
+  return count;
+}
@@ -0,0 +1,380 @@
+/**
+ * @file wifi_api_roam.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API roaming between access points of the same network
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_log.h>
+#include <esp_mac.h>
+#include <esp_timer.h>
+#include <string.h>
+
+#if CONFIG_WIFI_API_11K
+#include <esp_rrm.h>
+#endif
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_ROAM";
+
+/**
+ * @brief Element ID of an 802.11k neighbor report.
+ */
+#define NEIGHBOR_REPORT_EID 52
+
+/**
+ * @brief Offset of the channel in a neighbor report element: ID, length,
+ * BSSID, BSSID information and operating class.
+ */
+#define NEIGHBOR_REPORT_CHANNEL 13
+
+/**
+ * @brief Time after which an unanswered roaming attempt is abandoned.
+ */
+#define ROAM_TIMEOUT_US (5 * 1000 * 1000LL)
+
+/**
+ * @brief Whether roaming is enabled.
+ */
+static bool s_roam_enabled = false;
+
+/**
+ * @brief Roaming configuration, `channels` points to `s_roam_channels`.
+ */
+static wifi_api_roam_config_t s_roam_config = {0};
+
+/**
+ * @brief Channels scanned for roaming candidates.
+ */
+static uint8_t s_roam_channels[WIFI_API_SCAN_MAX_CHANNELS] = {0};
+
+/**
+ * @brief Whether a roaming scan or reassociation of ours is in progress.
+ */
+static bool s_roaming = false;
+
+/**
+ * @brief Timer abandoning a roaming attempt that is not answered in time.
+ */
+static esp_timer_handle_t s_roam_timer = NULL;
+
+/**
+ * @brief Whether the roaming attempt waits for a neighbor report.
+ */
+static bool s_neighbor_pending = false;
+
+/**
+ * @brief Time of the roam decision, 0 when not reassociating.
+ */
+static int64_t s_roam_us = 0;
+
+/**
+ * @brief Time the supplicant left the current AP to roam by itself, after a
+ * BSS transition request or a fast transition, 0 when not roaming.
+ */
+static int64_t s_supplicant_us = 0;
+
+/**
+ * @brief Time the last roam finished, for the minimum interval.
+ */
+static int64_t s_roam_end_us = 0;
+
+/**
+ * @brief Access point the station is leaving.
+ */
+static wifi_ap_record_t s_roam_current = {0};
+
+/**
+ * @brief Best candidate of the roaming scan.
+ */
+static struct
+{
+  bool found;       /**< Whether a candidate was found. */
+  int8_t rssi;      /**< RSSI of the candidate. */
+  uint8_t bssid[6]; /**< MAC address of the candidate. */
+  uint8_t channel;  /**< Primary channel of the candidate. */
+} s_candidate = {0};
+
+/**
+ * @brief Finish the roaming attempt.
+ */
+static void roam_end()
+{
+  s_roaming = false;
+  s_neighbor_pending = false;
+  s_roam_us = 0;
+  s_supplicant_us = 0;
+  s_roam_end_us = esp_timer_get_time();
+  if (s_roam_timer)
+    esp_timer_stop(s_roam_timer);
+  wifi_api_state_clear(WIFI_API_STATE_ROAMING);
+}
+
+/**
+ * @brief Roaming deadline timer callback.
+ *
+ * @param arg User-defined argument (not used).
+ */
+static void roam_timer_expired(void *arg)
+{
+  // Never blocks the timer task, the timeout is latched on a full queue
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_ROAM_TIMEOUT};
+  wifi_api_task_post_latched(&cmd, 0);
+}
+
+/**
+ * @brief Record callback of the roaming scan, keeps the strongest access
+ * point of the current network that beats the current one by the gain.
+ *
+ * @param record The scanned access point.
+ * @param arg User-defined argument (not used).
+ */
+static void roam_rank_record(const wifi_ap_record_t *record, void *arg)
+{
+  if (memcmp(record->ssid, s_roam_current.ssid, sizeof(record->ssid)) != 0 ||
+      memcmp(record->bssid, s_roam_current.bssid, sizeof(record->bssid)) == 0)
+    return;
+  if (record->rssi < s_roam_current.rssi + s_roam_config.min_gain_db)
+    return;
+  if (s_candidate.found && record->rssi <= s_candidate.rssi)
+    return;
+
+  s_candidate.found = true;
+  s_candidate.rssi = record->rssi;
+  memcpy(s_candidate.bssid, record->bssid, sizeof(s_candidate.bssid));
+  s_candidate.channel = record->primary;
+}
+
+/**
+ * @brief Completion callback of the roaming scan, reassociates with the
+ * candidate.
+ *
+ * @param ap_count Number of scanned access points.
+ * @param status Scan status.
+ * @param arg User-defined argument (not used).
+ */
+static void roam_scan_done(uint16_t ap_count, esp_err_t status, void *arg)
+{
+  // The attempt may have timed out during the scan
+  if (!s_roaming)
+    return;
+
+  // The station may have been disconnected during the scan
+  wifi_config_t wc;
+  if (status != ESP_OK || !s_candidate.found ||
+      !(wifi_api_get_state() & WIFI_API_STATE_ASSOCIATED) ||
+      esp_wifi_get_config(WIFI_IF_STA, &wc) != ESP_OK)
+  {
+    ESP_LOGI(TAG, "No better AP among %u", ap_count);
+    roam_end();
+    return;
+  }
+
+  ESP_LOGI(TAG, "Roaming from " MACSTR " (%d dBm) to " MACSTR " (%d dBm)",
+           MAC2STR(s_roam_current.bssid), s_roam_current.rssi,
+           MAC2STR(s_candidate.bssid), s_candidate.rssi);
+
+  // The driver leaves the current AP before joining the candidate, the
+  // address is kept meanwhile and renewed through DHCP once associated
+  wc.sta.bssid_set = true;
+  memcpy(wc.sta.bssid, s_candidate.bssid, sizeof(wc.sta.bssid));
+  wc.sta.channel = s_candidate.channel;
+  s_roam_us = esp_timer_get_time();
+  if (esp_wifi_set_config(WIFI_IF_STA, &wc) != ESP_OK)
+  {
+    ESP_LOGW(TAG, "Failed to start the reassociation");
+    roam_end();
+    return;
+  }
+  wifi_api_ip_hold(true);
+  if (esp_wifi_connect() != ESP_OK)
+  {
+    ESP_LOGW(TAG, "Failed to start the reassociation");
+    wifi_api_ip_hold(false);
+    roam_end();
+  }
+}
+
+esp_err_t wifi_api_roam_configure(const wifi_api_roam_config_t *config)
+{
+  if (s_roaming)
+    return ESP_ERR_INVALID_STATE;
+
+  s_roam_enabled = config != NULL;
+  if (!config)
+    return ESP_OK;
+
+  if (!s_roam_timer)
+  {
+    const esp_timer_create_args_t timer_args = {
+      .callback = &roam_timer_expired, .name = "wifi_roam"};
+    esp_err_t err = esp_timer_create(&timer_args, &s_roam_timer);
+    if (err != ESP_OK)
+      return err;
+  }
+
+  s_roam_config = *config;
+  s_roam_config.channels = s_roam_channels;
+  if (config->channel_count > 0)
+    memcpy(s_roam_channels, config->channels, config->channel_count);
+  return ESP_OK;
+}
+
+int8_t wifi_api_roam_threshold()
+{
+  return s_roam_enabled ? s_roam_config.rssi_threshold : 0;
+}
+
+/**
+ * @brief Start the roaming scan.
+ *
+ * @param channels The channels to scan, NULL for all channels.
+ * @param channel_count Number of channels.
+ */
+static void roam_scan(const uint8_t *channels, size_t channel_count)
+{
+  wifi_api_scan_config_t config = WIFI_API_SCAN_CONFIG_DEFAULT();
+  config.channels = channels;
+  config.channel_count = channel_count;
+  s_candidate.found = false;
+  s_neighbor_pending = false;
+
+  esp_err_t err =
+    wifi_api_scan_execute_start(&config, &roam_rank_record, &roam_scan_done,
+                                NULL);
+  if (err != ESP_OK)
+  {
+    ESP_LOGW(TAG, "Failed to start the roaming scan: %s",
+             esp_err_to_name(err));
+    roam_end();
+  }
+}
+
+void wifi_api_roam_rssi_low(int8_t rssi)
+{
+  if (!s_roam_enabled || s_roaming || rssi > s_roam_config.rssi_threshold)
+    return;
+
+  int64_t now = esp_timer_get_time();
+  if (s_roam_end_us != 0 &&
+      now - s_roam_end_us < s_roam_config.min_interval_ms * 1000LL)
+    return;
+  if (esp_wifi_sta_get_ap_info(&s_roam_current) != ESP_OK)
+    return;
+
+  s_roaming = true;
+  wifi_api_state_set(WIFI_API_STATE_ROAMING);
+
+  // A neighbor report, a scan or a reassociation may never be answered
+  esp_timer_start_once(s_roam_timer, ROAM_TIMEOUT_US);
+
+#if CONFIG_WIFI_API_11K
+  // The AP lists its neighbors, only their channels are scanned
+  if (esp_rrm_is_rrm_supported_connection() &&
+      esp_rrm_send_neighbor_report_request() == 0)
+  {
+    s_neighbor_pending = true;
+    return;
+  }
+#endif
+
+  roam_scan(s_roam_config.channels, s_roam_config.channel_count);
+}
+
+size_t wifi_api_roam_parse_neighbors(const uint8_t *report, size_t length,
+                                     uint8_t *channels, size_t max)
+{
+  size_t count = 0;
+  while (length >= 2 && (size_t)report[1] + 2 <= length)
+  {
+    size_t element = (size_t)report[1] + 2;
+    if (report[0] == NEIGHBOR_REPORT_EID && element > NEIGHBOR_REPORT_CHANNEL)
+    {
+      uint8_t channel = report[NEIGHBOR_REPORT_CHANNEL];
+      bool known = channel == 0 || channel > WIFI_API_SCAN_MAX_CHANNELS;
+      for (size_t i = 0; i < count && !known; i++)
+        known = channels[i] == channel;
+      if (!known && count < max)
+        channels[count++] = channel;
+    }
+    report += element;
+    length -= element;
+  }
+  return count;
+}
+
+void wifi_api_roam_neighbors(const uint8_t *channels, size_t channel_count)
+{
+  if (!s_neighbor_pending)
+    return;
+
+  ESP_LOGI(TAG, "Neighbor report with %u channels", (unsigned)channel_count);
+  if (channel_count > 0)
+    roam_scan(channels, channel_count);
+  else
+    roam_scan(s_roam_config.channels, s_roam_config.channel_count);
+}
+
+void wifi_api_roam_timeout()
+{
+  if (!s_roaming)
+    return;
+
+  ESP_LOGW(TAG, "Roaming attempt timed out");
+  roam_end();
+}
+
+bool wifi_api_roam_associated(bool moved)
+{
+  int64_t start = s_roam_us != 0 ? s_roam_us : s_supplicant_us;
+  if (start == 0)
+    return false;
+
+  // The supplicant may have rejoined the AP it left, which is not a roam
+  bool roamed = s_roam_us != 0 || moved;
+  if (roamed)
+    wifi_api_phase_record(WIFI_API_PHASE_ROAM, esp_timer_get_time() - start);
+  roam_end();
+  return roamed;
+}
+
+bool wifi_api_roam_disconnected(uint8_t reason)
+{
+  // The supplicant leaves the current AP by itself to follow a BSS transition
+  // request or a fast transition, and joins the target without us
+  if (s_roam_us == 0 && reason == WIFI_REASON_ROAMING)
+  {
+    ESP_LOGI(TAG, "Roaming initiated by the supplicant");
+    // Our own attempt, still scanning, is abandoned
+    s_roaming = false;
+    s_neighbor_pending = false;
+    if (s_roam_timer)
+      esp_timer_stop(s_roam_timer);
+    s_supplicant_us = esp_timer_get_time();
+    wifi_api_state_set(WIFI_API_STATE_ROAMING);
+    // Still reported as obtained, the address is kept as for our roams
+    wifi_api_ip_hold(true);
+    return true;
+  }
+
+  if (s_roam_us == 0 && s_supplicant_us == 0)
+    return false;
+
+  // The station leaving the current AP is part of our roam
+  if (s_roam_us != 0 && reason == WIFI_REASON_ASSOC_LEAVE)
+    return true;
+
+  ESP_LOGW(TAG, "Roaming failed (reason %u)", reason);
+  roam_end();
+  return false;
+}
@@ -0,0 +1,671 @@
+/**
+ * @file wifi_api_scan.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API non-blocking scan implementation
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api.h"
+#include "wifi_api_priv.h"
+
+#include <esp_event.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_SCAN";
+
+/**
+ * @brief Event handler instance for the scan done event.
+ */
+static esp_event_handler_instance_t instance_scan_done = NULL;
+
+/**
+ * @brief Whether a scan started by `wifi_api_scan_start` is running.
+ */
+static bool s_scan_running = false;
+
+/**
+ * @brief Driver scan configuration of the running scan.
+ */
+static wifi_scan_config_t s_scan_config = {0};
+
+/**
+ * @brief Channels of the running scan, scanned one at a time.
+ */
+static uint8_t s_scan_channels[WIFI_API_SCAN_MAX_CHANNELS] = {0};
+
+/**
+ * @brief Number of channels in `s_scan_channels`, 0 scans all channels at
+ * once.
+ */
+static size_t s_scan_channel_count = 0;
+
+/**
+ * @brief Index in `s_scan_channels` of the channel being scanned.
+ */
+static size_t s_scan_channel_index = 0;
+
+/**
+ * @brief Number of records reported by the running scan.
+ */
+static uint16_t s_scan_ap_count = 0;
+
+/**
+ * @brief Record pool allocated once by `wifi_api_scan_pool_init`.
+ */
+static wifi_ap_record_t *s_scan_pool = NULL;
+
+/**
+ * @brief Capacity of `s_scan_pool` in records.
+ */
+static uint16_t s_scan_pool_size = 0;
+
+/**
+ * @brief Buffer storing the records of the running or last scan, either the
+ * caller buffer or `s_scan_pool`.
+ */
+static wifi_ap_record_t *s_scan_records = NULL;
+
+/**
+ * @brief Capacity of `s_scan_records` in records.
+ */
+static uint16_t s_scan_records_size = 0;
+
+/**
+ * @brief Number of records stored in `s_scan_records`.
+ */
+static uint16_t s_scan_records_count = 0;
+
+/**
+ * @brief Scan cache entries allocated once by `wifi_api_scan_cache_init`.
+ */
+static wifi_api_scan_entry_t *s_cache = NULL;
+
+/**
+ * @brief Capacity of `s_cache` in entries.
+ */
+static uint16_t s_cache_size = 0;
+
+/**
+ * @brief Number of used entries in `s_cache`.
+ */
+static uint16_t s_cache_count = 0;
+
+/**
+ * @brief Age in microseconds after which cached data is stale.
+ */
+static int64_t s_cache_ttl_us = 0;
+
+/**
+ * @brief Time of the last scan of each channel, indexed by channel number.
+ */
+static int64_t s_channel_scanned_us[WIFI_API_SCAN_MAX_CHANNELS + 1] = {0};
+
+/**
+ * @brief Mutex protecting the scan cache.
+ */
+static SemaphoreHandle_t s_cache_lock = NULL;
+
+/**
+ * @brief Entry callback of the cache query waiting for a scan.
+ */
+static wifi_api_scan_entry_cb_t s_query_entry_cb = NULL;
+
+/**
+ * @brief Completion callback of the cache query waiting for a scan.
+ */
+static wifi_api_scan_done_cb_t s_query_done_cb = NULL;
+
+/**
+ * @brief User argument of the cache query waiting for a scan.
+ */
+static void *s_query_arg = NULL;
+
+/**
+ * @brief Channels of the cache query waiting for a scan.
+ */
+static uint8_t s_query_channels[WIFI_API_SCAN_MAX_CHANNELS] = {0};
+
+/**
+ * @brief Number of channels in `s_query_channels`, 0 for all channels.
+ */
+static size_t s_query_channel_count = 0;
+
+/**
+ * @brief Whether a cache query waits for its scan.
+ */
+static bool s_query_pending = false;
+
+/**
+ * @brief Per-record callback of the running scan.
+ */
+static wifi_api_scan_record_cb_t s_scan_record_cb = NULL;
+
+/**
+ * @brief Completion callback of the running scan.
+ */
+static wifi_api_scan_done_cb_t s_scan_done_cb = NULL;
+
+/**
+ * @brief User argument passed to the scan callbacks.
+ */
+static void *s_scan_cb_arg = NULL;
+
+/**
+ * @brief Insert or refresh an access point in the scan cache.
+ *
+ * When the cache is full the entry seen least recently is replaced.
+ *
+ * @param record The scanned access point.
+ * @param now Time of the scan in microseconds.
+ */
+static void cache_update(const wifi_ap_record_t *record, int64_t now)
+{
+  wifi_api_scan_entry_t *entry = NULL;
+  wifi_api_scan_entry_t *oldest = &s_cache[0];
+  for (uint16_t i = 0; i < s_cache_count; i++)
+  {
+    if (memcmp(s_cache[i].bssid, record->bssid, sizeof(record->bssid)) == 0)
+    {
+      entry = &s_cache[i];
+      break;
+    }
+    if (s_cache[i].last_seen_us < oldest->last_seen_us)
+      oldest = &s_cache[i];
+  }
+  if (!entry)
+    entry = s_cache_count < s_cache_size ? &s_cache[s_cache_count++] : oldest;
+
+  memcpy(entry->bssid, record->bssid, sizeof(entry->bssid));
+  memcpy(entry->ssid, record->ssid, sizeof(entry->ssid));
+  entry->rssi = record->rssi;
+  entry->channel = record->primary;
+  entry->authmode = record->authmode;
+  entry->last_seen_us = now;
+}
+
+/**
+ * @brief Record the scan of a channel, or of every channel if it is 0.
+ *
+ * @param channel The scanned channel.
+ * @param now Time of the scan in microseconds.
+ */
+static void cache_mark_scanned(uint8_t channel, int64_t now)
+{
+  if (channel > WIFI_API_SCAN_MAX_CHANNELS)
+    return;
+  if (channel != 0)
+  {
+    s_channel_scanned_us[channel] = now;
+    return;
+  }
+  for (size_t i = 1; i <= WIFI_API_SCAN_MAX_CHANNELS; i++)
+    s_channel_scanned_us[i] = now;
+}
+
+/**
+ * @brief Whether a channel was scanned within the cache TTL.
+ *
+ * @param channel The channel.
+ * @param now Current time in microseconds.
+ * @return true if the cached data of the channel is fresh.
+ */
+static bool cache_channel_fresh(uint8_t channel, int64_t now)
+{
+  return channel <= WIFI_API_SCAN_MAX_CHANNELS &&
+         s_channel_scanned_us[channel] != 0 &&
+         now - s_channel_scanned_us[channel] <= s_cache_ttl_us;
+}
+
+/**
+ * @brief Report the fresh cache entries of a channel set.
+ *
+ * @param channels The channels, NULL for all channels.
+ * @param channel_count Number of channels.
+ * @param entry_cb Callback for each entry, may be NULL.
+ * @param done_cb Completion callback, may be NULL.
+ * @param arg User argument passed to the callbacks.
+ */
+static void cache_report(const uint8_t *channels, size_t channel_count,
+                         wifi_api_scan_entry_cb_t entry_cb,
+                         wifi_api_scan_done_cb_t done_cb, void *arg)
+{
+  int64_t now = esp_timer_get_time();
+  uint16_t count = 0;
+
+  xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+  for (uint16_t i = 0; i < s_cache_count; i++)
+  {
+    const wifi_api_scan_entry_t *entry = &s_cache[i];
+    if (now - entry->last_seen_us > s_cache_ttl_us)
+      continue;
+
+    bool match = channel_count == 0;
+    for (size_t c = 0; c < channel_count && !match; c++)
+      match = channels[c] == entry->channel;
+    if (!match)
+      continue;
+
+    count++;
+    if (entry_cb)
+      entry_cb(entry, arg);
+  }
+  xSemaphoreGive(s_cache_lock);
+
+  if (done_cb)
+    done_cb(count, ESP_OK, arg);
+}
+
+/**
+ * @brief Completion callback of the scan started by a cache query.
+ *
+ * @param ap_count Number of scanned access points.
+ * @param status Scan status.
+ * @param arg User-defined argument (not used).
+ */
+static void cache_query_done(uint16_t ap_count, esp_err_t status, void *arg)
+{
+  s_query_pending = false;
+  if (status != ESP_OK)
+  {
+    if (s_query_done_cb)
+      s_query_done_cb(0, status, s_query_arg);
+    return;
+  }
+  cache_report(s_query_channels, s_query_channel_count, s_query_entry_cb,
+               s_query_done_cb, s_query_arg);
+}
+
+/**
+ * @brief Finish the running scan and report its completion.
+ *
+ * @param status ESP_OK if every channel was scanned, an error code otherwise.
+ */
+static void scan_finish(esp_err_t status)
+{
+  s_scan_running = false;
+  wifi_api_state_clear(WIFI_API_STATE_SCANNING);
+  if (s_scan_done_cb)
+    s_scan_done_cb(s_scan_ap_count, status, s_scan_cb_arg);
+
+  wifi_api_event_data_t data = {.event = WIFI_API_EVENT_SCAN_DONE};
+  data.scan_done.ap_count = s_scan_ap_count;
+  data.scan_done.status = status;
+  wifi_api_event_publish(&data);
+}
+
+/**
+ * @brief Start the driver scan of the next channel of the channel set.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t scan_start_channel()
+{
+  if (s_scan_channel_count > 0)
+    s_scan_config.channel = s_scan_channels[s_scan_channel_index];
+
+  return esp_wifi_scan_start(&s_scan_config, false);
+}
+
+/**
+ * @brief Event handler for the scan done event.
+ *
+ * Forwards the event to the Wi-Fi manager task. The event is latched when
+ * the queue is full, a lost one would leave the scan running forever.
+ *
+ * @param arg User-defined argument (not used).
+ * @param event_base Base ID of the event.
+ * @param event_id ID of the event.
+ * @param event_data Event-specific data.
+ */
+static void scan_done_handler(void *arg, esp_event_base_t event_base,
+                              int32_t event_id, void *event_data)
+{
+  wifi_api_trace_record(event_base, event_id, event_data);
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_EVENT};
+  cmd.event.base = event_base;
+  cmd.event.id = event_id;
+  memcpy(&cmd.event.data.scan_done, event_data,
+         sizeof(cmd.event.data.scan_done));
+  wifi_api_task_post_latched(&cmd, pdMS_TO_TICKS(100));
+}
+
+esp_err_t wifi_api_scan_attach()
+{
+  if (instance_scan_done)
+    return ESP_OK;
+
+  return esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE,
+                                             &scan_done_handler, NULL,
+                                             &instance_scan_done);
+}
+
+void wifi_api_scan_handle_done(const wifi_event_sta_scan_done_t *event)
+{
+  if (!s_scan_running)
+    return;
+
+  if (event->status != 0)
+  {
+    esp_wifi_clear_ap_list();
+    scan_finish(ESP_FAIL);
+    return;
+  }
+
+  int64_t now = esp_timer_get_time();
+  if (s_cache)
+  {
+    xSemaphoreTake(s_cache_lock, portMAX_DELAY);
+    cache_mark_scanned(s_scan_config.channel, now);
+  }
+
+  wifi_ap_record_t record;
+  while (esp_wifi_scan_get_ap_record(&record) == ESP_OK)
+  {
+    if (s_cache)
+      cache_update(&record, now);
+    s_scan_ap_count++;
+    if (s_scan_records_count < s_scan_records_size)
+      s_scan_records[s_scan_records_count++] = record;
+    if (s_scan_record_cb)
+      s_scan_record_cb(&record, s_scan_cb_arg);
+  }
+
+  if (s_cache)
+    xSemaphoreGive(s_cache_lock);
+
+  if (++s_scan_channel_index >= s_scan_channel_count)
+  {
+    scan_finish(ESP_OK);
+    return;
+  }
+
+  esp_err_t err = scan_start_channel();
+  if (err != ESP_OK)
+    scan_finish(err);
+}
+
+esp_err_t wifi_api_scan_execute_start(const wifi_api_scan_config_t *config,
+                                      wifi_api_scan_record_cb_t record_cb,
+                                      wifi_api_scan_done_cb_t done_cb,
+                                      void *arg)
+{
+  if (s_scan_running)
+    return ESP_ERR_INVALID_STATE;
+
+  // Also reached by the profile and roaming scans, and by a driver that was
+  // initialized by the application
+  esp_err_t err = wifi_api_scan_attach();
+  if (err != ESP_OK)
+    return err;
+
+  memset(&s_scan_config, 0, sizeof(s_scan_config));
+  s_scan_config.show_hidden = config->show_hidden;
+  if (config->passive)
+  {
+    s_scan_config.scan_type = WIFI_SCAN_TYPE_PASSIVE;
+    s_scan_config.scan_time.passive = config->dwell_max_ms;
+  }
+  else
+  {
+    s_scan_config.scan_type = WIFI_SCAN_TYPE_ACTIVE;
+    s_scan_config.scan_time.active.min = config->dwell_min_ms;
+    s_scan_config.scan_time.active.max = config->dwell_max_ms;
+  }
+
+  if (config->channel_count > 0)
+    memcpy(s_scan_channels, config->channels,
+           config->channel_count * sizeof(s_scan_channels[0]));
+  s_scan_channel_count = config->channel_count;
+  s_scan_channel_index = 0;
+  s_scan_ap_count = 0;
+  s_scan_records = config->records ? config->records : s_scan_pool;
+  s_scan_records_size = config->records ? config->max_records
+                                        : s_scan_pool_size;
+  s_scan_records_count = 0;
+  s_scan_record_cb = record_cb;
+  s_scan_done_cb = done_cb;
+  s_scan_cb_arg = arg;
+
+  s_scan_running = true;
+  err = scan_start_channel();
+  if (err != ESP_OK)
+    s_scan_running = false;
+  else
+    wifi_api_state_set(WIFI_API_STATE_SCANNING);
+
+  return err;
+}
+
+esp_err_t wifi_api_scan_execute_stop()
+{
+  if (!s_scan_running)
+    return ESP_ERR_INVALID_STATE;
+
+  // A query waiting for the stopped scan is abandoned like its scan
+  s_scan_running = false;
+  s_query_pending = false;
+  wifi_api_state_clear(WIFI_API_STATE_SCANNING);
+  return esp_wifi_scan_stop();
+}
+
+esp_err_t wifi_api_scan_start(const wifi_api_scan_config_t *config,
+                              wifi_api_scan_record_cb_t record_cb,
+                              wifi_api_scan_done_cb_t done_cb, void *arg)
+{
+  if (!config || config->channel_count > WIFI_API_SCAN_MAX_CHANNELS ||
+      (config->channel_count > 0 && !config->channels) ||
+      (config->records && config->max_records == 0))
+    return ESP_ERR_INVALID_ARG;
+
+  // The channel set is copied, the caller may release it once queued
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SCAN_START};
+  cmd.scan.config = *config;
+  cmd.scan.config.channels = NULL;
+  if (config->channel_count > 0)
+    memcpy(cmd.scan.channels, config->channels, config->channel_count);
+  cmd.scan.record_cb = record_cb;
+  cmd.scan.done_cb = done_cb;
+  cmd.scan.arg = arg;
+  return wifi_api_task_post(&cmd, 0);
+}
+
+esp_err_t wifi_api_scan_pool_init(uint16_t capacity)
+{
+  if (capacity == 0)
+    return ESP_ERR_INVALID_ARG;
+  if (s_scan_pool)
+    return capacity == s_scan_pool_size ? ESP_OK : ESP_ERR_INVALID_STATE;
+
+  s_scan_pool = calloc(capacity, sizeof(wifi_ap_record_t));
+  if (!s_scan_pool)
+    return ESP_ERR_NO_MEM;
+
+  s_scan_pool_size = capacity;
+  return ESP_OK;
+}
+
+esp_err_t wifi_api_scan_execute_results(const wifi_ap_record_t **records,
+                                        uint16_t *count)
+{
+  if (s_scan_running)
+    return ESP_ERR_INVALID_STATE;
+
+  *records = s_scan_records;
+  *count = s_scan_records_count;
+
+  return s_scan_records_count < s_scan_ap_count ? ESP_ERR_INVALID_SIZE
+                                                 : ESP_OK;
+}
+
+esp_err_t wifi_api_scan_cache_init(uint16_t capacity, uint32_t ttl_ms)
+{
+  if (capacity == 0 || ttl_ms == 0)
+    return ESP_ERR_INVALID_ARG;
+  if (s_cache)
+    return ESP_ERR_INVALID_STATE;
+
+  s_cache_lock = xSemaphoreCreateMutex();
+  s_cache = calloc(capacity, sizeof(wifi_api_scan_entry_t));
+  if (!s_cache_lock || !s_cache)
+  {
+    if (s_cache_lock)
+      vSemaphoreDelete(s_cache_lock);
+    free(s_cache);
+    s_cache_lock = NULL;
+    s_cache = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  s_cache_size = capacity;
+  s_cache_ttl_us = ttl_ms * 1000LL;
+  return ESP_OK;
+}
+
+esp_err_t wifi_api_scan_execute_cached(const wifi_api_scan_config_t *config,
+                                       wifi_api_scan_entry_cb_t entry_cb,
+                                       wifi_api_scan_done_cb_t done_cb,
+                                       void *arg)
+{
+  if (s_query_pending)
+    return ESP_ERR_INVALID_STATE;
+
+  // Scan only the channels whose cached data is stale
+  int64_t now = esp_timer_get_time();
+  uint8_t stale[WIFI_API_SCAN_MAX_CHANNELS];
+  size_t stale_count = 0;
+  bool full_scan = false;
+  if (config->channel_count == 0)
+  {
+    for (uint8_t channel = 1; channel <= WIFI_API_SCAN_MAX_CHANNELS; channel++)
+      full_scan |= !cache_channel_fresh(channel, now);
+  }
+  else
+  {
+    for (size_t i = 0; i < config->channel_count; i++)
+    {
+      if (!cache_channel_fresh(config->channels[i], now))
+        stale[stale_count++] = config->channels[i];
+    }
+  }
+
+  if (!full_scan && stale_count == 0)
+  {
+    cache_report(config->channels, config->channel_count, entry_cb, done_cb,
+                 arg);
+    return ESP_OK;
+  }
+
+  if (s_scan_running)
+    return ESP_ERR_INVALID_STATE;
+
+  if (config->channel_count > 0)
+    memcpy(s_query_channels, config->channels, config->channel_count);
+  s_query_channel_count = config->channel_count;
+  s_query_entry_cb = entry_cb;
+  s_query_done_cb = done_cb;
+  s_query_arg = arg;
+
+  wifi_api_scan_config_t scan_config = *config;
+  scan_config.channels = full_scan ? NULL : stale;
+  scan_config.channel_count = full_scan ? 0 : stale_count;
+  scan_config.records = NULL;
+  scan_config.max_records = 0;
+  esp_err_t err =
+    wifi_api_scan_execute_start(&scan_config, NULL, &cache_query_done, NULL);
+  s_query_pending = err == ESP_OK;
+  return err;
+}
+
+esp_err_t wifi_api_scan_cached(const wifi_api_scan_config_t *config,
+                               wifi_api_scan_entry_cb_t entry_cb,
+                               wifi_api_scan_done_cb_t done_cb, void *arg)
+{
+  if (!s_cache)
+    return ESP_ERR_INVALID_STATE;
+  if (!config || config->channel_count > WIFI_API_SCAN_MAX_CHANNELS ||
+      (config->channel_count > 0 && !config->channels))
+    return ESP_ERR_INVALID_ARG;
+
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SCAN_CACHED};
+  cmd.scan.config = *config;
+  cmd.scan.config.channels = NULL;
+  if (config->channel_count > 0)
+    memcpy(cmd.scan.channels, config->channels, config->channel_count);
+  cmd.scan.entry_cb = entry_cb;
+  cmd.scan.done_cb = done_cb;
+  cmd.scan.arg = arg;
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_scan_get_results(const wifi_ap_record_t **records,
+                                    uint16_t *count)
+{
+  if (!records || !count)
+    return ESP_ERR_INVALID_ARG;
+
+  // Read on the manager task, which fills the records as a scan completes
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SCAN_RESULTS};
+  cmd.scan_results.records = records;
+  cmd.scan_results.count = count;
+  return wifi_api_task_call(&cmd);
+}
+
+esp_err_t wifi_api_scan_stop()
+{
+  wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_SCAN_STOP};
+  return wifi_api_task_post(&cmd, 0);
+}
+
+/**
+ * @brief Record callback of `wifi_api_scan` that logs each access point.
+ *
+ * @param record The scanned access point.
+ * @param arg User-defined argument (not used).
+ */
+static void scan_log_record(const wifi_ap_record_t *record, void *arg)
+{
+  ESP_LOGI(TAG, "SSID \t\t%s", record->ssid);
+  ESP_LOGI(TAG, "RSSI \t\t%d", record->rssi);
+  ESP_LOGI(TAG, "Authmode \t%s", wifi_api_authmode_name(record->authmode));
+  ESP_LOGI(TAG, "Channel \t\t%d", record->primary);
+}
+
+/**
+ * @brief Done callback of `wifi_api_scan` that logs the number of APs.
+ *
+ * @param ap_count Number of scanned access points.
+ * @param status Scan status.
+ * @param arg User-defined argument (not used).
+ */
+static void scan_log_done(uint16_t ap_count, esp_err_t status, void *arg)
+{
+  ESP_LOGI(TAG, "Total APs scanned = %u (%s)", ap_count,
+           esp_err_to_name(status));
+}
+
+void wifi_api_scan()
+{
+  ESP_LOGI(TAG, "Starting Wi-Fi scan...");
+
+  wifi_api_scan_config_t config = WIFI_API_SCAN_CONFIG_DEFAULT();
+  esp_err_t err =
+    wifi_api_scan_start(&config, &scan_log_record, &scan_log_done, NULL);
+  if (err != ESP_OK)
+    ESP_LOGE(TAG, "Failed to start scan: %s", esp_err_to_name(err));
+}
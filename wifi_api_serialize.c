@@ -0,0 +1,378 @@
+/**
+ * @file wifi_api_serialize.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API scan result serialization to JSON and CBOR
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api.h"
+
+#include <esp_idf_version.h>
+#include <esp_mac.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Names of the authentication modes, indexed by `wifi_auth_mode_t`.
+ */
+static const char *const AUTHMODE_NAMES[] = {
+  [WIFI_AUTH_OPEN] = "OPEN",
+  [WIFI_AUTH_WEP] = "WEP",
+  [WIFI_AUTH_WPA_PSK] = "WPA_PSK",
+  [WIFI_AUTH_WPA2_PSK] = "WPA2_PSK",
+  [WIFI_AUTH_WPA_WPA2_PSK] = "WPA_WPA2_PSK",
+  [WIFI_AUTH_WPA2_ENTERPRISE] = "WPA2_ENTERPRISE",
+  [WIFI_AUTH_WPA3_PSK] = "WPA3_PSK",
+  [WIFI_AUTH_WPA2_WPA3_PSK] = "WPA2_WPA3_PSK",
+  [WIFI_AUTH_WAPI_PSK] = "WAPI_PSK",
+  [WIFI_AUTH_OWE] = "OWE",
+  [WIFI_AUTH_WPA3_ENT_192] = "WPA3_ENT_192",
+  [WIFI_AUTH_WPA3_EXT_PSK] = "WPA3_EXT_PSK",
+  [WIFI_AUTH_WPA3_EXT_PSK_MIXED_MODE] = "WPA3_EXT_PSK_MIXED_MODE",
+  [WIFI_AUTH_DPP] = "DPP",
+  [WIFI_AUTH_WPA3_ENTERPRISE] = "WPA3_ENTERPRISE",
+  [WIFI_AUTH_WPA2_WPA3_ENTERPRISE] = "WPA2_WPA3_ENTERPRISE",
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 4, 0)
+  [WIFI_AUTH_WPA_ENTERPRISE] = "WPA_ENTERPRISE",
+#endif
+};
+
+// A mode added by a newer IDF needs its name
+_Static_assert(sizeof(AUTHMODE_NAMES) / sizeof(AUTHMODE_NAMES[0]) ==
+                 WIFI_AUTH_MAX,
+               "AUTHMODE_NAMES does not cover wifi_auth_mode_t");
+
+/**
+ * @brief CBOR major types used by the encoder.
+ */
+typedef enum
+{
+  CBOR_UINT = 0,   /**< Unsigned integer. */
+  CBOR_NEGINT = 1, /**< Negative integer. */
+  CBOR_BYTES = 2,  /**< Byte string. */
+  CBOR_TEXT = 3,   /**< Text string. */
+  CBOR_ARRAY = 4,  /**< Array. */
+  CBOR_MAP = 5,    /**< Map. */
+} cbor_major_t;
+
+/**
+ * @brief Output buffer of the serializer.
+ *
+ * Writes past the end are dropped but still counted, so the required length
+ * is known when the buffer is too small.
+ */
+typedef struct
+{
+  uint8_t *buffer; /**< Caller buffer. */
+  size_t size;     /**< Capacity of `buffer`. */
+  size_t length;   /**< Bytes written, or required if larger than `size`. */
+} writer_t;
+
+const char *wifi_api_authmode_name(wifi_auth_mode_t authmode)
+{
+  if ((unsigned)authmode >= WIFI_AUTH_MAX || !AUTHMODE_NAMES[authmode])
+    return "UNKNOWN";
+  return AUTHMODE_NAMES[authmode];
+}
+
+/**
+ * @brief Append bytes to the output buffer.
+ *
+ * @param w The writer.
+ * @param data The bytes to append.
+ * @param length Number of bytes.
+ */
+static void put(writer_t *w, const void *data, size_t length)
+{
+  if (w->length + length <= w->size)
+    memcpy(w->buffer + w->length, data, length);
+  w->length += length;
+}
+
+/**
+ * @brief Append a single byte to the output buffer.
+ *
+ * @param w The writer.
+ * @param byte The byte to append.
+ */
+static void put_byte(writer_t *w, uint8_t byte)
+{
+  put(w, &byte, 1);
+}
+
+/**
+ * @brief Append a NUL-terminated string to the output buffer.
+ *
+ * @param w The writer.
+ * @param str The string to append.
+ */
+static void put_str(writer_t *w, const char *str)
+{
+  put(w, str, strlen(str));
+}
+
+/**
+ * @brief Get the length of the UTF-8 sequence starting a string.
+ *
+ * Overlong encodings, surrogates and code points above U+10FFFF are
+ * rejected.
+ *
+ * @param str The string bytes.
+ * @param length Number of bytes.
+ * @return The length of the sequence, 0 if it is not valid UTF-8.
+ */
+static size_t utf8_sequence(const uint8_t *str, size_t length)
+{
+  uint8_t c = str[0];
+  if (c < 0x80)
+    return 1;
+
+  size_t size;
+  uint8_t min = 0x80;
+  uint8_t max = 0xbf;
+  if (c >= 0xc2 && c <= 0xdf)
+    size = 2;
+  else if (c >= 0xe0 && c <= 0xef)
+  {
+    size = 3;
+    if (c == 0xe0)
+      min = 0xa0;
+    else if (c == 0xed)
+      max = 0x9f;
+  }
+  else if (c >= 0xf0 && c <= 0xf4)
+  {
+    size = 4;
+    if (c == 0xf0)
+      min = 0x90;
+    else if (c == 0xf4)
+      max = 0x8f;
+  }
+  else
+    return 0;
+
+  if (size > length || str[1] < min || str[1] > max)
+    return 0;
+  for (size_t i = 2; i < size; i++)
+  {
+    if ((str[i] & 0xc0) != 0x80)
+      return 0;
+  }
+  return size;
+}
+
+/**
+ * @brief Check whether a string is valid UTF-8.
+ *
+ * @param str The string bytes.
+ * @param length Number of bytes.
+ * @return true if every sequence is valid.
+ */
+static bool utf8_valid(const uint8_t *str, size_t length)
+{
+  for (size_t i = 0; i < length;)
+  {
+    size_t size = utf8_sequence(str + i, length - i);
+    if (size == 0)
+      return false;
+    i += size;
+  }
+  return true;
+}
+
+/**
+ * @brief Append a JSON string literal, escaping the special characters.
+ *
+ * SSIDs are arbitrary bytes, each byte that is not part of a valid UTF-8
+ * sequence is escaped as the code point of the same value.
+ *
+ * @param w The writer.
+ * @param str The string bytes.
+ * @param length Number of bytes.
+ */
+static void json_string(writer_t *w, const uint8_t *str, size_t length)
+{
+  put_byte(w, '"');
+  for (size_t i = 0; i < length;)
+  {
+    uint8_t c = str[i];
+    size_t size = utf8_sequence(str + i, length - i);
+    if (c == '"' || c == '\\')
+    {
+      put_byte(w, '\\');
+      put_byte(w, c);
+    }
+    else if (c < 0x20 || c == 0x7f || size == 0)
+    {
+      char escaped[7];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      put_str(w, escaped);
+    }
+    else
+    {
+      put(w, str + i, size);
+      i += size;
+      continue;
+    }
+    i++;
+  }
+  put_byte(w, '"');
+}
+
+/**
+ * @brief Append one access point as a JSON object.
+ *
+ * @param w The writer.
+ * @param record The access point record.
+ */
+static void json_record(writer_t *w, const wifi_ap_record_t *record)
+{
+  char field[48];
+
+  put_str(w, "{\"ssid\":");
+  json_string(w, record->ssid,
+              strnlen((const char *)record->ssid, sizeof(record->ssid)));
+  snprintf(field, sizeof(field), ",\"bssid\":\"" MACSTR "\"",
+           MAC2STR(record->bssid));
+  put_str(w, field);
+  snprintf(field, sizeof(field), ",\"rssi\":%d,\"channel\":%u,\"auth\":\"",
+           record->rssi, record->primary);
+  put_str(w, field);
+  put_str(w, wifi_api_authmode_name(record->authmode));
+  put_str(w, "\"}");
+}
+
+/**
+ * @brief Append a CBOR data item head.
+ *
+ * @param w The writer.
+ * @param major The major type.
+ * @param value The argument of the head.
+ */
+static void cbor_head(writer_t *w, cbor_major_t major, uint32_t value)
+{
+  uint8_t type = (uint8_t)(major << 5);
+  if (value < 24)
+    put_byte(w, type | value);
+  else if (value <= UINT8_MAX)
+  {
+    uint8_t head[] = {type | 24, (uint8_t)value};
+    put(w, head, sizeof(head));
+  }
+  else if (value <= UINT16_MAX)
+  {
+    uint8_t head[] = {type | 25, (uint8_t)(value >> 8), (uint8_t)value};
+    put(w, head, sizeof(head));
+  }
+  else
+  {
+    uint8_t head[] = {type | 26, (uint8_t)(value >> 24),
+                      (uint8_t)(value >> 16), (uint8_t)(value >> 8),
+                      (uint8_t)value};
+    put(w, head, sizeof(head));
+  }
+}
+
+/**
+ * @brief Append a CBOR text string.
+ *
+ * @param w The writer.
+ * @param str The string bytes.
+ * @param length Number of bytes.
+ */
+static void cbor_text(writer_t *w, const void *str, size_t length)
+{
+  cbor_head(w, CBOR_TEXT, length);
+  put(w, str, length);
+}
+
+/**
+ * @brief Append a CBOR signed integer.
+ *
+ * @param w The writer.
+ * @param value The integer.
+ */
+static void cbor_int(writer_t *w, int32_t value)
+{
+  if (value >= 0)
+    cbor_head(w, CBOR_UINT, (uint32_t)value);
+  else
+    cbor_head(w, CBOR_NEGINT, (uint32_t)(-1 - value));
+}
+
+/**
+ * @brief Append one access point as a CBOR map.
+ *
+ * @param w The writer.
+ * @param record The access point record.
+ */
+static void cbor_record(writer_t *w, const wifi_ap_record_t *record)
+{
+  const char *auth = wifi_api_authmode_name(record->authmode);
+
+  cbor_head(w, CBOR_MAP, 5);
+  cbor_text(w, "ssid", 4);
+  // A text string must be valid UTF-8, other SSIDs are kept as bytes
+  size_t ssid_length =
+    strnlen((const char *)record->ssid, sizeof(record->ssid));
+  if (utf8_valid(record->ssid, ssid_length))
+    cbor_text(w, record->ssid, ssid_length);
+  else
+  {
+    cbor_head(w, CBOR_BYTES, ssid_length);
+    put(w, record->ssid, ssid_length);
+  }
+  cbor_text(w, "bssid", 5);
+  cbor_head(w, CBOR_BYTES, sizeof(record->bssid));
+  put(w, record->bssid, sizeof(record->bssid));
+  cbor_text(w, "rssi", 4);
+  cbor_int(w, record->rssi);
+  cbor_text(w, "channel", 7);
+  cbor_int(w, record->primary);
+  cbor_text(w, "auth", 4);
+  cbor_text(w, auth, strlen(auth));
+}
+
+esp_err_t wifi_api_scan_serialize(const wifi_ap_record_t *records,
+                                  uint16_t count, wifi_api_format_t format,
+                                  uint8_t *buffer, size_t size,
+                                  size_t *length)
+{
+  if ((count > 0 && !records) || (size > 0 && !buffer) || !length)
+    return ESP_ERR_INVALID_ARG;
+
+  writer_t w = {.buffer = buffer, .size = size, .length = 0};
+  switch (format)
+  {
+    case WIFI_API_FORMAT_JSON:
+    {
+      put_byte(&w, '[');
+      for (uint16_t i = 0; i < count; i++)
+      {
+        if (i > 0)
+          put_byte(&w, ',');
+        json_record(&w, &records[i]);
+      }
+      put_byte(&w, ']');
+      break;
+    }
+    case WIFI_API_FORMAT_CBOR:
+    {
+      cbor_head(&w, CBOR_ARRAY, count);
+      for (uint16_t i = 0; i < count; i++)
+        cbor_record(&w, &records[i]);
+      break;
+    }
+    default:
+      return ESP_ERR_INVALID_ARG;
+  }
+
+  *length = w.length;
+  return w.length <= w.size ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
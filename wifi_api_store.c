@@ -0,0 +1,444 @@
+/**
+ * @file wifi_api_store.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API credential profiles persisted in NVS
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_log.h>
+#include <freertos/semphr.h>
+#include <inttypes.h>
+#include <nvs_flash.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_STORE";
+
+/**
+ * @brief NVS namespace of the stored profiles.
+ */
+static const char *STORE_NAMESPACE = "wifi_api_cred";
+
+/**
+ * @brief NVS key of the index listing the slot of every stored profile.
+ */
+static const char *STORE_KEY_INDEX = "index";
+
+/**
+ * @brief Number of consecutive slots probed after the SSID hash, so SSIDs
+ * with colliding hashes can be stored.
+ */
+#define STORE_PROBES 4
+
+/**
+ * @brief Mutex serializing the read-modify-write of the index.
+ */
+static SemaphoreHandle_t s_store_mutex = NULL;
+
+/**
+ * @brief Storage of `s_store_mutex`.
+ */
+static StaticSemaphore_t s_store_mutex_buffer;
+
+/**
+ * @brief Lock protecting the creation of `s_store_mutex`.
+ */
+static portMUX_TYPE s_store_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Whether the NVS partition of the store is initialized.
+ */
+static bool s_store_ready = false;
+
+/**
+ * @brief Slots of the stored profiles, as kept in `STORE_KEY_INDEX`.
+ */
+typedef struct
+{
+  uint32_t slots[CONFIG_WIFI_API_MAX_PROFILES]; /**< Slot of each profile. */
+  size_t count;                                 /**< Number of slots. */
+} wifi_api_store_index_t;
+
+/**
+ * @brief Take the store mutex, creating it on first use.
+ */
+static void store_lock()
+{
+  taskENTER_CRITICAL(&s_store_lock);
+  if (!s_store_mutex)
+    s_store_mutex = xSemaphoreCreateMutexStatic(&s_store_mutex_buffer);
+  taskEXIT_CRITICAL(&s_store_lock);
+  xSemaphoreTake(s_store_mutex, portMAX_DELAY);
+}
+
+/**
+ * @brief Release the store mutex.
+ */
+static void store_unlock()
+{
+  xSemaphoreGive(s_store_mutex);
+}
+
+/**
+ * @brief Hash an SSID with 32-bit FNV-1a.
+ *
+ * @param ssid The SSID.
+ * @return The hash.
+ */
+static uint32_t ssid_hash(const char *ssid)
+{
+  uint32_t hash = 2166136261UL;
+  for (size_t i = 0; i < 32 && ssid[i]; i++)
+  {
+    hash ^= (uint8_t)ssid[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+/**
+ * @brief Format the NVS key of a slot.
+ *
+ * @param slot The slot.
+ * @param key Buffer of `NVS_KEY_NAME_MAX_SIZE` bytes.
+ */
+static void slot_key(uint32_t slot, char *key)
+{
+  snprintf(key, NVS_KEY_NAME_MAX_SIZE, "p%08" PRIx32, slot);
+}
+
+#if CONFIG_NVS_ENCRYPTION
+/**
+ * @brief Initialize a dedicated store partition with the keys of the NVS keys
+ * partition, generating them on first use.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t store_init_partition()
+{
+  const esp_partition_t *keys = esp_partition_find_first(
+    ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS_KEYS, NULL);
+  if (!keys)
+  {
+    ESP_LOGE(TAG, "No NVS keys partition");
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  nvs_sec_cfg_t cfg;
+  esp_err_t err = nvs_flash_read_security_cfg(keys, &cfg);
+  if (err == ESP_ERR_NVS_KEYS_NOT_INITIALIZED)
+    err = nvs_flash_generate_keys(keys, &cfg);
+  if (err != ESP_OK)
+    return err;
+  return nvs_flash_secure_init_partition(CONFIG_WIFI_API_STORE_PARTITION,
+                                         &cfg);
+}
+#else
+/**
+ * @brief Initialize a dedicated store partition.
+ *
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t store_init_partition()
+{
+  return nvs_flash_init_partition(CONFIG_WIFI_API_STORE_PARTITION);
+}
+#endif
+
+/**
+ * @brief Initialize the store partition once and open the store namespace,
+ * called with the store mutex held.
+ *
+ * The default partition is initialized with `nvs_flash_init`, which encrypts
+ * it by itself with `CONFIG_NVS_ENCRYPTION`.
+ *
+ * @param mode The open mode.
+ * @param handle The opened handle.
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t store_open(nvs_open_mode_t mode, nvs_handle_t *handle)
+{
+  if (!s_store_ready)
+  {
+    esp_err_t err =
+      strcmp(CONFIG_WIFI_API_STORE_PARTITION, NVS_DEFAULT_PART_NAME) == 0
+        ? nvs_flash_init()
+        : store_init_partition();
+    if (err != ESP_OK)
+    {
+      ESP_LOGE(TAG, "Failed to initialize partition %s: %s",
+               CONFIG_WIFI_API_STORE_PARTITION, esp_err_to_name(err));
+      return err;
+    }
+    s_store_ready = true;
+  }
+
+  return nvs_open_from_partition(CONFIG_WIFI_API_STORE_PARTITION,
+                                 STORE_NAMESPACE, mode, handle);
+}
+
+/**
+ * @brief Read the index, an absent index is empty.
+ *
+ * An index written with a higher `CONFIG_WIFI_API_MAX_PROFILES` is truncated
+ * to the first `CONFIG_WIFI_API_MAX_PROFILES` slots. The profiles left out
+ * stay in their slots and are indexed again when stored.
+ *
+ * @param handle The store handle.
+ * @param index The index read.
+ * @return ESP_OK on success, an error code otherwise.
+ */
+static esp_err_t index_load(nvs_handle_t handle, wifi_api_store_index_t *index)
+{
+  index->count = 0;
+  size_t length = 0;
+  esp_err_t err = nvs_get_blob(handle, STORE_KEY_INDEX, NULL, &length);
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+    return ESP_OK;
+  if (err != ESP_OK)
+    return err;
+
+  if (length <= sizeof(index->slots))
+    err = nvs_get_blob(handle, STORE_KEY_INDEX, index->slots, &length);
+  else
+  {
+    uint32_t *slots = malloc(length);
+    if (!slots)
+      return ESP_ERR_NO_MEM;
+    err = nvs_get_blob(handle, STORE_KEY_INDEX, slots, &length);
+    if (err == ESP_OK)
+    {
+      size_t stored = length / sizeof(slots[0]);
+      ESP_LOGW(TAG, "Index lists %u profiles, keeping the first %d",
+               (unsigned)stored, CONFIG_WIFI_API_MAX_PROFILES);
+      length = sizeof(index->slots);
+      memcpy(index->slots, slots, length);
+    }
+    free(slots);
+  }
+  if (err == ESP_OK)
+    index->count = length / sizeof(index->slots[0]);
+  return err;
+}
+
+/**
+ * @brief Find a slot in the index.
+ *
+ * @param index The index.
+ * @param slot The slot.
+ * @return The position in the index, -1 if not found.
+ */
+static int index_find(const wifi_api_store_index_t *index, uint32_t slot)
+{
+  for (size_t i = 0; i < index->count; i++)
+  {
+    if (index->slots[i] == slot)
+      return (int)i;
+  }
+  return -1;
+}
+
+/**
+ * @brief Find the slot of an SSID among the probed slots.
+ *
+ * @param handle The store handle.
+ * @param ssid The SSID.
+ * @param slot The slot holding the SSID, or the first free slot.
+ * @param stored The profile held by the slot, if found.
+ * @return ESP_OK if found, ESP_ERR_NVS_NOT_FOUND if `slot` is free,
+ * ESP_ERR_NO_MEM if every probed slot holds another SSID.
+ */
+static esp_err_t slot_find(nvs_handle_t handle, const char *ssid,
+                           uint32_t *slot, wifi_api_profile_t *stored)
+{
+  uint32_t hash = ssid_hash(ssid);
+  bool free_found = false;
+  char key[NVS_KEY_NAME_MAX_SIZE];
+
+  // Every probe is checked, an erased slot does not end the chain
+  for (uint32_t i = 0; i < STORE_PROBES; i++)
+  {
+    slot_key(hash + i, key);
+    size_t length = sizeof(*stored);
+    esp_err_t err = nvs_get_blob(handle, key, stored, &length);
+    if (err == ESP_OK && length == sizeof(*stored) &&
+        strncmp(stored->ssid, ssid, sizeof(stored->ssid)) == 0)
+    {
+      *slot = hash + i;
+      return ESP_OK;
+    }
+    if (err == ESP_ERR_NVS_NOT_FOUND && !free_found)
+    {
+      *slot = hash + i;
+      free_found = true;
+    }
+  }
+  return free_found ? ESP_ERR_NVS_NOT_FOUND : ESP_ERR_NO_MEM;
+}
+
+esp_err_t wifi_api_store_profile(const wifi_api_profile_t *profile)
+{
+  esp_err_t err = wifi_api_add_profile(profile);
+  if (err != ESP_OK)
+    return err;
+
+  // Normalized, so an unchanged profile compares equal to the stored one
+  wifi_api_profile_t record = {.priority = profile->priority};
+  strncpy(record.ssid, profile->ssid, sizeof(record.ssid) - 1);
+  strncpy(record.password, profile->password, sizeof(record.password) - 1);
+
+  store_lock();
+  nvs_handle_t handle;
+  err = store_open(NVS_READWRITE, &handle);
+  if (err != ESP_OK)
+  {
+    store_unlock();
+    return err;
+  }
+
+  wifi_api_store_index_t index;
+  wifi_api_profile_t stored;
+  uint32_t slot = 0;
+  err = index_load(handle, &index);
+  if (err == ESP_OK)
+    err = slot_find(handle, record.ssid, &slot, &stored);
+
+  bool found = err == ESP_OK;
+  bool indexed = found && index_find(&index, slot) >= 0;
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+    err = ESP_OK;
+
+  // Flash is only written for a new or changed profile
+  bool changed = !found || memcmp(&stored, &record, sizeof(record)) != 0;
+  if (err == ESP_OK && !indexed && index.count >= CONFIG_WIFI_API_MAX_PROFILES)
+    err = ESP_ERR_NO_MEM;
+  if (err == ESP_OK && changed)
+  {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    slot_key(slot, key);
+    err = nvs_set_blob(handle, key, &record, sizeof(record));
+  }
+  if (err == ESP_OK && !indexed)
+  {
+    index.slots[index.count++] = slot;
+    err = nvs_set_blob(handle, STORE_KEY_INDEX, index.slots,
+                       index.count * sizeof(index.slots[0]));
+  }
+  if (err == ESP_OK && (changed || !indexed))
+    err = nvs_commit(handle);
+  nvs_close(handle);
+  store_unlock();
+
+  if (err != ESP_OK)
+    ESP_LOGW(TAG, "Failed to store profile %s: %s", record.ssid,
+             esp_err_to_name(err));
+  else if (changed)
+    ESP_LOGI(TAG, "Stored profile %s", record.ssid);
+  return err;
+}
+
+esp_err_t wifi_api_erase_profile(const char *ssid)
+{
+  if (!ssid)
+    return ESP_ERR_INVALID_ARG;
+  wifi_api_remove_profile(ssid);
+
+  store_lock();
+  nvs_handle_t handle;
+  esp_err_t err = store_open(NVS_READWRITE, &handle);
+  if (err != ESP_OK)
+  {
+    store_unlock();
+    return err;
+  }
+
+  wifi_api_store_index_t index;
+  wifi_api_profile_t stored;
+  uint32_t slot = 0;
+  err = index_load(handle, &index);
+  if (err == ESP_OK)
+    err = slot_find(handle, ssid, &slot, &stored);
+  if (err == ESP_ERR_NVS_NOT_FOUND || err == ESP_ERR_NO_MEM)
+    err = ESP_ERR_NOT_FOUND;
+
+  if (err == ESP_OK)
+  {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    slot_key(slot, key);
+    err = nvs_erase_key(handle, key);
+  }
+  int position = err == ESP_OK ? index_find(&index, slot) : -1;
+  if (position >= 0)
+  {
+    index.slots[position] = index.slots[--index.count];
+    err = index.count > 0
+            ? nvs_set_blob(handle, STORE_KEY_INDEX, index.slots,
+                           index.count * sizeof(index.slots[0]))
+            : nvs_erase_key(handle, STORE_KEY_INDEX);
+  }
+  if (err == ESP_OK)
+    err = nvs_commit(handle);
+  nvs_close(handle);
+  store_unlock();
+
+  return err;
+}
+
+esp_err_t wifi_api_load_profiles(size_t *count)
+{
+  size_t loaded = 0;
+  if (count)
+    *count = 0;
+
+  store_lock();
+  nvs_handle_t handle;
+  esp_err_t err = store_open(NVS_READONLY, &handle);
+  if (err == ESP_ERR_NVS_NOT_FOUND)
+  {
+    // The namespace does not exist until a profile is stored
+    store_unlock();
+    return ESP_OK;
+  }
+  if (err != ESP_OK)
+  {
+    store_unlock();
+    return err;
+  }
+
+  wifi_api_store_index_t index;
+  err = index_load(handle, &index);
+  for (size_t i = 0; err == ESP_OK && i < index.count; i++)
+  {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    wifi_api_profile_t stored;
+    size_t length = sizeof(stored);
+    slot_key(index.slots[i], key);
+    if (nvs_get_blob(handle, key, &stored, &length) != ESP_OK ||
+        length != sizeof(stored))
+      continue;
+
+    stored.ssid[sizeof(stored.ssid) - 1] = '\0';
+    stored.password[sizeof(stored.password) - 1] = '\0';
+    if (wifi_api_add_profile(&stored) == ESP_OK)
+      loaded++;
+  }
+  nvs_close(handle);
+  store_unlock();
+
+  ESP_LOGI(TAG, "Loaded %u stored profiles", (unsigned)loaded);
+  if (count)
+    *count = loaded;
+  return err;
+}
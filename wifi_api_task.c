@@ -0,0 +1,306 @@
+/**
+ * @file wifi_api_task.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi manager task serializing every operation of the component
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_log.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <string.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_TASK";
+
+/**
+ * @brief Handle of the Wi-Fi manager task.
+ */
+static TaskHandle_t s_task = NULL;
+
+/**
+ * @brief Bounded command queue of the Wi-Fi manager task.
+ */
+static QueueHandle_t s_queue = NULL;
+
+/**
+ * @brief Lock protecting the creation of the task.
+ */
+static portMUX_TYPE s_task_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Mutex serializing the blocking calls of `wifi_api_task_call`.
+ */
+static SemaphoreHandle_t s_call_mutex = NULL;
+
+/**
+ * @brief Semaphore signaled when the command of a blocking call is done.
+ */
+static SemaphoreHandle_t s_call_done = NULL;
+
+/**
+ * @brief Result of the command of the last blocking call.
+ */
+static esp_err_t s_call_result = ESP_OK;
+
+/**
+ * @brief Number of commands that can be latched, one per timer command and
+ * the driver events arriving while the queue is full.
+ */
+#define LATCH_SIZE 16
+
+/**
+ * @brief Commands that did not fit in the queue, in arrival order, executed
+ * once the queue is empty.
+ */
+static wifi_api_cmd_t s_latched[LATCH_SIZE];
+
+/**
+ * @brief Number of commands in `s_latched`.
+ */
+static size_t s_latched_count = 0;
+
+/**
+ * @brief Lock protecting the latched commands.
+ */
+static portMUX_TYPE s_latch_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Whether two commands are the same timer command.
+ *
+ * Events are never merged, each one is handled in its arrival order.
+ *
+ * @param a The first command.
+ * @param b The second command.
+ * @return true if the later one replaces the earlier one.
+ */
+static bool latch_same(const wifi_api_cmd_t *a, const wifi_api_cmd_t *b)
+{
+  return a->id == b->id && a->id != WIFI_API_CMD_EVENT;
+}
+
+/**
+ * @brief Take the oldest latched command.
+ *
+ * @param[out] cmd The command.
+ * @return true if a command was latched.
+ */
+static bool latch_take(wifi_api_cmd_t *cmd)
+{
+  taskENTER_CRITICAL(&s_latch_lock);
+  bool taken = s_latched_count > 0;
+  if (taken)
+  {
+    *cmd = s_latched[0];
+    s_latched_count--;
+    memmove(&s_latched[0], &s_latched[1],
+            s_latched_count * sizeof(s_latched[0]));
+  }
+  taskEXIT_CRITICAL(&s_latch_lock);
+  return taken;
+}
+
+/**
+ * @brief Whether commands are latched.
+ *
+ * @return true if `latch_take` has a command.
+ */
+static bool latch_pending()
+{
+  taskENTER_CRITICAL(&s_latch_lock);
+  bool pending = s_latched_count > 0;
+  taskEXIT_CRITICAL(&s_latch_lock);
+  return pending;
+}
+
+/**
+ * @brief Wi-Fi manager task.
+ *
+ * Owns the state of the component and executes the queued commands one at a
+ * time.
+ *
+ * @param arg The command queue, created before the task.
+ */
+static void wifi_api_task(void *arg)
+{
+  QueueHandle_t queue = arg;
+  wifi_api_cmd_t cmd;
+  for (;;)
+  {
+    // A latched command runs at the place of the wake-up queued behind it,
+    // or once the queue that was full is empty
+    TickType_t wait = latch_pending() ? 0 : portMAX_DELAY;
+    if (xQueueReceive(queue, &cmd, wait) != pdTRUE && !latch_take(&cmd))
+      continue;
+    if (cmd.id == WIFI_API_CMD_DRAIN && !latch_take(&cmd))
+      continue;
+
+    esp_err_t err = wifi_api_execute(&cmd);
+    if (cmd.done)
+      cmd.done(err, cmd.done_arg);
+  }
+}
+
+/**
+ * @brief Create the Wi-Fi manager task and its queue once.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM otherwise.
+ */
+static esp_err_t wifi_api_task_init()
+{
+  if (s_queue)
+    return ESP_OK;
+
+  QueueHandle_t queue =
+    xQueueCreate(CONFIG_WIFI_API_QUEUE_LENGTH, sizeof(wifi_api_cmd_t));
+  SemaphoreHandle_t call_mutex = xSemaphoreCreateMutex();
+  SemaphoreHandle_t call_done = xSemaphoreCreateBinary();
+
+  // The task is created before the queue is published, so no caller ever
+  // queues to a task that does not exist
+  TaskHandle_t task = NULL;
+  BaseType_t core = CONFIG_WIFI_API_TASK_CORE_ID < 0
+                      ? tskNO_AFFINITY
+                      : CONFIG_WIFI_API_TASK_CORE_ID;
+  if (queue && call_mutex && call_done &&
+      xTaskCreatePinnedToCore(&wifi_api_task, "wifi_api",
+                              CONFIG_WIFI_API_TASK_STACK_SIZE, queue,
+                              CONFIG_WIFI_API_TASK_PRIORITY, &task,
+                              core) != pdPASS)
+  {
+    ESP_LOGE(TAG, "Failed to create the Wi-Fi manager task");
+    task = NULL;
+  }
+
+  taskENTER_CRITICAL(&s_task_lock);
+  bool owner = task && !s_queue;
+  if (owner)
+  {
+    s_task = task;
+    s_queue = queue;
+    s_call_mutex = call_mutex;
+    s_call_done = call_done;
+  }
+  taskEXIT_CRITICAL(&s_task_lock);
+
+  // Either the creation failed or another task created the queue first, the
+  // unused task only waits on its own empty queue
+  if (!owner)
+  {
+    if (task)
+      vTaskDelete(task);
+    if (queue)
+      vQueueDelete(queue);
+    if (call_mutex)
+      vSemaphoreDelete(call_mutex);
+    if (call_done)
+      vSemaphoreDelete(call_done);
+    return s_queue ? ESP_OK : ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+esp_err_t wifi_api_task_post(const wifi_api_cmd_t *cmd, TickType_t wait)
+{
+  esp_err_t err = wifi_api_task_init();
+  if (err != ESP_OK)
+    return err;
+
+  if (xQueueSend(s_queue, cmd, wait) != pdTRUE)
+  {
+    ESP_LOGW(TAG, "Command queue full, dropping command %d", cmd->id);
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
+esp_err_t wifi_api_task_post_latched(const wifi_api_cmd_t *cmd,
+                                     TickType_t wait)
+{
+  esp_err_t err = wifi_api_task_init();
+  if (err != ESP_OK)
+    return err;
+
+  // Once a command is latched, the later ones are latched behind it so they
+  // keep their order
+  if (!latch_pending() && xQueueSend(s_queue, cmd, wait) == pdTRUE)
+    return ESP_OK;
+
+  taskENTER_CRITICAL(&s_latch_lock);
+  size_t i = 0;
+  while (i < s_latched_count && !latch_same(&s_latched[i], cmd))
+    i++;
+  if (i < s_latched_count)
+  {
+    s_latched_count--;
+    memmove(&s_latched[i], &s_latched[i + 1],
+            (s_latched_count - i) * sizeof(s_latched[0]));
+  }
+  bool latched = s_latched_count < LATCH_SIZE;
+  if (latched)
+    s_latched[s_latched_count++] = *cmd;
+  taskEXIT_CRITICAL(&s_latch_lock);
+
+  if (!latched)
+  {
+    ESP_LOGE(TAG, "Latch full, dropping command %d", cmd->id);
+    return ESP_ERR_NO_MEM;
+  }
+
+  // Wakes the task if it emptied the queue meanwhile, if the queue is full
+  // again the task is busy and drains the latch afterwards
+  wifi_api_cmd_t drain = {.id = WIFI_API_CMD_DRAIN};
+  xQueueSend(s_queue, &drain, 0);
+  return ESP_OK;
+}
+
+/**
+ * @brief Completion callback of the blocking calls.
+ *
+ * @param result The result of the command.
+ * @param arg User-defined argument (not used).
+ */
+static void wifi_api_task_call_done(esp_err_t result, void *arg)
+{
+  s_call_result = result;
+  xSemaphoreGive(s_call_done);
+}
+
+esp_err_t wifi_api_task_call(wifi_api_cmd_t *cmd)
+{
+  if (wifi_api_task_is_current())
+    return wifi_api_execute(cmd);
+
+  esp_err_t err = wifi_api_task_init();
+  if (err != ESP_OK)
+    return err;
+
+  xSemaphoreTake(s_call_mutex, portMAX_DELAY);
+  cmd->done = &wifi_api_task_call_done;
+  cmd->done_arg = NULL;
+  err = wifi_api_task_post(cmd, portMAX_DELAY);
+  if (err == ESP_OK)
+  {
+    xSemaphoreTake(s_call_done, portMAX_DELAY);
+    err = s_call_result;
+  }
+  xSemaphoreGive(s_call_mutex);
+
+  return err;
+}
+
+bool wifi_api_task_is_current()
+{
+  return s_task && xTaskGetCurrentTaskHandle() == s_task;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file wifi_api_trace.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API event trace ring buffer
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <inttypes.h>
+#include <string.h>
+
+#if CONFIG_WIFI_API_TRACE
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_TRACE";
+
+/**
+ * @brief Marker of an initialized trace, also versions the entry layout.
+ */
+#define TRACE_MAGIC 0x57415432
+
+/**
+ * @brief Event trace ring buffer.
+ *
+ * Written only by the default event loop task. `head` counts every entry
+ * written and is published after the entry, so readers know which entries
+ * are complete and which were overwritten while copying. Clearing moves
+ * `tail` up to `head` instead of resetting it, so it never races the writer.
+ */
+typedef struct
+{
+  uint32_t magic; /**< `TRACE_MAGIC`. */
+  uint32_t size;  /**< Capacity. */
+  uint32_t head;  /**< Entries written. */
+  uint32_t tail;  /**< Value of `head` at the last clear. */
+  wifi_api_trace_entry_t entries[CONFIG_WIFI_API_TRACE_SIZE]; /**< Ring. */
+} wifi_api_trace_t;
+
+#if CONFIG_WIFI_API_TRACE_RTC
+/**
+ * @brief The trace, kept across resets.
+ */
+static RTC_NOINIT_ATTR wifi_api_trace_t s_trace;
+#else
+/**
+ * @brief The trace.
+ */
+static wifi_api_trace_t s_trace;
+#endif
+
+/**
+ * @brief Lock protecting the initialization of the trace.
+ */
+static portMUX_TYPE s_trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Whether the trace was checked since boot.
+ */
+static bool s_trace_ready = false;
+
+/**
+ * @brief Append an entry to the ring.
+ *
+ * @param entry The entry.
+ */
+static void trace_push(const wifi_api_trace_entry_t *entry)
+{
+  uint32_t head = __atomic_load_n(&s_trace.head, __ATOMIC_RELAXED);
+  s_trace.entries[head % CONFIG_WIFI_API_TRACE_SIZE] = *entry;
+  __atomic_store_n(&s_trace.head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Number of entries kept, written since the last clear and not
+ * overwritten.
+ *
+ * @param head The value of `head`.
+ * @return The number of entries before `head`.
+ */
+static uint32_t trace_kept(uint32_t head)
+{
+  uint32_t kept = head - __atomic_load_n(&s_trace.tail, __ATOMIC_ACQUIRE);
+  return kept < CONFIG_WIFI_API_TRACE_SIZE ? kept
+                                           : CONFIG_WIFI_API_TRACE_SIZE;
+}
+
+/**
+ * @brief Validate the trace once per boot.
+ *
+ * A trace kept in RTC memory is reused when its layout matches and a boot
+ * marker is appended, otherwise it is cleared.
+ */
+static void trace_init()
+{
+  if (__atomic_load_n(&s_trace_ready, __ATOMIC_ACQUIRE))
+    return;
+
+  // The marker is pushed under the lock, before the event loop can record
+  taskENTER_CRITICAL(&s_trace_lock);
+  if (!s_trace_ready)
+  {
+    if (s_trace.magic != TRACE_MAGIC ||
+        s_trace.size != CONFIG_WIFI_API_TRACE_SIZE)
+    {
+      memset(&s_trace, 0, sizeof(s_trace));
+      s_trace.magic = TRACE_MAGIC;
+      s_trace.size = CONFIG_WIFI_API_TRACE_SIZE;
+    }
+    else if (s_trace.head != s_trace.tail)
+    {
+      wifi_api_trace_entry_t boot = {.base = WIFI_API_TRACE_BASE_BOOT};
+      trace_push(&boot);
+    }
+    __atomic_store_n(&s_trace_ready, true, __ATOMIC_RELEASE);
+  }
+  taskEXIT_CRITICAL(&s_trace_lock);
+}
+
+void wifi_api_trace_record(esp_event_base_t event_base, int32_t event_id,
+                           const void *event_data)
+{
+  trace_init();
+
+  wifi_api_trace_entry_t entry = {
+    .time_ms = (uint32_t)(esp_timer_get_time() / 1000),
+    .base = event_base == IP_EVENT ? WIFI_API_TRACE_BASE_IP
+                                   : WIFI_API_TRACE_BASE_WIFI,
+    .id = (uint8_t)event_id,
+  };
+
+  if (event_base == WIFI_EVENT && event_data)
+  {
+    switch (event_id)
+    {
+      case WIFI_EVENT_STA_CONNECTED:
+      {
+        const wifi_event_sta_connected_t *event = event_data;
+        entry.channel = event->channel;
+        break;
+      }
+      case WIFI_EVENT_STA_DISCONNECTED:
+      {
+        const wifi_event_sta_disconnected_t *event = event_data;
+        entry.reason = event->reason;
+        entry.rssi = event->rssi;
+        break;
+      }
+      case WIFI_EVENT_STA_BSS_RSSI_LOW:
+      {
+        const wifi_event_bss_rssi_low_t *event = event_data;
+        entry.rssi = (int8_t)event->rssi;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  trace_push(&entry);
+}
+
+size_t wifi_api_trace_read(wifi_api_trace_entry_t *entries, size_t max)
+{
+  if (!entries || max == 0)
+    return 0;
+  trace_init();
+
+  uint32_t head = __atomic_load_n(&s_trace.head, __ATOMIC_ACQUIRE);
+  uint32_t count = trace_kept(head);
+  if (count > max)
+    count = max;
+
+  uint32_t first = head - count;
+  for (uint32_t i = 0; i < count; i++)
+    entries[i] = s_trace.entries[(first + i) % CONFIG_WIFI_API_TRACE_SIZE];
+
+  // Drop the entries overwritten by the event loop while copying
+  uint32_t end = __atomic_load_n(&s_trace.head, __ATOMIC_ACQUIRE);
+  uint32_t overwritten = end - head;
+  if (overwritten == 0)
+    return count;
+  if (overwritten >= count)
+    return 0;
+
+  memmove(entries, entries + overwritten,
+          (count - overwritten) * sizeof(entries[0]));
+  return count - overwritten;
+}
+
+void wifi_api_trace_clear()
+{
+  trace_init();
+  uint32_t head = __atomic_load_n(&s_trace.head, __ATOMIC_ACQUIRE);
+  __atomic_store_n(&s_trace.tail, head, __ATOMIC_RELEASE);
+}
+
+void wifi_api_trace_dump()
+{
+  wifi_api_trace_entry_t entry[8];
+  size_t count = 0;
+
+  trace_init();
+  uint32_t head = __atomic_load_n(&s_trace.head, __ATOMIC_ACQUIRE);
+  uint32_t kept = trace_kept(head);
+  ESP_LOGI(TAG, "%" PRIu32 " events recorded",
+           head - __atomic_load_n(&s_trace.tail, __ATOMIC_ACQUIRE));
+
+  // Logged in small chunks to keep the stack usage bounded
+  for (uint32_t first = head - kept; first < head; first += count)
+  {
+    count = 0;
+    for (; count < 8 && first + count < head; count++)
+      entry[count] =
+        s_trace.entries[(first + count) % CONFIG_WIFI_API_TRACE_SIZE];
+
+    for (size_t i = 0; i < count; i++)
+    {
+      const wifi_api_trace_entry_t *e = &entry[i];
+      if (e->base == WIFI_API_TRACE_BASE_BOOT)
+      {
+        ESP_LOGI(TAG, "---- reset ----");
+        continue;
+      }
+      ESP_LOGI(TAG, "%10" PRIu32 " ms %s %3u reason %3u rssi %4d ch %2u",
+               e->time_ms, e->base == WIFI_API_TRACE_BASE_IP ? "IP  " : "WIFI",
+               e->id, e->reason, e->rssi, e->channel);
+    }
+  }
+}
+
+#else
+
+void wifi_api_trace_record(esp_event_base_t event_base, int32_t event_id,
+                           const void *event_data)
+{
+}
+
+size_t wifi_api_trace_read(wifi_api_trace_entry_t *entries, size_t max)
+{
+  return 0;
+}
+
+void wifi_api_trace_clear()
+{
+}
+
+void wifi_api_trace_dump()
+{
+}
+
+#endif // CONFIG_WIFI_API_TRACE
@@ -0,0 +1,309 @@
+/**
+ * @file wifi_api_watchdog.c
+ * @author Pedro Luis Dionísio Fraga (pedrodfraga@hotmail.com)
+ *
+ * @brief Wi-Fi API connectivity watchdog
+ *
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "wifi_api_priv.h"
+#include "wifi_api_probe.h"
+
+#include <esp_log.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <inttypes.h>
+#include <ping/ping_sock.h>
+#include <string.h>
+
+/**
+ * @brief Tag for logging.
+ */
+static const char *TAG = "WIFI_API_WATCHDOG";
+
+/**
+ * @brief Result posted for a failed probe, other values are round trips.
+ */
+#define WATCHDOG_PROBE_FAILED UINT32_MAX
+
+/**
+ * @brief Names of the recovery actions, indexed by
+ * `wifi_api_watchdog_action_t`.
+ */
+static const char *const ACTION_NAMES[WIFI_API_WATCHDOG_ACTION_MAX] = {
+  [WIFI_API_WATCHDOG_RENEW_DHCP] = "renew DHCP",
+  [WIFI_API_WATCHDOG_REASSOCIATE] = "reassociate",
+  [WIFI_API_WATCHDOG_RESTART] = "restart driver",
+};
+
+/**
+ * @brief State of an ICMP probe, shared with the ping callbacks.
+ */
+typedef struct
+{
+  SemaphoreHandle_t done; /**< Given when the ping session ends. */
+  uint32_t elapsed_ms;    /**< Round trip of the reply. */
+  bool replied;           /**< Whether a reply was received. */
+} watchdog_ping_t;
+
+/**
+ * @brief Whether the watchdog is enabled.
+ */
+static bool s_enabled = false;
+
+/**
+ * @brief Watchdog configuration, its host points to `s_host`.
+ */
+static wifi_api_watchdog_config_t s_config = WIFI_API_WATCHDOG_CONFIG_DEFAULT();
+
+/**
+ * @brief Copy of the address to probe, empty for the gateway.
+ */
+static char s_host[16] = {0};
+
+/**
+ * @brief Statistics read by `wifi_api_get_watchdog_stats`.
+ */
+static wifi_api_watchdog_stats_t s_stats = {0};
+
+/**
+ * @brief Lock protecting the configuration read by the probe task and the
+ * statistics.
+ */
+static portMUX_TYPE s_watchdog_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Task sending the probes, created on first enable.
+ */
+static TaskHandle_t s_task = NULL;
+
+/**
+ * @brief Consecutive failed probes.
+ */
+static uint32_t s_failures = 0;
+
+/**
+ * @brief Next recovery action.
+ */
+static wifi_api_watchdog_action_t s_next_action = WIFI_API_WATCHDOG_RENEW_DHCP;
+
+/**
+ * @brief Ping callback of a reply, records its round trip.
+ *
+ * @param hdl Ping session handle.
+ * @param args The probe state.
+ */
+static void watchdog_ping_success(esp_ping_handle_t hdl, void *args)
+{
+  watchdog_ping_t *ping = args;
+  esp_ping_get_profile(hdl, ESP_PING_PROF_TIMEGAP, &ping->elapsed_ms,
+                       sizeof(ping->elapsed_ms));
+  ping->replied = true;
+}
+
+/**
+ * @brief Ping callback of the end of the session, wakes the probe task.
+ *
+ * @param hdl Ping session handle.
+ * @param args The probe state.
+ */
+static void watchdog_ping_end(esp_ping_handle_t hdl, void *args)
+{
+  watchdog_ping_t *ping = args;
+  xSemaphoreGive(ping->done);
+}
+
+/**
+ * @brief Send an ICMP echo request and wait for the reply.
+ *
+ * @param config The watchdog configuration.
+ * @param done Semaphore signaling the end of the session.
+ * @param latency_us Round trip of the reply.
+ * @return true if the target replied in time.
+ */
+static bool watchdog_ping(const wifi_api_watchdog_config_t *config,
+                          SemaphoreHandle_t done, uint32_t *latency_us)
+{
+  esp_netif_t *netif = esp_netif_get_handle_from_ifkey("WIFI_STA_DEF");
+  esp_netif_ip_info_t ip_info;
+  if (!netif || esp_netif_get_ip_info(netif, &ip_info) != ESP_OK)
+    return false;
+
+  esp_ip4_addr_t target = ip_info.gw;
+  if (config->host && esp_netif_str_to_ip4(config->host, &target) != ESP_OK)
+    return false;
+
+  esp_ping_config_t ping_config = ESP_PING_DEFAULT_CONFIG();
+  ip_addr_set_ip4_u32(&ping_config.target_addr, target.addr);
+  ping_config.count = 1;
+  ping_config.timeout_ms = config->timeout_ms;
+  ping_config.interface = esp_netif_get_netif_impl_index(netif);
+
+  watchdog_ping_t ping = {.done = done};
+  esp_ping_callbacks_t callbacks = {
+    .cb_args = &ping,
+    .on_ping_success = &watchdog_ping_success,
+    .on_ping_end = &watchdog_ping_end,
+  };
+  esp_ping_handle_t session;
+  if (esp_ping_new_session(&ping_config, &callbacks, &session) != ESP_OK)
+    return false;
+  if (esp_ping_start(session) == ESP_OK)
+    // The session always ends, after the reply or the timeout
+    xSemaphoreTake(done, portMAX_DELAY);
+  esp_ping_delete_session(session);
+
+  *latency_us = ping.elapsed_ms * 1000;
+  return ping.replied;
+}
+
+/**
+ * @brief Probe task, sends a probe every interval while the station has an
+ * address and posts the result to the Wi-Fi manager task.
+ *
+ * @param arg User-defined argument (not used).
+ */
+static void watchdog_task(void *arg)
+{
+  SemaphoreHandle_t ping_done = xSemaphoreCreateBinary();
+
+  for (;;)
+  {
+    taskENTER_CRITICAL(&s_watchdog_lock);
+    bool enabled = s_enabled;
+    wifi_api_watchdog_config_t config = s_config;
+    char host[sizeof(s_host)];
+    memcpy(host, s_host, sizeof(host));
+    taskEXIT_CRITICAL(&s_watchdog_lock);
+    config.host = host[0] ? host : NULL;
+
+    // A notification means the configuration changed, restart the interval
+    TickType_t wait = enabled ? pdMS_TO_TICKS(config.interval_ms)
+                              : portMAX_DELAY;
+    if (ulTaskNotifyTake(pdTRUE, wait) > 0)
+      continue;
+    if (!enabled || !(wifi_api_get_state() & WIFI_API_STATE_GOT_IP4))
+      continue;
+
+    uint32_t latency_us = 0;
+    bool ok;
+    if (config.probe == WIFI_API_WATCHDOG_TCP)
+      ok = wifi_api_probe_tcp(config.host, config.port, config.timeout_ms,
+                              &latency_us) == ESP_OK;
+    else
+      ok = ping_done && watchdog_ping(&config, ping_done, &latency_us);
+
+    wifi_api_cmd_t cmd = {.id = WIFI_API_CMD_WATCHDOG_PROBED,
+                          .value = WATCHDOG_PROBE_FAILED};
+    if (ok)
+      cmd.value = latency_us < WATCHDOG_PROBE_FAILED
+                    ? latency_us
+                    : WATCHDOG_PROBE_FAILED - 1;
+    // A result dropped on a full queue is covered by the next probe
+    wifi_api_task_post(&cmd, 0);
+  }
+}
+
+esp_err_t wifi_api_watchdog_configure(const wifi_api_watchdog_config_t *config)
+{
+  if (config && !s_task)
+  {
+    UBaseType_t priority = CONFIG_WIFI_API_TASK_PRIORITY > 1
+                             ? CONFIG_WIFI_API_TASK_PRIORITY - 1
+                             : 1;
+    if (xTaskCreate(&watchdog_task, "wifi_api_wdt",
+                    CONFIG_WIFI_API_TASK_STACK_SIZE, NULL, priority,
+                    &s_task) != pdPASS)
+    {
+      s_task = NULL;
+      return ESP_ERR_NO_MEM;
+    }
+  }
+
+  taskENTER_CRITICAL(&s_watchdog_lock);
+  s_enabled = config != NULL;
+  if (config)
+  {
+    s_config = *config;
+    s_host[0] = '\0';
+    if (config->host)
+      strlcpy(s_host, config->host, sizeof(s_host));
+    s_config.host = s_host[0] ? s_host : NULL;
+  }
+  taskEXIT_CRITICAL(&s_watchdog_lock);
+
+  s_failures = 0;
+  s_next_action = WIFI_API_WATCHDOG_RENEW_DHCP;
+  if (s_task)
+    xTaskNotifyGive(s_task);
+  return ESP_OK;
+}
+
+bool wifi_api_watchdog_probed(uint32_t result,
+                              wifi_api_watchdog_action_t *action)
+{
+  if (!s_enabled)
+    return false;
+
+  bool failed = result == WATCHDOG_PROBE_FAILED;
+  taskENTER_CRITICAL(&s_watchdog_lock);
+  s_stats.probes++;
+  if (failed)
+    s_stats.failures++;
+  taskEXIT_CRITICAL(&s_watchdog_lock);
+
+  if (!failed)
+  {
+    wifi_api_phase_record(WIFI_API_PHASE_PROBE, result);
+    if (s_failures >= s_config.failures)
+      ESP_LOGI(TAG, "Connectivity restored after %" PRIu32 " failed probes",
+               s_failures);
+    s_failures = 0;
+    s_next_action = WIFI_API_WATCHDOG_RENEW_DHCP;
+    return false;
+  }
+
+  s_failures++;
+  if (s_failures % s_config.failures != 0)
+    return false;
+
+  // The last action is repeated until a probe succeeds
+  *action = s_next_action;
+  if (s_next_action < WIFI_API_WATCHDOG_RESTART)
+    s_next_action++;
+
+  taskENTER_CRITICAL(&s_watchdog_lock);
+  s_stats.actions[*action]++;
+  taskEXIT_CRITICAL(&s_watchdog_lock);
+
+  ESP_LOGW(TAG, "%" PRIu32 " failed probes, %s", s_failures,
+           ACTION_NAMES[*action]);
+  wifi_api_event_data_t data = {.event = WIFI_API_EVENT_WATCHDOG};
+  data.watchdog.action = *action;
+  data.watchdog.failures = s_failures;
+  wifi_api_event_publish(&data);
+  return true;
+}
+
+esp_err_t wifi_api_get_watchdog_stats(wifi_api_watchdog_stats_t *stats)
+{
+  if (!stats)
+    return ESP_ERR_INVALID_ARG;
+
+  taskENTER_CRITICAL(&s_watchdog_lock);
+  *stats = s_stats;
+  taskEXIT_CRITICAL(&s_watchdog_lock);
+  return ESP_OK;
+}
+
+void wifi_api_reset_watchdog_stats()
+{
+  taskENTER_CRITICAL(&s_watchdog_lock);
+  memset(&s_stats, 0, sizeof(s_stats));
+  taskEXIT_CRITICAL(&s_watchdog_lock);
+}